@@ -7,12 +7,30 @@
 #include <QPixmap>
 #include <QThreadPool>
 #include <QMutex>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QStringList>
+#include <QByteArray>
+#include "thumbnailcache.h"
+#include "formatsniffer.h"
 
 /**
  * @brief The ImageLoader class manages asynchronous loading of images.
  *
  * Utilizes a thread pool to load multiple images in parallel, improving
  * responsiveness for large image collections.
+ *
+ * For high-latency storage, a deep read-ahead mode can be enabled with the
+ * DIV_READAHEAD_DEPTH environment variable: a separate pool of that many
+ * readers fetches whole files into memory, and decode tasks are only queued
+ * once their bytes are there. Reads in flight are then no longer limited to
+ * the number of decode threads.
+ *
+ * Independently of that, adviseUpcoming() asks the kernel to page in the
+ * files just beyond the decode window, up to DIV_READAHEAD_HINT_MB
+ * megabytes (64 by default, 0 disables it), so decode threads rarely wait
+ * on a cold disk.
  */
 class ImageLoader : public QObject
 {
@@ -32,22 +50,135 @@ public:
 
     /**
      * @brief Initiates asynchronous loading of an image.
+     *
+     * If no thumbnail is cached yet, an embedded EXIF thumbnail is fetched
+     * first on a separate pool as a preview while the full decode is pending.
+     *
      * @param index The index of the image in the collection.
+     * @param id The image ID in the path table.
+     * @param path The file path to the image.
+     * @param priority Queue priority; higher runs first. Images needed by a
+     *                 deadline are requested above the default of 0.
+     */
+    void loadImage(int index, int id, const QString &path, int priority = 0);
+
+    /**
+     * @brief Hints the kernel to start reading images that will be decoded soon.
+     *
+     * Runs in the background and replaces any hinting still pending. Paths
+     * are hinted in the given order until the byte budget is used up, so
+     * callers list the most likely next images first. Paths hinted recently
+     * are skipped.
+     *
+     * @param paths Upcoming images, most likely first.
+     */
+    void adviseUpcoming(const QStringList &paths);
+
+    /**
+     * @brief Gets the read-ahead depth.
+     * @return Number of file reads kept in flight ahead of decoding, 0 if reads happen in the decode tasks.
+     */
+    int readAheadDepth() const { return m_readAheadDepth; }
+
+    /**
+     * @brief Drops all load requests whose decode has not started yet.
+     *
+     * Decodes already running are allowed to finish and still report;
+     * nothing else that was requested will.
+     *
+     * @return IDs of the images whose loads were dropped, once per ID.
+     */
+    QVector<int> cancelPendingLoads();
+
+    /**
+     * @brief Initiates asynchronous loading of a thumbnail only.
+     *
+     * Runs on a separate small pool so previews never queue behind full
+     * decodes. Only the most recent request is kept if several are pending.
+     *
+     * @param id The image ID in the path table.
      * @param path The file path to the image.
      */
-    void loadImage(int index, const QString &path);
+    void loadThumbnail(int id, const QString &path);
+
+    /**
+     * @brief Records the formats detected for images, so decodes skip format probing.
+     * @param ids The image IDs in the path table.
+     * @param formats One ImageFormat value per ID.
+     */
+    void setImageFormats(const QVector<int> &ids, const QByteArray &formats);
+
+    /**
+     * @brief Forgets all recorded formats.
+     */
+    void clearImageFormats();
+
+    /**
+     * @brief Gets the recorded format of an image.
+     * @param id The image ID in the path table.
+     * @return The format, Unknown if none was recorded.
+     */
+    ImageFormat imageFormat(int id) const;
+
+    /**
+     * @brief Gets the cache of low-resolution thumbnails.
+     * @return Pointer to the thumbnail cache.
+     */
+    ThumbnailCache* thumbnailCache() { return &m_thumbnailCache; }
 
 signals:
     /**
      * @brief Signal emitted when an image has been loaded.
      * @param index The index of the loaded image.
+     * @param path The file path of the loaded image.
      * @param pixmap The loaded image pixmap.
      */
-    void imageLoaded(int index, const QPixmap &pixmap);
+    void imageLoaded(int index, const QString &path, const QPixmap &pixmap);
+
+    /**
+     * @brief Signal emitted when a requested thumbnail is in the thumbnail cache.
+     * @param path The file path of the image.
+     */
+    void thumbnailLoaded(const QString &path);
 
 private:
+    /**
+     * @brief Queues the decode of an image.
+     *
+     * Must be called with m_mutex held.
+     *
+     * @param index The index of the image in the collection.
+     * @param id The image ID in the path table.
+     * @param path The file path to the image.
+     * @param format The recorded format.
+     * @param data The file contents if read ahead, otherwise null.
+     * @param priority Queue priority of the decode.
+     */
+    void startDecode(int index, int id, const QString &path, ImageFormat format, const QByteArray &data,
+                     int priority);
+
+    /**
+     * @brief Gets the recorded format of an image; m_mutex must be held.
+     * @param id The image ID in the path table.
+     * @return The format, Unknown if none was recorded.
+     */
+    ImageFormat imageFormatLocked(int id) const;
+
     QThreadPool m_threadPool;   ///< Thread pool for parallel image loading
-    QMutex m_mutex;             ///< Mutex to protect thread-pool access
+    QThreadPool m_readPool;     ///< Readers for read-ahead mode; blocked on I/O, not CPU
+    QThreadPool m_advisePool;   ///< Single worker issuing kernel readahead hints
+    qint64 m_adviseBudget = 0;  ///< Bytes hinted per adviseUpcoming call
+    QSet<QString> m_advised;    ///< Paths hinted recently, skipped by later calls
+
+    static const int MaxAdvisedPaths = 4096; ///< Size at which the hinted set is forgotten
+    int m_readAheadDepth = 0;   ///< Reads kept in flight ahead of decoding, 0 when disabled
+    quint64 m_loadGeneration = 0; ///< Bumped by cancelPendingLoads to drop reads in flight
+    QHash<int, int> m_undecoded; ///< Requests per image ID whose decode has not started yet
+    QThreadPool m_thumbnailPool; ///< Small pool for thumbnail-only decodes
+    QThreadPool m_previewPool;  ///< Pool for embedded-thumbnail previews of pending loads
+    mutable QMutex m_mutex;     ///< Mutex to protect thread-pool and format access
+    QByteArray m_formats;       ///< ImageFormat of each image, indexed by image ID; Unknown past the end
+    ThumbnailCache m_thumbnailCache; ///< Thumbnails produced alongside full decodes
 };
 
 #endif // IMAGELOADER_H
@@ -0,0 +1,49 @@
+// archiveimagesource.cpp
+#include "archiveimagesource.h"
+#include "ziparchive.h"
+
+ArchiveImageSource *ArchiveImageSource::instance()
+{
+    static ArchiveImageSource source;
+    return &source;
+}
+
+std::unique_ptr<QIODevice> ArchiveImageSource::open(const QString &path)
+{
+    QString archivePath;
+    QString entryName;
+    if (!ZipArchive::splitPath(path, &archivePath, &entryName))
+        return nullptr;
+
+    std::shared_ptr<ZipArchive> archive = ZipArchive::open(archivePath);
+    if (!archive)
+        return nullptr;
+    return archive->openEntry(archive->indexOf(entryName));
+}
+
+qint64 ArchiveImageSource::fileSize(const QString &path)
+{
+    QString archivePath;
+    QString entryName;
+    if (!ZipArchive::splitPath(path, &archivePath, &entryName))
+        return -1;
+
+    std::shared_ptr<ZipArchive> archive = ZipArchive::open(archivePath);
+    const int index = archive ? archive->indexOf(entryName) : -1;
+    if (index < 0)
+        return -1;
+    return qint64(archive->entries()[index].uncompressedSize);
+}
+
+qint64 ArchiveImageSource::adviseWillNeed(const QString &path, qint64 maxBytes)
+{
+    QString archivePath;
+    QString entryName;
+    if (!ZipArchive::splitPath(path, &archivePath, &entryName))
+        return 0;
+
+    std::shared_ptr<ZipArchive> archive = ZipArchive::open(archivePath);
+    if (!archive)
+        return 0;
+    return archive->adviseWillNeed(archive->indexOf(entryName), maxBytes);
+}
@@ -0,0 +1,27 @@
+// archiveimagesource.h
+#ifndef ARCHIVEIMAGESOURCE_H
+#define ARCHIVEIMAGESOURCE_H
+
+#include "imagesource.h"
+
+/**
+ * @brief The ArchiveImageSource class reads images stored inside zip and CBZ archives.
+ *
+ * Paths have the form "archive.zip!/entry"; entries are read in place
+ * through ZipArchive, without extraction.
+ */
+class ArchiveImageSource : public ImageSource
+{
+public:
+    /**
+     * @brief Gets the shared instance.
+     * @return The archive backend.
+     */
+    static ArchiveImageSource *instance();
+
+    std::unique_ptr<QIODevice> open(const QString &path) override;
+    qint64 fileSize(const QString &path) override;
+    qint64 adviseWillNeed(const QString &path, qint64 maxBytes) override;
+};
+
+#endif // ARCHIVEIMAGESOURCE_H
@@ -0,0 +1,78 @@
+// archivescantask.cpp
+#include "archivescantask.h"
+#include "ziparchive.h"
+#include "formatsniffer.h"
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+
+ArchiveScanTask::ArchiveScanTask(quint64 scanId, const QString &archivePath,
+                                 std::shared_ptr<std::atomic_bool> cancelled,
+                                 QThreadPool *sniffPool)
+    : QObject(nullptr), QRunnable()
+    , m_scanId(scanId)
+    , m_archivePath(archivePath)
+    , m_cancelled(std::move(cancelled))
+    , m_sniffPool(sniffPool)
+{
+    setAutoDelete(true);
+}
+
+void ArchiveScanTask::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // Held for the whole scan so every sniff reuses this mapping and index
+    std::shared_ptr<ZipArchive> archive = ZipArchive::open(m_archivePath);
+    if (!archive) {
+        emit scanCompleted(m_scanId, 0);
+        return;
+    }
+
+    QStringList names;
+    names.reserve(archive->entries().size());
+    for (const ZipArchive::Entry &entry : archive->entries())
+        names.append(entry.name);
+    std::sort(names.begin(), names.end(), [](const QString &a, const QString &b) {
+        return QString::compare(a, b, Qt::CaseInsensitive) < 0;
+    });
+
+    int totalCount = 0;
+    int batchLimit = FirstBatchSize;
+    for (int begin = 0; begin < names.size(); begin += batchLimit) {
+        if (m_cancelled->load())
+            return;
+
+        if (begin > 0)
+            batchLimit = MaxBatchSize;
+        const int end = qMin(begin + batchLimit, int(names.size()));
+
+        QStringList batch;
+        batch.reserve(end - begin);
+        for (int i = begin; i < end; ++i)
+            batch.append(ZipArchive::entryPath(archive->archivePath(), names[i]));
+
+        const QByteArray sniffed = FormatSniffer::sniffAll(batch, m_sniffPool);
+        QStringList paths;
+        QByteArray formats;
+        for (int i = 0; i < batch.size(); ++i) {
+            if (ImageFormat(sniffed[i]) != ImageFormat::Unknown) {
+                paths.append(batch[i]);
+                formats.append(sniffed[i]);
+            }
+        }
+
+        totalCount += paths.size();
+        if (!paths.isEmpty())
+            emit batchReady(m_scanId, paths, formats);
+    }
+
+    if (m_cancelled->load())
+        return;
+
+    qDebug() << "Archive scan of" << m_archivePath << "found" << totalCount
+             << "images among" << names.size() << "entries in" << timer.elapsed() << "ms";
+
+    emit scanCompleted(m_scanId, totalCount);
+}
@@ -0,0 +1,76 @@
+// archivescantask.h
+#ifndef ARCHIVESCANTASK_H
+#define ARCHIVESCANTASK_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <memory>
+
+class QThreadPool;
+
+/**
+ * @brief The ArchiveScanTask class enumerates the images inside a zip or CBZ archive.
+ *
+ * The archive's central directory is indexed once; entries are reported as
+ * virtual paths, sorted by name so comic pages come out in reading order.
+ * Like a directory scan, entries are classified by content and delivered in
+ * batches, the first one small.
+ */
+class ArchiveScanTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs an archive scan task.
+     * @param scanId Identifier of the scan, passed back with every signal.
+     * @param archivePath The archive to enumerate.
+     * @param cancelled Flag that stops the scan when set.
+     * @param sniffPool Pool used to classify the entries of each batch.
+     */
+    ArchiveScanTask(quint64 scanId, const QString &archivePath,
+                    std::shared_ptr<std::atomic_bool> cancelled, QThreadPool *sniffPool);
+
+    /**
+     * @brief Default destructor.
+     */
+    ~ArchiveScanTask() override = default;
+
+    /**
+     * @brief Enumerates the archive.
+     *
+     * This method runs in a worker thread and emits batchReady repeatedly,
+     * followed by scanCompleted.
+     */
+    void run() override;
+
+signals:
+    /**
+     * @brief Signal emitted for each batch of discovered image paths.
+     * @param scanId The scan identifier.
+     * @param paths The discovered virtual paths.
+     * @param formats One ImageFormat value per path.
+     */
+    void batchReady(quint64 scanId, const QStringList &paths, const QByteArray &formats);
+
+    /**
+     * @brief Signal emitted when enumeration has finished.
+     * @param scanId The scan identifier.
+     * @param totalCount Number of image paths discovered.
+     */
+    void scanCompleted(quint64 scanId, int totalCount);
+
+private:
+    quint64 m_scanId;                              ///< Identifier of this scan
+    QString m_archivePath;                         ///< Archive to enumerate
+    std::shared_ptr<std::atomic_bool> m_cancelled; ///< Set when the scan is abandoned
+    QThreadPool *m_sniffPool;                      ///< Pool for format detection
+
+    static const int FirstBatchSize = 64;          ///< Small first batch for a fast first screen
+    static const int MaxBatchSize = 4096;          ///< Upper bound for later batches
+};
+
+#endif // ARCHIVESCANTASK_H
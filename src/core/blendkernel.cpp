@@ -0,0 +1,80 @@
+// blendkernel.cpp
+#include "blendkernel.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DIV_BLEND_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define DIV_BLEND_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// Two channels per multiply: the 0x00ff00ff lanes leave 8 bits of headroom
+// each, and 255 * 256 still fits
+inline quint32 blendPixel(quint32 from, quint32 to, quint32 alpha, quint32 inverse)
+{
+    const quint32 rb = (((from & 0x00ff00ff) * inverse + (to & 0x00ff00ff) * alpha) >> 8) & 0x00ff00ff;
+    const quint32 ag = (((from >> 8) & 0x00ff00ff) * inverse + ((to >> 8) & 0x00ff00ff) * alpha) & 0xff00ff00;
+    return rb | ag;
+}
+
+} // namespace
+
+void blendPixels(const quint32 *from, const quint32 *to, quint32 *dst, int count, int alpha)
+{
+    alpha = qBound(0, alpha, 256);
+    const int inverse = 256 - alpha;
+    int i = 0;
+
+#if defined(DIV_BLEND_SSE2)
+    // Widen to 16 bits per channel; both products sum to at most 255 * 256
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i weightTo = _mm_set1_epi16(static_cast<short>(alpha));
+    const __m128i weightFrom = _mm_set1_epi16(static_cast<short>(inverse));
+    for (; i + 4 <= count; i += 4) {
+        const __m128i f = _mm_loadu_si128(reinterpret_cast<const __m128i *>(from + i));
+        const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i *>(to + i));
+
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(f, zero), weightFrom),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(t, zero), weightTo));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(f, zero), weightFrom),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(t, zero), weightTo));
+        lo = _mm_srli_epi16(lo, 8);
+        hi = _mm_srli_epi16(hi, 8);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(DIV_BLEND_NEON)
+    const uint16_t weightTo = static_cast<uint16_t>(alpha);
+    const uint16_t weightFrom = static_cast<uint16_t>(inverse);
+    for (; i + 4 <= count; i += 4) {
+        const uint8x16_t f = vld1q_u8(reinterpret_cast<const uint8_t *>(from + i));
+        const uint8x16_t t = vld1q_u8(reinterpret_cast<const uint8_t *>(to + i));
+
+        uint16x8_t lo = vmulq_n_u16(vmovl_u8(vget_low_u8(f)), weightFrom);
+        lo = vmlaq_n_u16(lo, vmovl_u8(vget_low_u8(t)), weightTo);
+        uint16x8_t hi = vmulq_n_u16(vmovl_u8(vget_high_u8(f)), weightFrom);
+        hi = vmlaq_n_u16(hi, vmovl_u8(vget_high_u8(t)), weightTo);
+
+        vst1q_u8(reinterpret_cast<uint8_t *>(dst + i),
+                 vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        dst[i] = blendPixel(from[i], to[i], quint32(alpha), quint32(inverse));
+    }
+}
+
+const char *blendKernelName()
+{
+#if defined(DIV_BLEND_SSE2)
+    return "SSE2";
+#elif defined(DIV_BLEND_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,29 @@
+// blendkernel.h
+#ifndef BLENDKERNEL_H
+#define BLENDKERNEL_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Cross-fades two runs of 32-bit pixels.
+ *
+ * Each 8-bit channel becomes (from * (256 - alpha) + to * alpha) / 256, so
+ * the kernel works on any 32-bit format with four 8-bit channels (RGB32,
+ * ARGB32 premultiplied). Uses SSE2 on x86 and NEON on ARM, four pixels per
+ * step, with a scalar loop for the tail and for other targets.
+ *
+ * @param from The pixels at alpha 0.
+ * @param to The pixels at alpha 256.
+ * @param dst Receives the blend; may alias from or to.
+ * @param count Number of pixels.
+ * @param alpha Weight of to, 0 to 256.
+ */
+void blendPixels(const quint32 *from, const quint32 *to, quint32 *dst, int count, int alpha);
+
+/**
+ * @brief Gets the instruction set blendPixels() was built for.
+ * @return "SSE2", "NEON" or "scalar".
+ */
+const char *blendKernelName();
+
+#endif // BLENDKERNEL_H
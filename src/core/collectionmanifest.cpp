@@ -0,0 +1,197 @@
+// collectionmanifest.cpp
+#include "collectionmanifest.h"
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QDebug>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const char ManifestMagic[8] = { 'D', 'I', 'V', 'M', 'A', 'N', 'I', 'F' };
+const quint32 ByteOrderMark = 0x01020304;
+
+// On-disk layout: header, entry records, string table
+struct FileHeader {
+    char magic[8];
+    quint32 version;
+    quint32 byteOrderMark;
+    quint64 count;
+    quint64 entriesOffset;
+    quint64 stringsOffset;
+    quint64 stringsSize;
+    quint64 rootOffset;      // Root directory path, inside the string table
+    quint64 rootLength;
+};
+static_assert(sizeof(FileHeader) == 64, "manifest header layout");
+
+struct FileEntry {
+    quint64 pathOffset;
+    quint32 pathLength;
+    quint8 orientation;
+    quint8 format;
+    quint16 reserved;
+    qint64 fileSize;
+    qint64 modified;
+    qint32 width;
+    qint32 height;
+};
+static_assert(sizeof(FileEntry) == 40, "manifest entry layout");
+
+} // namespace
+
+CollectionManifest::Builder::Builder(const QString &rootPath, int expectedCount)
+    : m_rootPath(rootPath.toUtf8())
+{
+    m_entries.reserve(qint64(expectedCount) * sizeof(FileEntry));
+    m_strings.reserve(qint64(expectedCount) * 64 + m_rootPath.size());
+    m_strings.append(m_rootPath);
+}
+
+void CollectionManifest::Builder::add(const Entry &entry)
+{
+    const QByteArray path = entry.path.toUtf8();
+
+    FileEntry record = {};
+    record.pathOffset = m_strings.size();
+    record.pathLength = path.size();
+    record.orientation = entry.orientation;
+    record.format = quint8(entry.format);
+    record.fileSize = entry.fileSize;
+    record.modified = entry.modified;
+    record.width = entry.pixelSize.isValid() ? entry.pixelSize.width() : 0;
+    record.height = entry.pixelSize.isValid() ? entry.pixelSize.height() : 0;
+
+    m_strings.append(path);
+    m_entries.append(reinterpret_cast<const char *>(&record), sizeof(record));
+    ++m_count;
+}
+
+bool CollectionManifest::Builder::save(const QString &filePath) const
+{
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+
+    FileHeader header = {};
+    std::memcpy(header.magic, ManifestMagic, sizeof(header.magic));
+    header.version = Version;
+    header.byteOrderMark = ByteOrderMark;
+    header.count = m_count;
+    header.entriesOffset = sizeof(FileHeader);
+    header.stringsOffset = header.entriesOffset + m_entries.size();
+    header.stringsSize = m_strings.size();
+    header.rootOffset = 0;
+    header.rootLength = m_rootPath.size();
+
+    // QSaveFile renames into place on commit, so readers never see a partial file
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Cannot write manifest" << filePath << file.errorString();
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(m_entries);
+    file.write(m_strings);
+    return file.commit();
+}
+
+CollectionManifest::~CollectionManifest()
+{
+    if (m_data) {
+        m_file.unmap(const_cast<uchar *>(m_data));
+    }
+}
+
+std::shared_ptr<CollectionManifest> CollectionManifest::open(const QString &filePath, const QString &rootPath)
+{
+    std::shared_ptr<CollectionManifest> manifest(new CollectionManifest());
+    manifest->m_file.setFileName(filePath);
+    if (!manifest->m_file.open(QIODevice::ReadOnly))
+        return nullptr;
+
+    const qint64 fileSize = manifest->m_file.size();
+    if (fileSize < qint64(sizeof(FileHeader)))
+        return nullptr;
+
+    const uchar *data = manifest->m_file.map(0, fileSize);
+    if (!data)
+        return nullptr;
+    manifest->m_data = data;
+
+    // Validate everything the accessors rely on once, up front
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    const quint64 size = fileSize;
+    if (std::memcmp(header.magic, ManifestMagic, sizeof(header.magic)) != 0
+        || header.version != Version || header.byteOrderMark != ByteOrderMark
+        || header.count > quint64(std::numeric_limits<int>::max())
+        || header.entriesOffset != sizeof(FileHeader)
+        || header.stringsOffset != header.entriesOffset + header.count * sizeof(FileEntry)
+        || header.stringsOffset > size || header.stringsSize > size - header.stringsOffset
+        || header.rootOffset > header.stringsSize
+        || header.rootLength > header.stringsSize - header.rootOffset) {
+        qDebug() << "Ignoring invalid manifest" << filePath;
+        return nullptr;
+    }
+
+    manifest->m_entries = data + header.entriesOffset;
+    manifest->m_strings = reinterpret_cast<const char *>(data + header.stringsOffset);
+    manifest->m_stringsSize = header.stringsSize;
+    manifest->m_count = int(header.count);
+
+    const QString storedRoot = QString::fromUtf8(manifest->m_strings + header.rootOffset,
+                                                 int(header.rootLength));
+    if (storedRoot != rootPath) {
+        qDebug() << "Manifest" << filePath << "belongs to" << storedRoot;
+        return nullptr;
+    }
+
+    return manifest;
+}
+
+QString CollectionManifest::manifestPath(const QString &rootPath, bool recursive)
+{
+    const QByteArray key = (rootPath + (recursive ? "|recursive" : "")).toUtf8();
+    const QString name = QString::fromLatin1(
+        QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex());
+
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+           + "/manifests/" + name + ".manifest";
+}
+
+QString CollectionManifest::path(int index) const
+{
+    if (index < 0 || index >= m_count)
+        return QString();
+
+    FileEntry record;
+    std::memcpy(&record, m_entries + qint64(index) * sizeof(FileEntry), sizeof(record));
+    if (record.pathOffset > m_stringsSize || record.pathLength > m_stringsSize - record.pathOffset)
+        return QString();
+
+    return QString::fromUtf8(m_strings + record.pathOffset, int(record.pathLength));
+}
+
+CollectionManifest::Entry CollectionManifest::entry(int index) const
+{
+    Entry entry;
+    if (index < 0 || index >= m_count)
+        return entry;
+
+    FileEntry record;
+    std::memcpy(&record, m_entries + qint64(index) * sizeof(FileEntry), sizeof(record));
+
+    entry.path = path(index);
+    entry.fileSize = record.fileSize;
+    entry.modified = record.modified;
+    entry.orientation = (record.orientation >= 1 && record.orientation <= 8) ? record.orientation : 1;
+    entry.format = (record.format <= quint8(ImageFormat::Webp)) ? ImageFormat(record.format)
+                                                                : ImageFormat::Unknown;
+    if (record.width > 0 && record.height > 0) {
+        entry.pixelSize = QSize(record.width, record.height);
+    }
+    return entry;
+}
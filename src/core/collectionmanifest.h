@@ -0,0 +1,137 @@
+// collectionmanifest.h
+#ifndef COLLECTIONMANIFEST_H
+#define COLLECTIONMANIFEST_H
+
+#include <QString>
+#include <QByteArray>
+#include <QSize>
+#include <QFile>
+#include <memory>
+#include "formatsniffer.h"
+
+/**
+ * @brief The CollectionManifest class is a memory-mapped index of a scanned collection.
+ *
+ * A manifest stores, for every image of a directory in collection order, its
+ * path, file size, modification time, pixel size, EXIF orientation and
+ * detected format. It is
+ * written after a scan and mapped read-only on the next open, so a known
+ * collection can be shown with correct image proportions without listing the
+ * directory or decoding anything. Entries are fixed-size records followed by
+ * a UTF-8 string table; nothing is parsed until an entry is accessed.
+ *
+ * The file is in host byte order and is simply rejected (and rebuilt) if it
+ * does not match the running build.
+ */
+class CollectionManifest
+{
+public:
+    /**
+     * @brief One image of the collection.
+     */
+    struct Entry {
+        QString path;          ///< Absolute file path
+        qint64 fileSize = -1;  ///< File size in bytes
+        qint64 modified = 0;   ///< Modification time in ms since the epoch
+        QSize pixelSize;       ///< Stored pixel size, invalid if unknown
+        int orientation = 1;   ///< EXIF orientation (1-8)
+        ImageFormat format = ImageFormat::Unknown; ///< Format detected from the file content
+
+        /**
+         * @brief Gets the size the image has once auto-transformed.
+         * @return The display size, invalid if unknown.
+         */
+        QSize displaySize() const
+        {
+            return (orientation >= 5 && orientation <= 8) ? pixelSize.transposed() : pixelSize;
+        }
+    };
+
+    /**
+     * @brief The Builder class assembles a manifest file.
+     */
+    class Builder
+    {
+    public:
+        /**
+         * @brief Constructs a builder.
+         * @param rootPath The directory the collection was scanned from.
+         * @param expectedCount Number of entries, used to reserve memory.
+         */
+        explicit Builder(const QString &rootPath, int expectedCount = 0);
+
+        /**
+         * @brief Appends an entry.
+         * @param entry The entry.
+         */
+        void add(const Entry &entry);
+
+        /**
+         * @brief Writes the manifest, replacing any previous file atomically.
+         * @param filePath The manifest file path.
+         * @return True on success.
+         */
+        bool save(const QString &filePath) const;
+
+    private:
+        QByteArray m_rootPath; ///< UTF-8 root path
+        QByteArray m_entries;  ///< Packed entry records
+        QByteArray m_strings;  ///< Packed UTF-8 paths
+        quint64 m_count = 0;   ///< Number of entries
+    };
+
+    /**
+     * @brief Destroys the manifest, unmapping the file.
+     */
+    ~CollectionManifest();
+
+    /**
+     * @brief Maps an existing manifest file.
+     * @param filePath The manifest file path.
+     * @param rootPath The directory the manifest must belong to.
+     * @return The manifest, or null if missing, corrupt or for another directory.
+     */
+    static std::shared_ptr<CollectionManifest> open(const QString &filePath, const QString &rootPath);
+
+    /**
+     * @brief Gets the manifest file location for a directory.
+     * @param rootPath The scanned directory.
+     * @param recursive Whether the scan included subdirectories.
+     * @return The manifest file path inside the cache directory.
+     */
+    static QString manifestPath(const QString &rootPath, bool recursive);
+
+    /**
+     * @brief Gets the number of entries.
+     * @return The entry count.
+     */
+    int count() const { return m_count; }
+
+    /**
+     * @brief Gets the path of an entry without decoding the rest of it.
+     * @param index The entry index.
+     * @return The path.
+     */
+    QString path(int index) const;
+
+    /**
+     * @brief Gets an entry.
+     * @param index The entry index.
+     * @return The entry.
+     */
+    Entry entry(int index) const;
+
+private:
+    CollectionManifest() = default;
+
+    QFile m_file;                     ///< Mapped manifest file
+    const uchar *m_data = nullptr;    ///< Start of the mapping
+    const uchar *m_entries = nullptr; ///< First entry record
+    const char *m_strings = nullptr;  ///< String table
+    quint64 m_stringsSize = 0;        ///< Size of the string table
+    int m_count = 0;                  ///< Number of entries
+
+    static const quint32 Version = 2; ///< Format version
+};
+
+#endif // COLLECTIONMANIFEST_H
@@ -0,0 +1,112 @@
+// directoryscanner.cpp
+#include "directoryscanner.h"
+#include "directoryscantask.h"
+#include "directorytreescan.h"
+#include "archivescantask.h"
+#include <QThread>
+
+DirectoryScanner::DirectoryScanner(QObject *parent)
+    : QObject(parent)
+{
+    // Recursive scans read several directories at once; more readers than
+    // cores pays off on slow or network storage, where reads mostly wait
+    m_threadPool.setMaxThreadCount(qBound(2, QThread::idealThreadCount(), 8));
+
+    // Sniffing is a tiny read per file: latency bound, so use plenty of readers
+    m_sniffPool.setMaxThreadCount(8);
+}
+
+DirectoryScanner::~DirectoryScanner()
+{
+    cancel();
+    m_threadPool.clear();
+    m_threadPool.waitForDone();
+    m_sniffPool.waitForDone();
+}
+
+void DirectoryScanner::scan(const QString &dirPath, bool recursive)
+{
+    cancel();
+
+    ++m_currentScanId;
+    m_cancelled = std::make_shared<std::atomic_bool>(false);
+    m_scanning = true;
+
+    if (recursive) {
+        auto treeScan = std::make_shared<DirectoryTreeScan>(m_currentScanId, dirPath, m_cancelled,
+                                                            this, &m_threadPool, &m_sniffPool);
+        treeScan->start();
+        return;
+    }
+
+    DirectoryScanTask *task = new DirectoryScanTask(m_currentScanId, dirPath, m_cancelled, &m_sniffPool);
+
+    connect(task, &DirectoryScanTask::batchReady,
+            this, &DirectoryScanner::onBatchReady,
+            Qt::QueuedConnection);
+    connect(task, &DirectoryScanTask::scanCompleted,
+            this, &DirectoryScanner::onScanCompleted,
+            Qt::QueuedConnection);
+
+    m_threadPool.start(task);
+}
+
+void DirectoryScanner::ingest(const QStringList &items)
+{
+    cancel();
+
+    ++m_currentScanId;
+    m_cancelled = std::make_shared<std::atomic_bool>(false);
+    m_scanning = true;
+
+    auto treeScan = std::make_shared<DirectoryTreeScan>(m_currentScanId, QString(), m_cancelled,
+                                                        this, &m_threadPool, &m_sniffPool);
+    treeScan->setRootItems(items);
+    treeScan->start();
+}
+
+void DirectoryScanner::scanArchive(const QString &archivePath)
+{
+    cancel();
+
+    ++m_currentScanId;
+    m_cancelled = std::make_shared<std::atomic_bool>(false);
+    m_scanning = true;
+
+    ArchiveScanTask *task = new ArchiveScanTask(m_currentScanId, archivePath, m_cancelled, &m_sniffPool);
+
+    connect(task, &ArchiveScanTask::batchReady,
+            this, &DirectoryScanner::onBatchReady,
+            Qt::QueuedConnection);
+    connect(task, &ArchiveScanTask::scanCompleted,
+            this, &DirectoryScanner::onScanCompleted,
+            Qt::QueuedConnection);
+
+    m_threadPool.start(task);
+}
+
+void DirectoryScanner::cancel()
+{
+    if (m_cancelled) {
+        m_cancelled->store(true);
+    }
+    m_scanning = false;
+}
+
+void DirectoryScanner::onBatchReady(quint64 scanId, const QStringList &paths, const QByteArray &formats)
+{
+    // Drop batches still queued from an abandoned scan
+    if (scanId != m_currentScanId || !m_scanning)
+        return;
+
+    emit pathsDiscovered(paths, formats);
+}
+
+void DirectoryScanner::onScanCompleted(quint64 scanId, int totalCount)
+{
+    if (scanId != m_currentScanId || !m_scanning)
+        return;
+
+    m_scanning = false;
+    emit scanFinished(totalCount);
+}
@@ -0,0 +1,112 @@
+// directoryscanner.h
+#ifndef DIRECTORYSCANNER_H
+#define DIRECTORYSCANNER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+
+/**
+ * @brief The DirectoryScanner class enumerates image directories off the GUI thread.
+ *
+ * Discovered paths are streamed to the GUI in batches as they are found.
+ * Starting a new scan (or calling cancel) abandons the previous one; batches
+ * from an abandoned scan are never delivered. Recursive scans read several
+ * directories in parallel but still deliver a deterministic order. Images are
+ * recognized by their magic bytes, so file names do not matter.
+ */
+class DirectoryScanner : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs a directory scanner.
+     * @param parent The parent object.
+     */
+    explicit DirectoryScanner(QObject *parent = nullptr);
+
+    /**
+     * @brief Destroys the scanner, abandoning any running scan.
+     */
+    ~DirectoryScanner();
+
+    /**
+     * @brief Starts enumerating the images in a directory.
+     * @param dirPath The directory to scan.
+     * @param recursive Whether to include all subdirectories, in pre-order.
+     */
+    void scan(const QString &dirPath, bool recursive = false);
+
+    /**
+     * @brief Starts enumerating the images among a list of files and directories.
+     *
+     * Used for drag and drop: files are validated in parallel, directories
+     * are expanded recursively, and results stream in like any other scan.
+     *
+     * @param items Paths of files and directories, in the order they should appear.
+     */
+    void ingest(const QStringList &items);
+
+    /**
+     * @brief Starts enumerating the images inside a zip or CBZ archive.
+     *
+     * Paths are delivered as virtual archive paths, sorted by entry name.
+     *
+     * @param archivePath The archive file.
+     */
+    void scanArchive(const QString &archivePath);
+
+    /**
+     * @brief Abandons the running scan, if any.
+     */
+    void cancel();
+
+    /**
+     * @brief Checks whether a scan is in progress.
+     * @return True while scanning.
+     */
+    bool isScanning() const { return m_scanning; }
+
+signals:
+    /**
+     * @brief Signal emitted for each batch of discovered image paths.
+     * @param paths The discovered paths.
+     * @param formats One ImageFormat value per path, as detected from the file content.
+     */
+    void pathsDiscovered(const QStringList &paths, const QByteArray &formats);
+
+    /**
+     * @brief Signal emitted when a scan has finished.
+     * @param totalCount Number of image paths discovered.
+     */
+    void scanFinished(int totalCount);
+
+private slots:
+    /**
+     * @brief Forwards a batch if it belongs to the current scan.
+     * @param scanId The scan the batch belongs to.
+     * @param paths The discovered paths.
+     * @param formats One ImageFormat value per path.
+     */
+    void onBatchReady(quint64 scanId, const QStringList &paths, const QByteArray &formats);
+
+    /**
+     * @brief Finishes the current scan.
+     * @param scanId The scan that completed.
+     * @param totalCount Number of image paths discovered.
+     */
+    void onScanCompleted(quint64 scanId, int totalCount);
+
+private:
+    QThreadPool m_threadPool;                      ///< Workers for enumeration
+    QThreadPool m_sniffPool;                       ///< Workers for format detection
+    quint64 m_currentScanId = 0;                   ///< Identifier of the current scan
+    std::shared_ptr<std::atomic_bool> m_cancelled; ///< Cancellation flag of the current scan
+    bool m_scanning = false;                       ///< Whether a scan is in progress
+};
+
+#endif // DIRECTORYSCANNER_H
@@ -0,0 +1,93 @@
+// directoryscantask.cpp
+#include "directoryscantask.h"
+#include "formatsniffer.h"
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+
+DirectoryScanTask::DirectoryScanTask(quint64 scanId, const QString &dirPath,
+                                     std::shared_ptr<std::atomic_bool> cancelled,
+                                     QThreadPool *sniffPool)
+    : QObject(nullptr), QRunnable()
+    , m_scanId(scanId)
+    , m_dirPath(dirPath)
+    , m_cancelled(std::move(cancelled))
+    , m_sniffPool(sniffPool)
+{
+    setAutoDelete(true);
+}
+
+void DirectoryScanTask::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // No name filter: misnamed images are found by their content
+    QDirIterator it(m_dirPath, QDir::Files | QDir::NoDotAndDotDot);
+
+    QStringList batch;
+    QElapsedTimer batchTimer;
+    batchTimer.start();
+    int totalCount = 0;
+    bool firstBatch = true;
+
+    while (it.hasNext()) {
+        if (m_cancelled->load())
+            return;
+
+        batch.append(it.next());
+
+        // Flush the first screenful right away, then in larger batches
+        int batchLimit = firstBatch ? FirstBatchSize : MaxBatchSize;
+        if (batch.size() >= batchLimit || batchTimer.elapsed() >= MaxBatchIntervalMs) {
+            const int imageCount = flushBatch(batch);
+            totalCount += imageCount;
+            batchTimer.restart();
+            if (imageCount > 0) {
+                firstBatch = false;
+            }
+        }
+    }
+
+    if (m_cancelled->load())
+        return;
+
+    totalCount += flushBatch(batch);
+
+    qDebug() << "Directory scan of" << m_dirPath << "found" << totalCount
+             << "images in" << timer.elapsed() << "ms";
+
+    emit scanCompleted(m_scanId, totalCount);
+}
+
+int DirectoryScanTask::flushBatch(QStringList &batch)
+{
+    if (batch.isEmpty())
+        return 0;
+
+    // Directory order is arbitrary; each batch goes out in name order and
+    // the receiver merges it into the batches before it
+    std::sort(batch.begin(), batch.end(), [](const QString &a, const QString &b) {
+        return QString::compare(a, b, Qt::CaseInsensitive) < 0;
+    });
+
+    const QByteArray sniffed = FormatSniffer::sniffAll(batch, m_sniffPool);
+
+    QStringList paths;
+    QByteArray formats;
+    paths.reserve(batch.size());
+    formats.reserve(batch.size());
+    for (int i = 0; i < batch.size(); ++i) {
+        if (ImageFormat(sniffed[i]) != ImageFormat::Unknown) {
+            paths.append(batch[i]);
+            formats.append(sniffed[i]);
+        }
+    }
+    batch.clear();
+
+    if (!paths.isEmpty()) {
+        emit batchReady(m_scanId, paths, formats);
+    }
+    return paths.size();
+}
@@ -0,0 +1,86 @@
+// directoryscantask.h
+#ifndef DIRECTORYSCANTASK_H
+#define DIRECTORYSCANTASK_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <memory>
+
+class QThreadPool;
+
+/**
+ * @brief The DirectoryScanTask class enumerates the images of one directory in the background.
+ *
+ * Paths are reported in batches while the directory is still being read, so
+ * the first screenful can be shown long before a large (or remote) directory
+ * has been listed completely. The first batch is kept small for that reason.
+ * Files are recognized by content, not by name: every batch is classified
+ * with FormatSniffer, in parallel, before it is delivered.
+ */
+class DirectoryScanTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs a directory scan task.
+     * @param scanId Identifier of the scan, passed back with every signal.
+     * @param dirPath The directory to enumerate.
+     * @param cancelled Flag that stops the scan when set.
+     * @param sniffPool Pool used to classify the files of each batch.
+     */
+    DirectoryScanTask(quint64 scanId, const QString &dirPath,
+                      std::shared_ptr<std::atomic_bool> cancelled, QThreadPool *sniffPool);
+
+    /**
+     * @brief Default destructor.
+     */
+    ~DirectoryScanTask() override = default;
+
+    /**
+     * @brief Enumerates the directory.
+     *
+     * This method runs in a worker thread and emits batchReady repeatedly,
+     * followed by scanCompleted.
+     */
+    void run() override;
+
+signals:
+    /**
+     * @brief Signal emitted for each batch of discovered image paths.
+     * @param scanId The scan identifier.
+     * @param paths The discovered paths, sorted within the batch only;
+     *              batches must be merged to get the directory in name order.
+     * @param formats One ImageFormat value per path.
+     */
+    void batchReady(quint64 scanId, const QStringList &paths, const QByteArray &formats);
+
+    /**
+     * @brief Signal emitted when enumeration has finished.
+     * @param scanId The scan identifier.
+     * @param totalCount Number of image paths discovered.
+     */
+    void scanCompleted(quint64 scanId, int totalCount);
+
+private:
+    /**
+     * @brief Sorts and classifies the pending batch and emits its images.
+     * @param batch The files collected since the last batch; cleared afterwards.
+     * @return Number of images in the batch.
+     */
+    int flushBatch(QStringList &batch);
+
+    quint64 m_scanId;                              ///< Identifier of this scan
+    QString m_dirPath;                             ///< Directory to enumerate
+    std::shared_ptr<std::atomic_bool> m_cancelled; ///< Set when the scan is abandoned
+    QThreadPool *m_sniffPool;                      ///< Pool for format detection
+
+    static const int FirstBatchSize = 64;          ///< Small first batch for a fast first screen
+    static const int MaxBatchSize = 4096;          ///< Upper bound for later batches
+    static const int MaxBatchIntervalMs = 100;     ///< Flush at least this often while scanning
+};
+
+#endif // DIRECTORYSCANTASK_H
@@ -0,0 +1,244 @@
+// directorytreescan.cpp
+#include "directorytreescan.h"
+#include "formatsniffer.h"
+#include "imagesource.h"
+#include <QThreadPool>
+#include <QMutexLocker>
+#include <QFile>
+#include <QDebug>
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <QDirIterator>
+#endif
+#include <QFileInfo>
+
+namespace {
+
+bool lessCaseInsensitive(const QString &a, const QString &b)
+{
+    return QString::compare(a, b, Qt::CaseInsensitive) < 0;
+}
+
+} // namespace
+
+DirectoryTreeScan::DirectoryTreeScan(quint64 scanId, const QString &rootPath,
+                                     std::shared_ptr<std::atomic_bool> cancelled,
+                                     QObject *receiver, QThreadPool *threadPool,
+                                     QThreadPool *sniffPool)
+    : m_scanId(scanId)
+    , m_cancelled(std::move(cancelled))
+    , m_receiver(receiver)
+    , m_threadPool(threadPool)
+    , m_sniffPool(sniffPool)
+{
+    m_root.path = rootPath;
+}
+
+void DirectoryTreeScan::setRootItems(const QStringList &items)
+{
+    m_rootItems = items;
+    m_hasRootItems = true;
+}
+
+void DirectoryTreeScan::start()
+{
+    m_timer.start();
+    m_batchTimer.start();
+    m_cursor.emplace_back(&m_root, 0);
+
+    std::shared_ptr<DirectoryTreeScan> self = shared_from_this();
+    m_threadPool->start([self]() { self->readNode(&self->m_root); });
+}
+
+void DirectoryTreeScan::readNode(Node *node)
+{
+    if (m_cancelled->load())
+        return;
+
+    // Read without the lock; only publishing the result is serialized
+    QStringList candidates;
+    QStringList subdirs;
+    if (node == &m_root && m_hasRootItems) {
+        splitItems(m_rootItems, candidates, subdirs);
+        m_rootItems.clear();
+    } else {
+        listDirectory(node->path, candidates, subdirs);
+    }
+
+    const QByteArray sniffed = FormatSniffer::sniffAll(candidates, m_sniffPool);
+    QStringList files;
+    QByteArray formats;
+    for (int i = 0; i < candidates.size(); ++i) {
+        if (ImageFormat(sniffed[i]) != ImageFormat::Unknown) {
+            files.append(candidates[i]);
+            formats.append(sniffed[i]);
+        }
+    }
+
+    std::vector<Node *> newChildren;
+    {
+        QMutexLocker locker(&m_mutex);
+
+        node->files = std::move(files);
+        node->formats = std::move(formats);
+        node->children.reserve(subdirs.size());
+        for (const QString &subdir : subdirs) {
+            node->children.push_back(std::make_unique<Node>());
+            node->children.back()->path = subdir;
+            newChildren.push_back(node->children.back().get());
+        }
+        node->ready = true;
+        ++m_directoryCount;
+
+        drain();
+    }
+
+    // Children are queued in order, so the pool tends to read them in the
+    // order they will be delivered
+    std::shared_ptr<DirectoryTreeScan> self = shared_from_this();
+    for (Node *child : newChildren) {
+        if (m_cancelled->load())
+            return;
+        m_threadPool->start([self, child]() { self->readNode(child); });
+    }
+}
+
+void DirectoryTreeScan::drain()
+{
+    if (m_cursor.empty() || m_cancelled->load())
+        return;
+
+    while (!m_cursor.empty()) {
+        Node *node = m_cursor.back().first;
+        if (!node->ready)
+            break;
+
+        if (!node->delivered) {
+            m_totalCount += node->files.size();
+            m_batch.append(node->files);
+            m_batchFormats.append(node->formats);
+            node->files.clear();
+            node->formats.clear();
+            node->delivered = true;
+        }
+
+        size_t &nextChild = m_cursor.back().second;
+        if (nextChild < node->children.size()) {
+            Node *child = node->children[nextChild++].get();
+            m_cursor.emplace_back(child, 0);
+            continue;
+        }
+
+        // Subtree complete; its nodes are no longer needed
+        m_cursor.pop_back();
+        node->children.clear();
+    }
+
+    const int batchLimit = m_firstBatch ? FirstBatchSize : MaxBatchSize;
+    if (m_cursor.empty() || m_batch.size() >= batchLimit
+        || m_batchTimer.elapsed() >= MaxBatchIntervalMs) {
+        flushBatch();
+    }
+
+    if (m_cursor.empty()) {
+        qDebug() << "Recursive scan of" << m_root.path << "found" << m_totalCount
+                 << "images in" << m_directoryCount << "directories in"
+                 << m_timer.elapsed() << "ms";
+
+        QMetaObject::invokeMethod(m_receiver, "onScanCompleted", Qt::QueuedConnection,
+                                  Q_ARG(quint64, m_scanId), Q_ARG(int, m_totalCount));
+    }
+}
+
+void DirectoryTreeScan::flushBatch()
+{
+    m_batchTimer.restart();
+    if (m_batch.isEmpty())
+        return;
+
+    QMetaObject::invokeMethod(m_receiver, "onBatchReady", Qt::QueuedConnection,
+                              Q_ARG(quint64, m_scanId), Q_ARG(QStringList, m_batch),
+                              Q_ARG(QByteArray, m_batchFormats));
+    m_batch.clear();
+    m_batchFormats.clear();
+    m_firstBatch = false;
+}
+
+void DirectoryTreeScan::listDirectory(const QString &dirPath, QStringList &files, QStringList &subdirs)
+{
+    const QString prefix = dirPath.endsWith('/') ? dirPath : dirPath + '/';
+
+#ifdef Q_OS_UNIX
+    DIR *dir = opendir(QFile::encodeName(dirPath).constData());
+    if (!dir) {
+        qDebug() << "Cannot read directory" << dirPath;
+        return;
+    }
+
+    while (dirent *entry = readdir(dir)) {
+        // Hidden entries (and . / ..) are skipped, as QDir does by default
+        if (entry->d_name[0] == '.')
+            continue;
+
+        unsigned char type = entry->d_type;
+        if (type == DT_UNKNOWN || type == DT_LNK) {
+            // Only file systems without d_type, and symlinks, need a stat
+            struct stat st;
+            int flags = (type == DT_LNK) ? 0 : AT_SYMLINK_NOFOLLOW;
+            if (fstatat(dirfd(dir), entry->d_name, &st, flags) != 0)
+                continue;
+            if (S_ISREG(st.st_mode))
+                type = DT_REG;
+            else if (S_ISDIR(st.st_mode) && entry->d_type != DT_LNK)
+                type = DT_DIR;
+            else
+                continue;
+        }
+
+        const QString name = QFile::decodeName(entry->d_name);
+        if (type == DT_DIR) {
+            subdirs.append(prefix + name);
+        } else if (type == DT_REG) {
+            files.append(prefix + name);
+        }
+    }
+    closedir(dir);
+#else
+    QDirIterator it(dirPath, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        if (info.isDir()) {
+            subdirs.append(prefix + info.fileName());
+        } else {
+            files.append(prefix + info.fileName());
+        }
+    }
+#endif
+
+    std::sort(files.begin(), files.end(), lessCaseInsensitive);
+    std::sort(subdirs.begin(), subdirs.end(), lessCaseInsensitive);
+}
+
+void DirectoryTreeScan::splitItems(const QStringList &items, QStringList &files, QStringList &subdirs)
+{
+    for (const QString &item : items) {
+        // Remote images cannot be listed; they are classified like files
+        if (ImageSource::forPath(item)->isRemote()) {
+            files.append(item);
+            continue;
+        }
+
+        const QFileInfo info(item);
+        if (info.isDir()) {
+            subdirs.append(info.absoluteFilePath());
+        } else if (info.isFile()) {
+            files.append(info.absoluteFilePath());
+        }
+    }
+}
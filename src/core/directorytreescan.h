@@ -0,0 +1,137 @@
+// directorytreescan.h
+#ifndef DIRECTORYTREESCAN_H
+#define DIRECTORYTREESCAN_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <utility>
+
+class QThreadPool;
+
+/**
+ * @brief The DirectoryTreeScan class enumerates the images of a directory tree in parallel.
+ *
+ * Every directory is read by its own pool task, so several directories are
+ * listed at once; on POSIX systems entries are read with readdir and their
+ * type taken from d_type, avoiding a stat call per file. Whatever order the
+ * reads finish in, paths are delivered in a fixed pre-order: the sorted files
+ * of a directory, then each sorted subdirectory in turn. Output is streamed
+ * as soon as the next part of that order is known. Files are classified by
+ * content with FormatSniffer; anything that is not a supported image is dropped.
+ *
+ * Results are delivered to the receiver's onBatchReady(quint64, QStringList,
+ * QByteArray) and onScanCompleted(quint64, int) slots through queued invocations.
+ * Symbolic links to directories are not followed, which rules out cycles.
+ */
+class DirectoryTreeScan : public std::enable_shared_from_this<DirectoryTreeScan>
+{
+public:
+    /**
+     * @brief Constructs a tree scan.
+     * @param scanId Identifier of the scan, passed back with every result.
+     * @param rootPath The directory tree to enumerate.
+     * @param cancelled Flag that stops the scan when set.
+     * @param receiver Object receiving the results; must outlive the pool's tasks.
+     * @param threadPool Pool the directory reads run on.
+     * @param sniffPool Pool used to classify files; must differ from threadPool.
+     */
+    DirectoryTreeScan(quint64 scanId, const QString &rootPath,
+                      std::shared_ptr<std::atomic_bool> cancelled,
+                      QObject *receiver, QThreadPool *threadPool, QThreadPool *sniffPool);
+
+    /**
+     * @brief Replaces the root directory by an explicit list of files and directories.
+     *
+     * The items take the place of the root's listing, in the given order:
+     * files are classified, directories are expanded recursively. Must be
+     * called before start().
+     *
+     * @param items Paths of files and directories.
+     */
+    void setRootItems(const QStringList &items);
+
+    /**
+     * @brief Starts reading the root directory.
+     */
+    void start();
+
+private:
+    /**
+     * @brief One directory of the tree.
+     */
+    struct Node {
+        QString path;                                ///< Directory path
+        QStringList files;                           ///< Sorted image paths, cleared once delivered
+        QByteArray formats;                          ///< One ImageFormat value per file
+        std::vector<std::unique_ptr<Node>> children; ///< Sorted subdirectories
+        bool ready = false;                          ///< The directory has been read
+        bool delivered = false;                      ///< Its files were handed to the batch
+    };
+
+    /**
+     * @brief Reads one directory and schedules its subdirectories.
+     * @param node The directory to read.
+     */
+    void readNode(Node *node);
+
+    /**
+     * @brief Lists a directory.
+     * @param dirPath The directory.
+     * @param files Receives the sorted paths of all regular files.
+     * @param subdirs Receives the sorted subdirectory paths.
+     */
+    static void listDirectory(const QString &dirPath, QStringList &files, QStringList &subdirs);
+
+    /**
+     * @brief Splits explicit root items into files and directories.
+     * @param items Paths of files and directories.
+     * @param files Receives the file paths, in the given order.
+     * @param subdirs Receives the directory paths, in the given order.
+     */
+    static void splitItems(const QStringList &items, QStringList &files, QStringList &subdirs);
+
+    /**
+     * @brief Delivers everything that is next in pre-order and already read.
+     *
+     * Must be called with m_mutex held.
+     */
+    void drain();
+
+    /**
+     * @brief Sends the pending batch to the receiver.
+     *
+     * Must be called with m_mutex held.
+     */
+    void flushBatch();
+
+    quint64 m_scanId;                                ///< Identifier of this scan
+    std::shared_ptr<std::atomic_bool> m_cancelled;   ///< Set when the scan is abandoned
+    QObject *m_receiver;                             ///< Receiver of batches
+    QThreadPool *m_threadPool;                       ///< Pool for directory reads
+    QThreadPool *m_sniffPool;                        ///< Pool for format detection
+
+    QMutex m_mutex;                                  ///< Guards everything below
+    Node m_root;                                     ///< Root of the tree
+    QStringList m_rootItems;                         ///< Explicit root listing, if any
+    bool m_hasRootItems = false;                     ///< The root is m_rootItems, not a directory
+    std::vector<std::pair<Node *, size_t>> m_cursor; ///< Pre-order position: node and next child
+    QStringList m_batch;                             ///< Paths not yet delivered
+    QByteArray m_batchFormats;                       ///< Formats of m_batch
+    QElapsedTimer m_batchTimer;                      ///< Time since the last delivery
+    QElapsedTimer m_timer;                           ///< Time since the scan started
+    bool m_firstBatch = true;                        ///< No batch has been delivered yet
+    int m_totalCount = 0;                            ///< Paths delivered so far
+    int m_directoryCount = 0;                        ///< Directories read so far
+
+    static const int FirstBatchSize = 64;            ///< Small first batch for a fast first screen
+    static const int MaxBatchSize = 4096;            ///< Upper bound for later batches
+    static const int MaxBatchIntervalMs = 100;       ///< Flush at least this often while scanning
+};
+
+#endif // DIRECTORYTREESCAN_H
@@ -0,0 +1,316 @@
+// directorywatcher.cpp
+#include "directorywatcher.h"
+#include "formatsniffer.h"
+#include <QTimer>
+#include <QSocketNotifier>
+#include <QFileSystemWatcher>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QDir>
+#include <QPointer>
+#include <QThreadPool>
+#include <QCoreApplication>
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+DirectoryWatcher::DirectoryWatcher(QObject *parent)
+    : QObject(parent)
+    , m_flushTimer(new QTimer(this))
+{
+    // Not restarted on every event, so a steady stream of writes still gets delivered
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(FlushIntervalMs);
+    connect(m_flushTimer, &QTimer::timeout, this, &DirectoryWatcher::flush);
+}
+
+DirectoryWatcher::~DirectoryWatcher()
+{
+    stop();
+}
+
+bool DirectoryWatcher::watch(const QString &dirPath)
+{
+    stop();
+    m_dirPath = QDir(dirPath).absolutePath();
+
+#ifdef Q_OS_LINUX
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd >= 0) {
+        // CLOSE_WRITE rather than CREATE/MODIFY: report files only once fully written
+        const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE
+                              | IN_DELETE_SELF | IN_MOVE_SELF;
+        if (inotify_add_watch(m_inotifyFd, QFile::encodeName(m_dirPath).constData(), mask) >= 0) {
+            m_notifier = new QSocketNotifier(m_inotifyFd, QSocketNotifier::Read, this);
+            connect(m_notifier, &QSocketNotifier::activated,
+                    this, &DirectoryWatcher::readInotifyEvents);
+            return true;
+        }
+        qDebug() << "inotify_add_watch failed for" << m_dirPath << "- falling back";
+        ::close(m_inotifyFd);
+        m_inotifyFd = -1;
+    }
+#endif
+
+    m_fsWatcher = new QFileSystemWatcher(this);
+    if (!m_fsWatcher->addPath(m_dirPath)) {
+        delete m_fsWatcher;
+        m_fsWatcher = nullptr;
+        m_dirPath.clear();
+        return false;
+    }
+    connect(m_fsWatcher, &QFileSystemWatcher::directoryChanged,
+            this, &DirectoryWatcher::onDirectoryChanged);
+
+    // The first listing only establishes the baseline to diff against
+    startSnapshot();
+    return true;
+}
+
+void DirectoryWatcher::stop()
+{
+    ++m_generation;
+    m_flushTimer->stop();
+    m_pendingChanged.clear();
+    m_pendingRemoved.clear();
+    m_overflowed = false;
+    m_rootRemoved = false;
+
+    delete m_notifier;
+    m_notifier = nullptr;
+#ifdef Q_OS_LINUX
+    if (m_inotifyFd >= 0) {
+        ::close(m_inotifyFd);
+        m_inotifyFd = -1;
+    }
+#endif
+
+    delete m_fsWatcher;
+    m_fsWatcher = nullptr;
+    m_snapshot.clear();
+    m_snapshotValid = false;
+    m_backgroundBusy = false;
+
+    m_dirPath.clear();
+}
+
+void DirectoryWatcher::readInotifyEvents()
+{
+#ifdef Q_OS_LINUX
+    alignas(inotify_event) char buffer[64 * 1024];
+
+    for (;;) {
+        ssize_t length = ::read(m_inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            if (length < 0 && errno == EINTR)
+                continue;
+            break;
+        }
+
+        for (char *ptr = buffer; ptr < buffer + length; ) {
+            const inotify_event *event = reinterpret_cast<const inotify_event *>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                m_overflowed = true;
+                continue;
+            }
+            if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+                // Nothing left to rescan; reported from flush(), where the
+                // notifier delivering this can safely be torn down
+                m_rootRemoved = true;
+                continue;
+            }
+            if (event->len == 0 || (event->mask & IN_ISDIR))
+                continue;
+
+            const QString fileName = QFile::decodeName(event->name);
+            if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+                noteChanged(fileName);
+            else if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+                noteRemoved(fileName);
+        }
+    }
+
+    if ((m_overflowed || m_rootRemoved) && !m_flushTimer->isActive())
+        m_flushTimer->start();
+#endif
+}
+
+void DirectoryWatcher::onDirectoryChanged()
+{
+    if (!m_flushTimer->isActive())
+        m_flushTimer->start();
+}
+
+void DirectoryWatcher::noteChanged(const QString &fileName)
+{
+    // The latest event for a name wins
+    m_pendingRemoved.remove(fileName);
+    m_pendingChanged.insert(fileName);
+
+    if (!m_flushTimer->isActive())
+        m_flushTimer->start();
+}
+
+void DirectoryWatcher::noteRemoved(const QString &fileName)
+{
+    // Not filtered: a deleted file cannot be classified, and unknown paths are ignored downstream
+    m_pendingChanged.remove(fileName);
+    m_pendingRemoved.insert(fileName);
+
+    if (!m_flushTimer->isActive())
+        m_flushTimer->start();
+}
+
+void DirectoryWatcher::flush()
+{
+    // One background job at a time keeps batches in event order
+    if (m_backgroundBusy) {
+        m_flushTimer->start();
+        return;
+    }
+
+    // A listing of a directory that is gone would report every file removed
+    if (m_fsWatcher && !QFileInfo(m_dirPath).isDir()) {
+        m_rootRemoved = true;
+    }
+    if (m_rootRemoved) {
+        const QString dirPath = m_dirPath;
+        qDebug() << "Watched directory" << dirPath << "went away";
+        stop();
+        emit directoryRemoved(dirPath);
+        return;
+    }
+
+    if (m_fsWatcher) {
+        // Fallback mode: changes are only known after re-listing
+        startSnapshot();
+        return;
+    }
+
+    if (m_overflowed) {
+        m_overflowed = false;
+        m_pendingChanged.clear();
+        m_pendingRemoved.clear();
+        emit rescanRequired();
+        return;
+    }
+
+    const QDir dir(m_dirPath);
+    auto toPaths = [&dir](const QSet<QString> &names) {
+        QStringList paths;
+        paths.reserve(names.size());
+        for (const QString &name : names)
+            paths.append(dir.filePath(name));
+        paths.sort(Qt::CaseInsensitive);
+        return paths;
+    };
+
+    const QStringList removed = toPaths(m_pendingRemoved);
+    const QStringList changed = toPaths(m_pendingChanged);
+    m_pendingChanged.clear();
+    m_pendingRemoved.clear();
+
+    if (changed.isEmpty()) {
+        if (!removed.isEmpty())
+            emit filesRemoved(removed);
+        return;
+    }
+
+    // Changed files are classified by content, off the GUI thread
+    m_backgroundBusy = true;
+    const quint64 generation = m_generation;
+    QPointer<DirectoryWatcher> self(this);
+
+    QThreadPool::globalInstance()->start([self, generation, removed, changed]() {
+        QStringList images;
+        QByteArray formats;
+        classify(changed, images, formats);
+
+        // The watcher may be destroyed on the GUI thread at any moment, so the
+        // result is posted to the application and the pointer checked there
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [self, generation, removed, images, formats]() {
+            if (!self || self->m_generation != generation)
+                return;
+            self->deliver(removed, images, formats);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void DirectoryWatcher::deliver(const QStringList &removed, const QStringList &changed,
+                               const QByteArray &formats)
+{
+    m_backgroundBusy = false;
+
+    if (!removed.isEmpty())
+        emit filesRemoved(removed);
+    if (!changed.isEmpty())
+        emit filesChanged(changed, formats);
+}
+
+void DirectoryWatcher::classify(const QStringList &paths, QStringList &images, QByteArray &formats)
+{
+    for (const QString &path : paths) {
+        const ImageFormat format = FormatSniffer::sniff(path);
+        if (format != ImageFormat::Unknown) {
+            images.append(path);
+            formats.append(char(format));
+        }
+    }
+}
+
+void DirectoryWatcher::startSnapshot()
+{
+    m_backgroundBusy = true;
+
+    const QString dirPath = m_dirPath;
+    const quint64 generation = m_generation;
+    const QHash<QString, qint64> previous = m_snapshot;
+    const bool baseline = !m_snapshotValid;
+    QPointer<DirectoryWatcher> self(this);
+
+    QThreadPool::globalInstance()->start([self, dirPath, generation, previous, baseline]() {
+        QHash<QString, qint64> current;
+        QDirIterator it(dirPath, QDir::Files | QDir::NoDotAndDotDot);
+        while (it.hasNext()) {
+            it.next();
+            const QFileInfo info = it.fileInfo();
+            current.insert(info.fileName(), info.lastModified().toMSecsSinceEpoch());
+        }
+
+        QStringList changed;
+        QStringList removed;
+        if (!baseline) {
+            const QDir dir(dirPath);
+            for (auto i = current.cbegin(); i != current.cend(); ++i) {
+                auto old = previous.constFind(i.key());
+                if (old == previous.cend() || old.value() != i.value())
+                    changed.append(dir.filePath(i.key()));
+            }
+            for (auto i = previous.cbegin(); i != previous.cend(); ++i) {
+                if (!current.contains(i.key()))
+                    removed.append(dir.filePath(i.key()));
+            }
+            changed.sort(Qt::CaseInsensitive);
+            removed.sort(Qt::CaseInsensitive);
+        }
+
+        QStringList images;
+        QByteArray formats;
+        classify(changed, images, formats);
+
+        // Posted to the application for the same reason as in flush()
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [self, generation, current, removed, images, formats]() {
+            if (!self || self->m_generation != generation)
+                return;
+            self->m_snapshot = current;
+            self->m_snapshotValid = true;
+            self->deliver(removed, images, formats);
+        }, Qt::QueuedConnection);
+    });
+}
@@ -0,0 +1,167 @@
+// directorywatcher.h
+#ifndef DIRECTORYWATCHER_H
+#define DIRECTORYWATCHER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QSet>
+#include <QHash>
+#include <QByteArray>
+
+class QTimer;
+class QSocketNotifier;
+class QFileSystemWatcher;
+
+/**
+ * @brief The DirectoryWatcher class reports image files appearing, changing or disappearing.
+ *
+ * On Linux inotify is used directly, which names the affected file in every
+ * event, so no directory re-listing is needed no matter how many files the
+ * directory holds. Files are only reported once they have been closed after
+ * writing (or renamed into place), never while half-written. Elsewhere a
+ * QFileSystemWatcher triggers a background re-listing that is diffed against
+ * the previous one.
+ *
+ * Changed files are classified by content (see FormatSniffer) in the
+ * background before they are reported, so only images are delivered.
+ *
+ * Events are coalesced and delivered at most once per flush interval, so a
+ * capture rig writing continuously causes a steady trickle of small batches
+ * rather than one update per file.
+ */
+class DirectoryWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs a directory watcher.
+     * @param parent The parent object.
+     */
+    explicit DirectoryWatcher(QObject *parent = nullptr);
+
+    /**
+     * @brief Destroys the watcher.
+     */
+    ~DirectoryWatcher();
+
+    /**
+     * @brief Starts watching a directory, replacing any previous one.
+     * @param dirPath The directory to watch.
+     * @return True if watching could be started.
+     */
+    bool watch(const QString &dirPath);
+
+    /**
+     * @brief Stops watching.
+     */
+    void stop();
+
+    /**
+     * @brief Gets the directory being watched.
+     * @return The watched directory, or an empty string.
+     */
+    QString directory() const { return m_dirPath; }
+
+signals:
+    /**
+     * @brief Signal emitted for image files that were created or rewritten.
+     * @param paths The affected file paths.
+     * @param formats One ImageFormat value per path.
+     */
+    void filesChanged(const QStringList &paths, const QByteArray &formats);
+
+    /**
+     * @brief Signal emitted for files that were deleted or moved away.
+     *
+     * Deleted files cannot be classified, so these may include non-images.
+     *
+     * @param paths The affected file paths.
+     */
+    void filesRemoved(const QStringList &paths);
+
+    /**
+     * @brief Signal emitted when events were lost and the directory must be re-read.
+     */
+    void rescanRequired();
+
+    /**
+     * @brief Signal emitted when the watched directory itself was deleted or moved.
+     *
+     * The watcher has stopped by then; pending changes are dropped.
+     *
+     * @param dirPath The directory that was watched.
+     */
+    void directoryRemoved(const QString &dirPath);
+
+private slots:
+    /**
+     * @brief Reads all pending inotify events.
+     */
+    void readInotifyEvents();
+
+    /**
+     * @brief Schedules a re-listing after QFileSystemWatcher reported a change.
+     */
+    void onDirectoryChanged();
+
+    /**
+     * @brief Delivers the coalesced changes.
+     */
+    void flush();
+
+private:
+    /**
+     * @brief Records a created or rewritten file.
+     * @param fileName The file name inside the watched directory.
+     */
+    void noteChanged(const QString &fileName);
+
+    /**
+     * @brief Records a deleted or moved-away file.
+     * @param fileName The file name inside the watched directory.
+     */
+    void noteRemoved(const QString &fileName);
+
+    /**
+     * @brief Re-lists the directory in the background and diffs it (fallback mode).
+     */
+    void startSnapshot();
+
+    /**
+     * @brief Emits the results of a background job and allows the next one.
+     * @param removed Removed file paths.
+     * @param changed Changed image paths.
+     * @param formats One ImageFormat value per changed path.
+     */
+    void deliver(const QStringList &removed, const QStringList &changed, const QByteArray &formats);
+
+    /**
+     * @brief Keeps the images among a list of files.
+     * @param paths The file paths.
+     * @param images Receives the paths that are supported images.
+     * @param formats Receives one ImageFormat value per image.
+     */
+    static void classify(const QStringList &paths, QStringList &images, QByteArray &formats);
+
+    QString m_dirPath;                         ///< Watched directory
+    QTimer *m_flushTimer;                      ///< Coalescing interval
+    QSet<QString> m_pendingChanged;            ///< Changed file names since the last flush
+    QSet<QString> m_pendingRemoved;            ///< Removed file names since the last flush
+    bool m_overflowed = false;                 ///< Events were lost since the last flush
+    bool m_rootRemoved = false;                ///< The watched directory itself went away
+
+    int m_inotifyFd = -1;                      ///< inotify instance (Linux)
+    QSocketNotifier *m_notifier = nullptr;     ///< Read notifier for the inotify fd
+
+    QFileSystemWatcher *m_fsWatcher = nullptr; ///< Portable fallback
+    QHash<QString, qint64> m_snapshot;         ///< File name -> mtime from the last listing (fallback)
+    bool m_snapshotValid = false;              ///< m_snapshot holds a completed listing (fallback)
+    bool m_backgroundBusy = false;             ///< A listing or classification job is in progress
+    quint64 m_generation = 0;                  ///< Invalidates results of a previous watch
+
+    static const int FlushIntervalMs = 500;    ///< Maximum delay before changes are delivered
+};
+
+#endif // DIRECTORYWATCHER_H
@@ -0,0 +1,263 @@
+// exifreader.cpp
+#include "exifreader.h"
+#include "imagesource.h"
+#include <QIODevice>
+#include <QTransform>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+
+// JPEG markers relevant to walking the header segments
+const uchar MarkerPrefix = 0xFF;
+const uchar MarkerSOI = 0xD8;
+const uchar MarkerEOI = 0xD9;
+const uchar MarkerSOS = 0xDA;
+const uchar MarkerAPP1 = 0xE1;
+
+// TIFF tags used by the viewer
+const quint16 TagMake = 0x010F;
+const quint16 TagModel = 0x0110;
+const quint16 TagOrientation = 0x0112;
+const quint16 TagDateTime = 0x0132;
+const quint16 TagExifIfd = 0x8769;
+const quint16 TagDateTimeOriginal = 0x9003;
+const quint16 TagThumbnailOffset = 0x0201;
+const quint16 TagThumbnailLength = 0x0202;
+const quint16 TypeAscii = 2;
+const quint16 TypeShort = 3;
+
+/**
+ * @brief Finds the Exif APP1 segment in a JPEG header.
+ * @param head The first bytes of the file.
+ * @param tiffStart Receives the offset of the TIFF header inside the segment (optional).
+ * @return The offset just past the segment, or 0 if it does not start within head.
+ */
+int exifSegmentEnd(const QByteArray &head, int *tiffStart = nullptr)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(head.constData());
+    const int size = head.size();
+
+    if (size < 4 || p[0] != MarkerPrefix || p[1] != MarkerSOI)
+        return 0;
+
+    int pos = 2;
+    while (pos + 10 <= size) {
+        if (p[pos] != MarkerPrefix)
+            return 0;
+
+        uchar marker = p[pos + 1];
+        if (marker == MarkerPrefix) {
+            // Fill byte
+            ++pos;
+            continue;
+        }
+        if (marker == MarkerEOI || marker == MarkerSOS)
+            return 0;
+
+        int length = (p[pos + 2] << 8) | p[pos + 3];
+        if (length < 2)
+            return 0;
+
+        if (marker == MarkerAPP1 && std::memcmp(p + pos + 4, "Exif\0\0", 6) == 0) {
+            if (tiffStart) {
+                *tiffStart = pos + 10;
+            }
+            return pos + 2 + length;
+        }
+
+        pos += 2 + length;
+    }
+
+    return 0;
+}
+
+} // namespace
+
+ExifInfo ExifReader::read(const QString &path)
+{
+    // A remote head read is one range request; opening would download the image
+    ImageSource *source = ImageSource::forPath(path);
+    if (source->isRemote())
+        return parse(source->readHead(path, MaxHeadBytes));
+
+    std::unique_ptr<QIODevice> device = source->open(path);
+    if (!device)
+        return ExifInfo();
+    return read(device.get());
+}
+
+ExifInfo ExifReader::read(QIODevice *device)
+{
+    QByteArray head = device->read(InitialReadBytes);
+
+    // A large APP1 segment (big thumbnail, maker notes) needs one more read,
+    // bounded by the 64 KB segment size limit
+    int segmentEnd = exifSegmentEnd(head);
+    if (segmentEnd > head.size()) {
+        head += device->read(segmentEnd - head.size());
+    }
+
+    return parse(head);
+}
+
+ExifInfo ExifReader::parse(const QByteArray &data)
+{
+    ExifInfo info;
+
+    int tiffStart = 0;
+    int segmentEnd = exifSegmentEnd(data, &tiffStart);
+    if (segmentEnd <= 0 || segmentEnd > data.size())
+        return info;
+
+    info.valid = true;
+    parseTiff(data.mid(tiffStart, segmentEnd - tiffStart), info);
+    return info;
+}
+
+void ExifReader::parseTiff(const QByteArray &tiff, ExifInfo &info)
+{
+    const uchar *t = reinterpret_cast<const uchar *>(tiff.constData());
+    const qint64 size = tiff.size();
+
+    if (size < 8)
+        return;
+
+    bool littleEndian;
+    if (t[0] == 'I' && t[1] == 'I') {
+        littleEndian = true;
+    } else if (t[0] == 'M' && t[1] == 'M') {
+        littleEndian = false;
+    } else {
+        return;
+    }
+
+    // Bounds-checked readers; out-of-range reads yield 0
+    auto read16 = [&](qint64 offset) -> quint32 {
+        if (offset < 0 || offset + 2 > size) return 0;
+        return littleEndian ? qFromLittleEndian<quint16>(t + offset)
+                            : qFromBigEndian<quint16>(t + offset);
+    };
+    auto read32 = [&](qint64 offset) -> quint32 {
+        if (offset < 0 || offset + 4 > size) return 0;
+        return littleEndian ? qFromLittleEndian<quint32>(t + offset)
+                            : qFromBigEndian<quint32>(t + offset);
+    };
+
+    // ASCII values of up to four bytes sit in the entry itself
+    auto readAscii = [&](qint64 entry) -> QString {
+        const quint32 count = read32(entry + 4);
+        const qint64 offset = count <= 4 ? entry + 8 : read32(entry + 8);
+        if (count == 0 || offset + count > size)
+            return QString();
+        const char *text = reinterpret_cast<const char *>(t + offset);
+        return QString::fromLatin1(text, qstrnlen(text, count)).trimmed();
+    };
+
+    if (read16(2) != 42)
+        return;
+
+    quint32 thumbnailOffset = 0;
+    quint32 thumbnailLength = 0;
+    quint32 exifIfdOffset = 0;
+    QString make;
+    QString model;
+
+    // IFD0 holds the orientation and camera, IFD1 describes the thumbnail
+    qint64 ifdOffset = read32(4);
+    for (int ifd = 0; ifd < 2 && ifdOffset > 0; ++ifd) {
+        quint32 entryCount = read16(ifdOffset);
+        if (ifdOffset + 2 + static_cast<qint64>(entryCount) * 12 + 4 > size)
+            break;
+
+        for (quint32 i = 0; i < entryCount; ++i) {
+            qint64 entry = ifdOffset + 2 + static_cast<qint64>(i) * 12;
+            quint32 tag = read16(entry);
+            quint32 type = read16(entry + 2);
+            quint32 value = (type == TypeShort) ? read16(entry + 8) : read32(entry + 8);
+
+            if (ifd == 0 && tag == TagOrientation) {
+                if (value >= 1 && value <= 8) {
+                    info.orientation = static_cast<int>(value);
+                }
+            } else if (ifd == 0 && type == TypeAscii && tag == TagMake) {
+                make = readAscii(entry);
+            } else if (ifd == 0 && type == TypeAscii && tag == TagModel) {
+                model = readAscii(entry);
+            } else if (ifd == 0 && type == TypeAscii && tag == TagDateTime) {
+                info.dateTaken = readAscii(entry);
+            } else if (ifd == 0 && tag == TagExifIfd) {
+                exifIfdOffset = value;
+            } else if (ifd == 1 && tag == TagThumbnailOffset) {
+                thumbnailOffset = value;
+            } else if (ifd == 1 && tag == TagThumbnailLength) {
+                thumbnailLength = value;
+            }
+        }
+
+        ifdOffset = read32(ifdOffset + 2 + static_cast<qint64>(entryCount) * 12);
+    }
+
+    // The capture time lives in the Exif sub-IFD and beats IFD0's
+    // modification time
+    if (exifIfdOffset > 0) {
+        const quint32 entryCount = read16(exifIfdOffset);
+        if (exifIfdOffset + 2 + static_cast<qint64>(entryCount) * 12 <= size) {
+            for (quint32 i = 0; i < entryCount; ++i) {
+                const qint64 entry = exifIfdOffset + 2 + static_cast<qint64>(i) * 12;
+                if (read16(entry) == TagDateTimeOriginal && read16(entry + 2) == TypeAscii) {
+                    const QString original = readAscii(entry);
+                    if (!original.isEmpty()) {
+                        info.dateTaken = original;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    // Most models repeat the make
+    info.camera = model.startsWith(make, Qt::CaseInsensitive)
+                      ? model
+                      : (make + QLatin1Char(' ') + model).trimmed();
+
+    if (thumbnailOffset > 0 && thumbnailLength > 0
+        && static_cast<qint64>(thumbnailOffset) + thumbnailLength <= size) {
+        info.thumbnailData = tiff.mid(thumbnailOffset, thumbnailLength);
+    }
+}
+
+QImage ExifReader::readThumbnail(const QString &path)
+{
+    ExifInfo info = read(path);
+    if (info.thumbnailData.isEmpty())
+        return QImage();
+
+    QImage thumbnail = QImage::fromData(info.thumbnailData, "JPEG");
+    if (thumbnail.isNull())
+        return QImage();
+
+    return applyOrientation(thumbnail, info.orientation);
+}
+
+QImage ExifReader::applyOrientation(const QImage &image, int orientation)
+{
+    switch (orientation) {
+    case 2:
+        return image.mirrored(true, false);
+    case 3:
+        return image.transformed(QTransform().rotate(180));
+    case 4:
+        return image.mirrored(false, true);
+    case 5:
+        return image.mirrored(true, false).transformed(QTransform().rotate(270));
+    case 6:
+        return image.transformed(QTransform().rotate(90));
+    case 7:
+        return image.mirrored(true, false).transformed(QTransform().rotate(90));
+    case 8:
+        return image.transformed(QTransform().rotate(270));
+    default:
+        return image;
+    }
+}
@@ -0,0 +1,84 @@
+// exifreader.h
+#ifndef EXIFREADER_H
+#define EXIFREADER_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+
+class QIODevice;
+
+/**
+ * @brief Structure holding the EXIF fields the viewer cares about.
+ */
+struct ExifInfo {
+    int orientation = 1;        ///< EXIF orientation (1-8, 1 = upright)
+    QByteArray thumbnailData;   ///< Embedded JPEG thumbnail, empty if none
+    QString dateTaken;          ///< DateTimeOriginal ("YYYY:MM:DD HH:MM:SS"), else DateTime; empty if none
+    QString camera;             ///< Camera make and model, empty if none
+    bool valid = false;         ///< Whether an EXIF block was found
+};
+
+/**
+ * @brief The ExifReader class extracts EXIF metadata from the head of a JPEG file.
+ *
+ * Only the APP1 segment at the start of the file is read, so fetching the
+ * embedded thumbnail costs one or two small reads instead of a full decode.
+ * All methods are thread-safe.
+ */
+class ExifReader
+{
+public:
+    /**
+     * @brief Reads EXIF metadata from a file.
+     *
+     * Reads the first few kilobytes, and at most up to the end of the APP1
+     * segment if it is larger.
+     *
+     * @param path The file path or virtual archive path of the image.
+     * @return The parsed EXIF information (invalid if none was found).
+     */
+    static ExifInfo read(const QString &path);
+
+    /**
+     * @brief Reads EXIF metadata from an open device positioned at the start of the image.
+     * @param device The device to read from.
+     * @return The parsed EXIF information (invalid if none was found).
+     */
+    static ExifInfo read(QIODevice *device);
+
+    /**
+     * @brief Parses EXIF metadata from the beginning of a JPEG stream.
+     * @param data The first bytes of the file.
+     * @return The parsed EXIF information (invalid if none was found).
+     */
+    static ExifInfo parse(const QByteArray &data);
+
+    /**
+     * @brief Reads and decodes the embedded thumbnail of a file, upright.
+     * @param path The file path to the image.
+     * @return The thumbnail with orientation applied, or a null image.
+     */
+    static QImage readThumbnail(const QString &path);
+
+    /**
+     * @brief Applies an EXIF orientation to an image.
+     * @param image The image as stored.
+     * @param orientation The EXIF orientation (1-8).
+     * @return The upright image.
+     */
+    static QImage applyOrientation(const QImage &image, int orientation);
+
+private:
+    /**
+     * @brief Parses the TIFF structure inside an APP1 Exif segment.
+     * @param tiff The TIFF header and IFDs.
+     * @param info Receives the parsed values.
+     */
+    static void parseTiff(const QByteArray &tiff, ExifInfo &info);
+
+    static const int InitialReadBytes = 16 * 1024; ///< First read; holds most thumbnails
+    static const int MaxHeadBytes = 66 * 1024;     ///< Bytes that always hold a complete APP1 segment
+};
+
+#endif // EXIFREADER_H
@@ -0,0 +1,204 @@
+// favoritesjournal.cpp
+#include "favoritesjournal.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QDebug>
+
+FavoritesJournal::FavoritesJournal()
+{
+    m_writer.setMaxThreadCount(1);
+}
+
+FavoritesJournal::~FavoritesJournal()
+{
+    waitForDone();
+}
+
+QSet<QString> FavoritesJournal::load(const QString &filePath)
+{
+    // Anything still queued belongs to the previous file
+    waitForDone();
+
+    m_filePath = filePath;
+    m_journalPath = filePath + ".journal";
+    m_recordCount = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // The list: one path per line, as written by every version so far.
+    // Read in one go; line-by-line text streaming dominates for 200k entries.
+    QSet<QString> favorites;
+    QFile file(m_filePath);
+    if (file.open(QIODevice::ReadOnly)) {
+        const QByteArray data = file.readAll();
+        favorites.reserve(data.count('\n') + 1);
+        for (const QByteArray &line : data.split('\n')) {
+            const QString path = QString::fromUtf8(line).trimmed();
+            if (!path.isEmpty()) {
+                favorites.insert(path);
+            }
+        }
+    }
+    const int listed = favorites.size();
+
+    // The journal: replay in order. A record only counts once its newline
+    // is on disk; a tail torn by a crash is dropped.
+    int replayed = 0;
+    bool torn = false;
+    QFile journal(m_journalPath);
+    if (journal.open(QIODevice::ReadOnly)) {
+        const QByteArray data = journal.readAll();
+        qsizetype start = 0;
+        while (start < data.size()) {
+            const qsizetype end = data.indexOf('\n', start);
+            if (end < 0) {
+                torn = true;
+                break;
+            }
+
+            const char op = data[start];
+            const QString path = QString::fromUtf8(data.constData() + start + 1, end - start - 1).trimmed();
+            if (!path.isEmpty()) {
+                if (op == '+') {
+                    favorites.insert(path);
+                    ++replayed;
+                } else if (op == '-') {
+                    favorites.remove(path);
+                    ++replayed;
+                }
+            }
+            start = end + 1;
+        }
+    }
+
+    qDebug() << "Loaded" << favorites.size() << "favorites (" << listed << "listed,"
+             << replayed << "journal records) in" << timer.elapsed() << "ms";
+
+    // Fold the journal into the list so the next load reads one file, and so
+    // new records never follow a torn one
+    if (replayed > 0 || torn) {
+        compact(QStringList(favorites.cbegin(), favorites.cend()));
+    }
+
+    return favorites;
+}
+
+void FavoritesJournal::recordAdded(const QString &path)
+{
+    append('+', path);
+}
+
+void FavoritesJournal::recordRemoved(const QString &path)
+{
+    append('-', path);
+}
+
+bool FavoritesJournal::needsCompaction(int favoriteCount) const
+{
+    // Replaying stays cheap next to reading the list as long as the journal
+    // is small relative to it
+    return m_recordCount >= MinCompactRecords && m_recordCount >= favoriteCount / 4;
+}
+
+void FavoritesJournal::append(char op, const QString &path)
+{
+    if (m_journalPath.isEmpty())
+        return;
+
+    const QByteArray encoded = path.toUtf8();
+    ++m_recordCount;
+
+    QMutexLocker locker(&m_mutex);
+    m_pending.reserve(m_pending.size() + encoded.size() + 2);
+    m_pending.append(op);
+    m_pending.append(encoded);
+    m_pending.append('\n');
+    scheduleWrite();
+}
+
+void FavoritesJournal::compact(const QStringList &favorites)
+{
+    if (m_filePath.isEmpty())
+        return;
+
+    m_recordCount = 0;
+
+    // Implicitly shared: the writer reads the caller's list without a copy
+    QMutexLocker locker(&m_mutex);
+    m_beforeSnapshot.append(m_pending);
+    m_pending.clear();
+    m_snapshot = favorites;
+    m_compactQueued = true;
+    scheduleWrite();
+}
+
+void FavoritesJournal::waitForDone()
+{
+    m_writer.waitForDone();
+}
+
+void FavoritesJournal::scheduleWrite()
+{
+    if (m_writeQueued)
+        return;
+
+    m_writeQueued = true;
+    m_writer.start([this]() { writePending(); });
+}
+
+void FavoritesJournal::writePending()
+{
+    QByteArray beforeSnapshot;
+    QByteArray records;
+    QStringList snapshot;
+    bool compact = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        beforeSnapshot.swap(m_beforeSnapshot);
+        records.swap(m_pending);
+        snapshot.swap(m_snapshot);
+        compact = m_compactQueued;
+        m_compactQueued = false;
+        m_writeQueued = false;
+    }
+
+    if (!beforeSnapshot.isEmpty()) {
+        appendToJournal(beforeSnapshot);
+    }
+
+    if (compact) {
+        QElapsedTimer timer;
+        timer.start();
+
+        QByteArray data;
+        for (const QString &path : std::as_const(snapshot)) {
+            data.append(path.toUtf8());
+            data.append('\n');
+        }
+
+        // Replaced atomically: a crash leaves the old list and the full journal
+        QSaveFile file(m_filePath);
+        if (file.open(QIODevice::WriteOnly) && file.write(data) == data.size() && file.commit()) {
+            QFile::resize(m_journalPath, 0);
+            qDebug() << "Compacted" << snapshot.size() << "favorites in" << timer.elapsed() << "ms";
+        } else {
+            qDebug() << "Failed to write favorites to" << m_filePath << ":" << file.errorString();
+        }
+    }
+
+    if (!records.isEmpty()) {
+        appendToJournal(records);
+    }
+}
+
+void FavoritesJournal::appendToJournal(const QByteArray &records)
+{
+    QFile journal(m_journalPath);
+    if (!journal.open(QIODevice::WriteOnly | QIODevice::Append)
+        || journal.write(records) != records.size()) {
+        qDebug() << "Failed to append to favorites journal" << m_journalPath << ":" << journal.errorString();
+    }
+}
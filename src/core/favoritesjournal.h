@@ -0,0 +1,133 @@
+// favoritesjournal.h
+#ifndef FAVORITESJOURNAL_H
+#define FAVORITESJOURNAL_H
+
+#include <QString>
+#include <QSet>
+#include <QStringList>
+#include <QByteArray>
+#include <QMutex>
+#include <QThreadPool>
+
+/**
+ * @brief The FavoritesJournal class persists favorites without rewriting them on every change.
+ *
+ * The favorites file itself stays a plain list of paths, one per line, so
+ * files written by earlier versions load unchanged. Changes are appended to
+ * a journal next to it ("<file>.journal") as "+path" and "-path" records.
+ * Appends are written by a background thread, so toggling a favorite never
+ * waits for the disk.
+ *
+ * Once the journal holds enough records relative to the list, the list is
+ * rewritten atomically and the journal truncated (compaction), also in the
+ * background. Loading replays the journal over the list. Replaying records
+ * the list already contains changes nothing, and a record torn by a crash
+ * is ignored, so an interrupted append or compaction never loses more than
+ * that one record.
+ */
+class FavoritesJournal
+{
+public:
+    /**
+     * @brief Constructs a journal that is not yet attached to a file.
+     */
+    FavoritesJournal();
+
+    /**
+     * @brief Destroys the journal after all queued writes have finished.
+     */
+    ~FavoritesJournal();
+
+    /**
+     * @brief Loads favorites from a file and replays its journal.
+     *
+     * Later changes are recorded against this file. If the journal had
+     * records, a compaction is queued so the next load reads one file.
+     *
+     * @param filePath The favorites file.
+     * @return The favorite paths.
+     */
+    QSet<QString> load(const QString &filePath);
+
+    /**
+     * @brief Records that a path became a favorite.
+     * @param path The image path.
+     */
+    void recordAdded(const QString &path);
+
+    /**
+     * @brief Records that a path is no longer a favorite.
+     * @param path The image path.
+     */
+    void recordRemoved(const QString &path);
+
+    /**
+     * @brief Checks whether the journal has grown enough to be worth compacting.
+     * @param favoriteCount The current number of favorites.
+     * @return True if compact() should be called.
+     */
+    bool needsCompaction(int favoriteCount) const;
+
+    /**
+     * @brief Checks whether any change has been recorded since the last compaction.
+     * @return True if the journal holds records.
+     */
+    bool hasRecords() const { return m_recordCount > 0; }
+
+    /**
+     * @brief Rewrites the favorites file and truncates the journal in the background.
+     * @param favorites The complete current list of favorites, without duplicates.
+     */
+    void compact(const QStringList &favorites);
+
+    /**
+     * @brief Blocks until all queued appends and compactions are on disk.
+     */
+    void waitForDone();
+
+private:
+    /**
+     * @brief Queues a record for the background writer.
+     * @param op '+' or '-'.
+     * @param path The image path.
+     */
+    void append(char op, const QString &path);
+
+    /**
+     * @brief Makes sure a write pass is queued on the writer thread.
+     *
+     * Must be called with m_mutex held.
+     */
+    void scheduleWrite();
+
+    /**
+     * @brief Writes everything queued so far, in the order it was queued.
+     *
+     * Runs on the writer thread. Records queued before a compaction are
+     * appended first (they are in the new list too, but the list is not on
+     * disk yet), then the list is replaced and the journal truncated, then
+     * the records queued after the compaction are appended.
+     */
+    void writePending();
+
+    /**
+     * @brief Appends encoded records to the journal.
+     * @param records The records.
+     */
+    void appendToJournal(const QByteArray &records);
+
+    static const int MinCompactRecords = 4096; ///< Journal records tolerated regardless of list size
+
+    QString m_filePath;            ///< The favorites file
+    QString m_journalPath;         ///< The journal next to it
+    int m_recordCount = 0;         ///< Records appended since the last compaction (GUI thread only)
+    QMutex m_mutex;                ///< Guards everything below
+    QByteArray m_pending;          ///< Encoded records not yet written
+    QByteArray m_beforeSnapshot;   ///< Records queued before the pending compaction
+    QStringList m_snapshot;        ///< Favorites to write by the pending compaction
+    bool m_compactQueued = false;  ///< Whether a compaction is pending
+    bool m_writeQueued = false;    ///< Whether a write pass is queued on the writer
+    QThreadPool m_writer;          ///< Single thread, so appends and compactions stay in order
+};
+
+#endif // FAVORITESJOURNAL_H
@@ -0,0 +1,88 @@
+// formatsniffer.cpp
+#include "formatsniffer.h"
+#include "imagesource.h"
+#include <QThreadPool>
+#include <QSemaphore>
+#include <cstring>
+
+ImageFormat FormatSniffer::sniff(const QString &path)
+{
+    const QByteArray header = ImageSource::forPath(path)->readHead(path, HeaderBytes);
+    return sniffHeader(reinterpret_cast<const uchar *>(header.constData()), header.size());
+}
+
+ImageFormat FormatSniffer::sniffHeader(const uchar *data, qint64 size)
+{
+    if (size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF)
+        return ImageFormat::Jpeg;
+
+    static const uchar pngSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    if (size >= 8 && std::memcmp(data, pngSignature, 8) == 0)
+        return ImageFormat::Png;
+
+    if (size >= 6 && (std::memcmp(data, "GIF87a", 6) == 0 || std::memcmp(data, "GIF89a", 6) == 0))
+        return ImageFormat::Gif;
+
+    if (size >= 12 && std::memcmp(data, "RIFF", 4) == 0 && std::memcmp(data + 8, "WEBP", 4) == 0)
+        return ImageFormat::Webp;
+
+    // "BM" alone is too weak a signature; also require a known DIB header size
+    if (size >= 18 && data[0] == 'B' && data[1] == 'M') {
+        const quint32 dibSize = quint32(data[14]) | (quint32(data[15]) << 8)
+                                | (quint32(data[16]) << 16) | (quint32(data[17]) << 24);
+        if (dibSize == 12 || dibSize == 40 || dibSize == 52 || dibSize == 56
+            || dibSize == 64 || dibSize == 108 || dibSize == 124)
+            return ImageFormat::Bmp;
+    }
+
+    return ImageFormat::Unknown;
+}
+
+QByteArray FormatSniffer::sniffAll(const QStringList &paths, QThreadPool *pool)
+{
+    QByteArray formats(paths.size(), char(ImageFormat::Unknown));
+
+    // Each range writes disjoint bytes through the same raw pointer
+    char *out = formats.data();
+    // Heads are read per range so remote backends can batch their requests
+    auto sniffRange = [&paths, out](int begin, int end) {
+        const QVector<QByteArray> heads = ImageSource::readPathHeads(paths.mid(begin, end - begin),
+                                                                     HeaderBytes);
+        for (int i = begin; i < end; ++i) {
+            const QByteArray &head = heads[i - begin];
+            out[i] = char(sniffHeader(reinterpret_cast<const uchar *>(head.constData()), head.size()));
+        }
+    };
+
+    const int chunkCount = (paths.size() + ChunkSize - 1) / ChunkSize;
+    if (!pool || chunkCount <= 1) {
+        sniffRange(0, paths.size());
+        return formats;
+    }
+
+    QSemaphore done;
+    for (int chunk = 0; chunk < chunkCount; ++chunk) {
+        const int begin = chunk * ChunkSize;
+        const int end = qMin(begin + ChunkSize, int(paths.size()));
+        pool->start([&sniffRange, &done, begin, end]() {
+            sniffRange(begin, end);
+            done.release();
+        });
+    }
+    done.acquire(chunkCount);
+
+    return formats;
+}
+
+QByteArray FormatSniffer::formatName(ImageFormat format)
+{
+    switch (format) {
+    case ImageFormat::Jpeg: return QByteArrayLiteral("jpeg");
+    case ImageFormat::Png:  return QByteArrayLiteral("png");
+    case ImageFormat::Gif:  return QByteArrayLiteral("gif");
+    case ImageFormat::Bmp:  return QByteArrayLiteral("bmp");
+    case ImageFormat::Webp: return QByteArrayLiteral("webp");
+    case ImageFormat::Unknown: break;
+    }
+    return QByteArray();
+}
@@ -0,0 +1,75 @@
+// formatsniffer.h
+#ifndef FORMATSNIFFER_H
+#define FORMATSNIFFER_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+
+class QThreadPool;
+
+/**
+ * @brief Image formats recognized by their leading bytes.
+ *
+ * Stored as one byte per image wherever formats are kept in bulk.
+ */
+enum class ImageFormat : quint8 {
+    Unknown = 0, ///< Not an image the viewer can decode
+    Jpeg,
+    Png,
+    Gif,
+    Bmp,
+    Webp
+};
+
+/**
+ * @brief The FormatSniffer class classifies files by their magic bytes.
+ *
+ * Only the first few bytes of a file are read, so a file is recognized no
+ * matter what it is called, and the decoder can be told the format up front
+ * instead of probing every plugin.
+ */
+class FormatSniffer
+{
+public:
+    /**
+     * @brief Classifies a file by reading its first bytes.
+     * @param path A file path, virtual archive path or URL.
+     * @return The detected format, Unknown if not a supported image.
+     */
+    static ImageFormat sniff(const QString &path);
+
+    /**
+     * @brief Classifies a file header.
+     * @param data The first bytes of the file.
+     * @param size Number of bytes available.
+     * @return The detected format, Unknown if not a supported image.
+     */
+    static ImageFormat sniffHeader(const uchar *data, qint64 size);
+
+    /**
+     * @brief Classifies many files, spreading the reads over a thread pool.
+     *
+     * Blocks until all files have been classified. Must not be called from a
+     * task running on the same pool.
+     *
+     * @param paths The file paths.
+     * @param pool Pool for the reads, or null to read on the calling thread.
+     * @return One ImageFormat value per path, in the same order.
+     */
+    static QByteArray sniffAll(const QStringList &paths, QThreadPool *pool);
+
+    /**
+     * @brief Gets the Qt image format name to hand to QImageReader.
+     * @param format The format.
+     * @return The format name, empty for Unknown.
+     */
+    static QByteArray formatName(ImageFormat format);
+
+    static const int HeaderBytes = 32; ///< Bytes read per file
+
+private:
+    static const int ChunkSize = 128;  ///< Files per pool task in sniffAll
+};
+
+#endif // FORMATSNIFFER_H
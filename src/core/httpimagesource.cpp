@@ -0,0 +1,453 @@
+// httpimagesource.cpp
+#include "httpimagesource.h"
+#include <QTcpSocket>
+#include <QUrl>
+#include <QFile>
+#include <QDir>
+#include <QBuffer>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QMutexLocker>
+#include <QDebug>
+#include <map>
+
+namespace {
+
+/**
+ * @brief A parsed HTTP response.
+ */
+struct HttpResponse {
+    int status = 0;          ///< Status code
+    qint64 totalSize = -1;   ///< Full size of the resource, if the response says
+    bool keepAlive = true;   ///< The connection can carry further requests
+    bool truncated = false;  ///< The body was cut off at the requested maximum
+    QByteArray body;         ///< Response body
+};
+
+/**
+ * @brief A blocking HTTP/1.1 client connection to one server.
+ *
+ * Used from a single worker thread only; requests may be pipelined by
+ * writing several before reading the responses in order.
+ */
+class HttpConnection
+{
+public:
+    HttpConnection(const QString &host, quint16 port)
+        : m_host(host)
+        , m_port(port)
+    {
+    }
+
+    bool ensureOpen()
+    {
+        if (m_socket && m_socket->state() == QAbstractSocket::ConnectedState)
+            return true;
+
+        m_socket = std::make_unique<QTcpSocket>();
+        m_socket->connectToHost(m_host, m_port);
+        if (!m_socket->waitForConnected(HttpImageSource::TimeoutMs)) {
+            qDebug() << "Cannot connect to" << m_host << m_port << m_socket->errorString();
+            m_socket.reset();
+            return false;
+        }
+        return true;
+    }
+
+    void close()
+    {
+        if (m_socket) {
+            m_socket->abort();
+            m_socket.reset();
+        }
+    }
+
+    QByteArray request(const QUrl &url, qint64 rangeBytes) const
+    {
+        QByteArray target = url.path(QUrl::FullyEncoded).toUtf8();
+        if (target.isEmpty())
+            target = "/";
+        if (url.hasQuery())
+            target += '?' + url.query(QUrl::FullyEncoded).toUtf8();
+
+        QByteArray request = "GET " + target + " HTTP/1.1\r\nHost: " + m_host.toUtf8();
+        if (m_port != 80)
+            request += ':' + QByteArray::number(m_port);
+        request += "\r\n";
+        if (rangeBytes > 0)
+            request += "Range: bytes=0-" + QByteArray::number(rangeBytes - 1) + "\r\n";
+        request += "Connection: keep-alive\r\n\r\n";
+        return request;
+    }
+
+    bool write(const QByteArray &data)
+    {
+        if (m_socket->write(data) != data.size())
+            return false;
+        while (m_socket->bytesToWrite() > 0) {
+            if (!m_socket->waitForBytesWritten(HttpImageSource::TimeoutMs))
+                return false;
+        }
+        return true;
+    }
+
+    bool readResponse(HttpResponse &response, qint64 maxBody)
+    {
+        response = HttpResponse();
+
+        QByteArray line;
+        if (!readLine(line))
+            return false;
+        const QList<QByteArray> statusParts = line.split(' ');
+        if (statusParts.size() < 2 || !statusParts[0].startsWith("HTTP/"))
+            return false;
+        response.status = statusParts[1].toInt();
+        response.keepAlive = statusParts[0] != "HTTP/1.0";
+
+        qint64 contentLength = -1;
+        bool chunked = false;
+        for (;;) {
+            if (!readLine(line))
+                return false;
+            if (line.isEmpty())
+                break;
+
+            const int colon = line.indexOf(':');
+            if (colon < 0)
+                continue;
+            const QByteArray name = line.left(colon).trimmed().toLower();
+            const QByteArray value = line.mid(colon + 1).trimmed().toLower();
+            if (name == "content-length") {
+                contentLength = value.toLongLong();
+            } else if (name == "transfer-encoding") {
+                chunked = value.contains("chunked");
+            } else if (name == "connection") {
+                if (value.contains("close"))
+                    response.keepAlive = false;
+                else if (value.contains("keep-alive"))
+                    response.keepAlive = true;
+            } else if (name == "content-range") {
+                // "bytes 0-73727/1048576"
+                const int slash = value.lastIndexOf('/');
+                bool ok = false;
+                const qint64 total = value.mid(slash + 1).toLongLong(&ok);
+                if (slash >= 0 && ok)
+                    response.totalSize = total;
+            }
+        }
+        if (response.status == 200 && contentLength >= 0)
+            response.totalSize = contentLength;
+
+        if (chunked) {
+            for (;;) {
+                if (!readLine(line))
+                    return false;
+                bool ok = false;
+                const qint64 chunkSize = line.split(';').first().trimmed().toLongLong(&ok, 16);
+                if (!ok)
+                    return false;
+                if (chunkSize == 0) {
+                    // Skip trailers up to the final empty line
+                    do {
+                        if (!readLine(line))
+                            return false;
+                    } while (!line.isEmpty());
+                    return true;
+                }
+                if (!readBody(chunkSize, response, maxBody))
+                    return false;
+                if (response.truncated)
+                    return true;
+                if (!readLine(line))
+                    return false;
+            }
+        }
+
+        if (contentLength >= 0)
+            return readBody(contentLength, response, maxBody);
+
+        // No length: the body runs until the server closes the connection
+        response.keepAlive = false;
+        for (;;) {
+            if (m_socket->bytesAvailable() == 0 && !m_socket->waitForReadyRead(HttpImageSource::TimeoutMs))
+                return m_socket->state() != QAbstractSocket::ConnectedState;
+            append(m_socket->readAll(), response, maxBody);
+            if (response.truncated)
+                return true;
+        }
+    }
+
+private:
+    bool readLine(QByteArray &line)
+    {
+        while (!m_socket->canReadLine()) {
+            if (m_socket->bytesAvailable() > MaxLineBytes)
+                return false;
+            if (!m_socket->waitForReadyRead(HttpImageSource::TimeoutMs))
+                return false;
+        }
+        line = m_socket->readLine();
+        while (line.endsWith('\n') || line.endsWith('\r'))
+            line.chop(1);
+        return true;
+    }
+
+    bool readBody(qint64 length, HttpResponse &response, qint64 maxBody)
+    {
+        while (length > 0) {
+            if (response.truncated)
+                return true;
+            if (m_socket->bytesAvailable() == 0 && !m_socket->waitForReadyRead(HttpImageSource::TimeoutMs))
+                return false;
+            const QByteArray data = m_socket->read(qMin<qint64>(length, ReadChunkBytes));
+            length -= data.size();
+            append(data, response, maxBody);
+        }
+        return true;
+    }
+
+    static void append(const QByteArray &data, HttpResponse &response, qint64 maxBody)
+    {
+        const qint64 room = maxBody - response.body.size();
+        if (data.size() > room) {
+            // A server that ignored the range would send the whole file; take
+            // what was asked for and drop the connection instead of draining it
+            response.body.append(data.left(room));
+            response.truncated = true;
+            response.keepAlive = false;
+            return;
+        }
+        response.body.append(data);
+    }
+
+    static constexpr qint64 MaxLineBytes = 64 * 1024;
+    static constexpr qint64 ReadChunkBytes = 256 * 1024;
+
+    QString m_host;
+    quint16 m_port;
+    std::unique_ptr<QTcpSocket> m_socket;
+};
+
+QString serverKey(const QUrl &url)
+{
+    return url.host() + ':' + QString::number(url.port(80));
+}
+
+// Sockets belong to the thread that created them, so each pool thread keeps
+// its own persistent connections
+HttpConnection *connectionFor(const QUrl &url)
+{
+    thread_local std::map<QString, std::unique_ptr<HttpConnection>> connections;
+
+    std::unique_ptr<HttpConnection> &connection = connections[serverKey(url)];
+    if (!connection)
+        connection = std::make_unique<HttpConnection>(url.host(), quint16(url.port(80)));
+    return connection.get();
+}
+
+void writeCache(const QString &path, const QByteArray &data)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qDebug() << "Cannot write cache file" << path;
+    }
+}
+
+} // namespace
+
+HttpImageSource::HttpImageSource()
+{
+    // Nothing is revalidated, so nothing may outlive the session
+    QDir(cacheDirectory()).removeRecursively();
+}
+
+HttpImageSource *HttpImageSource::instance()
+{
+    static HttpImageSource source;
+    return &source;
+}
+
+bool HttpImageSource::isHttpPath(const QString &path)
+{
+    return path.startsWith(QLatin1String("http://"), Qt::CaseInsensitive);
+}
+
+std::unique_ptr<QIODevice> HttpImageSource::open(const QString &path)
+{
+    const QString bodyPath = cachePath(path, "body");
+    auto cached = std::make_unique<QFile>(bodyPath);
+    if (cached->open(QIODevice::ReadOnly))
+        return cached;
+
+    const QUrl url(path);
+    HttpConnection *connection = connectionFor(url);
+
+    // A kept-alive connection may have been closed by the server while idle;
+    // retry on a fresh one before giving up
+    for (int attempt = 0; attempt < MaxAttempts; ++attempt) {
+        if (!connection->ensureOpen())
+            continue;
+
+        HttpResponse response;
+        if (!connection->write(connection->request(url, 0))
+            || !connection->readResponse(response, MaxBodyBytes)) {
+            connection->close();
+            continue;
+        }
+        if (!response.keepAlive)
+            connection->close();
+
+        if (response.status != 200 || response.truncated) {
+            qDebug() << "HTTP" << response.status << "for" << path;
+            return nullptr;
+        }
+
+        rememberSize(path, response.body.size());
+        writeCache(bodyPath, response.body);
+
+        auto buffer = std::make_unique<QBuffer>();
+        buffer->setData(response.body);
+        buffer->open(QIODevice::ReadOnly);
+        return buffer;
+    }
+
+    qDebug() << "Cannot download" << path;
+    return nullptr;
+}
+
+QByteArray HttpImageSource::readHead(const QString &path, qint64 maxSize)
+{
+    return readHeads(QStringList{path}, maxSize).first();
+}
+
+QVector<QByteArray> HttpImageSource::readHeads(const QStringList &paths, qint64 maxSize)
+{
+    QVector<QByteArray> heads(paths.size());
+
+    QHash<QString, QVector<int>> missing;
+    for (int i = 0; i < paths.size(); ++i) {
+        if (!cachedHead(paths[i], maxSize, &heads[i]))
+            missing[serverKey(QUrl(paths[i]))].append(i);
+    }
+
+    for (auto it = missing.cbegin(); it != missing.cend(); ++it)
+        fetchHeads(paths, it.value(), maxSize, heads);
+
+    return heads;
+}
+
+qint64 HttpImageSource::fileSize(const QString &path)
+{
+    const QFileInfo body(cachePath(path, "body"));
+    if (body.exists())
+        return body.size();
+
+    QMutexLocker locker(&m_mutex);
+    return m_sizes.value(path, -1);
+}
+
+bool HttpImageSource::cachedHead(const QString &url, qint64 maxSize, QByteArray *head)
+{
+    QFile body(cachePath(url, "body"));
+    if (body.open(QIODevice::ReadOnly)) {
+        *head = body.read(maxSize);
+        return true;
+    }
+
+    // A head shorter than the fetched span is the whole file
+    QFile file(cachePath(url, "head"));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    if (file.size() < maxSize && file.size() >= HeadBytes)
+        return false;
+    *head = file.read(maxSize);
+    return true;
+}
+
+void HttpImageSource::fetchHeads(const QStringList &urls, const QVector<int> &indices, qint64 maxSize,
+                                 QVector<QByteArray> &heads)
+{
+    const qint64 span = qMax<qint64>(maxSize, HeadBytes);
+    HttpConnection *connection = connectionFor(QUrl(urls[indices.first()]));
+
+    int next = 0;
+    int failures = 0;
+    while (next < indices.size() && failures < MaxAttempts) {
+        if (!connection->ensureOpen()) {
+            ++failures;
+            continue;
+        }
+
+        // Write a window of requests, then read the responses in order
+        const int windowEnd = qMin(next + int(PipelineDepth), int(indices.size()));
+        QByteArray requests;
+        for (int i = next; i < windowEnd; ++i)
+            requests += connection->request(QUrl(urls[indices[i]]), span);
+        if (!connection->write(requests)) {
+            connection->close();
+            ++failures;
+            continue;
+        }
+
+        int answered = 0;
+        for (int i = next; i < windowEnd; ++i) {
+            HttpResponse response;
+            if (!connection->readResponse(response, span)) {
+                connection->close();
+                break;
+            }
+            ++answered;
+
+            const QString &url = urls[indices[i]];
+            if (response.status == 200 || response.status == 206) {
+                const bool complete = response.body.size() < span
+                                      || (response.status == 200 && !response.truncated);
+                writeCache(cachePath(url, complete ? "body" : "head"), response.body);
+                if (complete)
+                    rememberSize(url, response.body.size());
+                else if (response.totalSize >= 0)
+                    rememberSize(url, response.totalSize);
+                heads[indices[i]] = response.body.left(maxSize);
+            } else if (response.status != 416) {
+                // 416: empty file, nothing to read
+                qDebug() << "HTTP" << response.status << "for" << url;
+            }
+
+            if (!response.keepAlive) {
+                // Requests written after this one are lost; resend them
+                connection->close();
+                break;
+            }
+        }
+
+        next += answered;
+        failures = answered > 0 ? 0 : failures + 1;
+    }
+
+    if (next < indices.size()) {
+        qDebug() << "Fetched only" << next << "of" << indices.size() << "heads from"
+                 << QUrl(urls[indices.first()]).host();
+    }
+}
+
+QString HttpImageSource::cachePath(const QString &url, const char *suffix)
+{
+    const QString name = QString::fromLatin1(
+        QCryptographicHash::hash(url.toUtf8(), QCryptographicHash::Sha1).toHex());
+
+    return cacheDirectory() + '/' + name + '.' + QLatin1String(suffix);
+}
+
+QString HttpImageSource::cacheDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/http";
+}
+
+void HttpImageSource::rememberSize(const QString &url, qint64 size)
+{
+    QMutexLocker locker(&m_mutex);
+    m_sizes.insert(url, size);
+}
@@ -0,0 +1,108 @@
+// httpimagesource.h
+#ifndef HTTPIMAGESOURCE_H
+#define HTTPIMAGESOURCE_H
+
+#include "imagesource.h"
+#include <QHash>
+#include <QMutex>
+
+class QUrl;
+
+/**
+ * @brief The HttpImageSource class reads images from an HTTP server.
+ *
+ * Every worker thread keeps one persistent HTTP/1.1 connection per server,
+ * so loads do not pay a TCP handshake each. Head reads are range requests
+ * ("Range: bytes=0-N") for a fixed span that holds both the format magic
+ * and a maximal EXIF segment; readHeads() pipelines them, writing a window
+ * of requests before reading the responses in order, so a scan batch costs
+ * a few round trips instead of one per file. Servers that ignore ranges or
+ * close the connection after each response (HTTP/1.0) still work, only
+ * slower.
+ *
+ * Heads and full bodies are kept in a disk cache under the cache location,
+ * so thumbnails and revisited images are served without the network. It
+ * is a session cache: entries are never revalidated, so the cache is
+ * emptied when the backend is first used in a process, and a URL whose
+ * content changes on the server is only seen fresh in the next session.
+ * Only plain http:// is supported.
+ */
+class HttpImageSource : public ImageSource
+{
+public:
+    /**
+     * @brief Gets the shared instance.
+     * @return The HTTP backend.
+     */
+    static HttpImageSource *instance();
+
+    /**
+     * @brief Checks whether a path is an HTTP URL.
+     * @param path The path.
+     * @return True for http:// URLs.
+     */
+    static bool isHttpPath(const QString &path);
+
+    bool isRemote() const override { return true; }
+    std::unique_ptr<QIODevice> open(const QString &path) override;
+    QByteArray readHead(const QString &path, qint64 maxSize) override;
+    QVector<QByteArray> readHeads(const QStringList &paths, qint64 maxSize) override;
+    qint64 fileSize(const QString &path) override;
+
+    static const int HeadBytes = 72 * 1024;  ///< Span fetched by any head read; covers a full EXIF segment
+    static const int PipelineDepth = 16;     ///< Requests written before reading responses
+    static const int TimeoutMs = 15000;      ///< Network timeout per wait
+    static const int MaxAttempts = 3;        ///< Consecutive failed round trips before giving up
+    static const qint64 MaxBodyBytes = 512ll * 1024 * 1024; ///< Largest image downloaded
+
+private:
+    /**
+     * @brief Constructs the backend and empties the cache of earlier sessions.
+     */
+    HttpImageSource();
+
+    /**
+     * @brief Gets the directory of the disk cache.
+     * @return The directory path.
+     */
+    static QString cacheDirectory();
+
+    /**
+     * @brief Reads a head from the disk cache.
+     * @param url The image URL.
+     * @param maxSize Number of bytes wanted.
+     * @param head Receives the head.
+     * @return True if the cache could answer.
+     */
+    bool cachedHead(const QString &url, qint64 maxSize, QByteArray *head);
+
+    /**
+     * @brief Fetches the heads of images on one server with pipelined range requests.
+     * @param urls The image URLs.
+     * @param indices Indices into urls (and heads) of the images to fetch.
+     * @param maxSize Number of bytes wanted from each.
+     * @param heads Receives the fetched heads.
+     */
+    void fetchHeads(const QStringList &urls, const QVector<int> &indices, qint64 maxSize,
+                    QVector<QByteArray> &heads);
+
+    /**
+     * @brief Gets the cache file of an image.
+     * @param url The image URL.
+     * @param suffix "head" or "body".
+     * @return The cache file path.
+     */
+    static QString cachePath(const QString &url, const char *suffix);
+
+    /**
+     * @brief Remembers the full size of an image reported by a response.
+     * @param url The image URL.
+     * @param size The size in bytes.
+     */
+    void rememberSize(const QString &url, qint64 size);
+
+    QMutex m_mutex;                   ///< Guards m_sizes
+    QHash<QString, qint64> m_sizes;   ///< Full sizes seen in responses
+};
+
+#endif // HTTPIMAGESOURCE_H
@@ -0,0 +1,143 @@
+// imagedetailscache.cpp
+#include "imagedetailscache.h"
+#include "imagesource.h"
+#include "httpimagesource.h"
+#include "exifreader.h"
+
+#include <QBuffer>
+#include <QImageReader>
+
+ImageDetailsCache::ImageDetailsCache(QObject *parent)
+    : QObject(parent)
+{
+    m_pool.setMaxThreadCount(MaxReads);
+}
+
+ImageDetailsCache::~ImageDetailsCache()
+{
+    m_pool.waitForDone();
+}
+
+void ImageDetailsCache::prefill(const QVector<int> &ids, const QVector<ImageDetails> &details)
+{
+    m_details.reserve(m_details.size() + ids.size());
+    for (int i = 0; i < ids.size() && i < details.size(); ++i) {
+        ImageDetails &entry = m_details[ids[i]];
+        if (entry.complete)
+            continue;
+        entry = details[i];
+        entry.complete = false;
+    }
+}
+
+void ImageDetailsCache::clear()
+{
+    // Reads in flight still land; their images may well be opened again
+    m_details.clear();
+    m_details.squeeze();
+    m_waitingId = -1;
+    m_waitingPath.clear();
+}
+
+void ImageDetailsCache::request(int id, const QString &path)
+{
+    // A read in flight answers the request, unless the file changed under it
+    if (m_details.value(id).complete || (m_inFlight.contains(id) && !m_staleInFlight.contains(id)))
+        return;
+
+    // Only the latest request is worth waiting for
+    m_waitingId = id;
+    m_waitingPath = path;
+    startWaiting();
+}
+
+void ImageDetailsCache::invalidate(const QVector<int> &ids)
+{
+    for (int id : ids) {
+        m_details.remove(id);
+        if (m_inFlight.contains(id)) {
+            m_staleInFlight.insert(id);
+        }
+    }
+}
+
+void ImageDetailsCache::startWaiting()
+{
+    if (m_waitingId < 0 || m_inFlight.size() >= MaxReads)
+        return;
+
+    const int id = m_waitingId;
+    const QString path = m_waitingPath;
+    const ImageDetails known = m_details.value(id);
+    m_waitingId = -1;
+    m_waitingPath.clear();
+    m_inFlight.insert(id);
+
+    m_pool.start([this, id, path, known]() {
+        const ImageDetails details = readDetails(path, known);
+        QMetaObject::invokeMethod(this, [this, id, details]() {
+            onDetailsRead(id, details);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ImageDetailsCache::onDetailsRead(int id, const ImageDetails &details)
+{
+    m_inFlight.remove(id);
+
+    // The file changed while it was read; a newer request reads it again
+    if (m_staleInFlight.remove(id)) {
+        startWaiting();
+        return;
+    }
+
+    m_details.insert(id, details);
+    emit detailsLoaded(id);
+
+    startWaiting();
+}
+
+ImageDetails ImageDetailsCache::readDetails(const QString &path, ImageDetails known)
+{
+    // One head read answers everything; a remote head comes from the
+    // source's head cache when the scan already fetched it
+    ImageSource *source = ImageSource::forPath(path);
+    QByteArray head = source->readHead(path, HttpImageSource::HeadBytes);
+
+    if (known.fileSize < 0) {
+        known.fileSize = source->fileSize(path);
+    }
+
+    const ImageFormat format = FormatSniffer::sniffHeader(reinterpret_cast<const uchar *>(head.constData()),
+                                                          head.size());
+    if (format != ImageFormat::Unknown) {
+        known.format = format;
+    }
+
+    QBuffer buffer(&head);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer, FormatSniffer::formatName(known.format));
+    QSize pixelSize = reader.size();
+
+    // The size may sit beyond the head: a TIFF whose IFD follows the pixel
+    // data, a JPEG whose frame header follows large APP segments. Local
+    // files are cheap to open again; remote ones would be downloaded.
+    if (!pixelSize.isValid() && !known.pixelSize.isValid() && !source->isRemote()) {
+        if (std::unique_ptr<QIODevice> device = source->open(path)) {
+            QImageReader fullReader(device.get(), FormatSniffer::formatName(known.format));
+            pixelSize = fullReader.size();
+        }
+    }
+    if (pixelSize.isValid()) {
+        known.pixelSize = pixelSize;
+    }
+
+    if (known.format == ImageFormat::Jpeg) {
+        const ExifInfo exif = ExifReader::parse(head);
+        known.dateTaken = exif.dateTaken;
+        known.camera = exif.camera;
+    }
+
+    known.complete = true;
+    return known;
+}
@@ -0,0 +1,129 @@
+// imagedetailscache.h
+#ifndef IMAGEDETAILSCACHE_H
+#define IMAGEDETAILSCACHE_H
+
+#include <QObject>
+#include <QString>
+#include <QSize>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QThreadPool>
+#include "formatsniffer.h"
+
+/**
+ * @brief Structure holding what the info panel shows about an image.
+ */
+struct ImageDetails {
+    QSize pixelSize;            ///< Stored pixel size, invalid if unknown
+    qint64 fileSize = -1;       ///< File size in bytes, -1 if unknown
+    ImageFormat format = ImageFormat::Unknown; ///< Format detected from the file content
+    QString dateTaken;          ///< EXIF capture time, empty if none or not read yet
+    QString camera;             ///< EXIF camera make and model, empty if none or not read yet
+    bool complete = false;      ///< Whether the file itself has been read
+};
+
+/**
+ * @brief The ImageDetailsCache class fetches and keeps image details off the GUI thread.
+ *
+ * Details already known from elsewhere (the collection manifest) are
+ * prefilled and answered at once. Anything else is read from the head of
+ * the file on a small worker pool: one read covers the header, the EXIF
+ * block and the format. Only the most recent request waits for a free
+ * worker, so holding an arrow key on slow storage queues nothing behind
+ * the image that ends up shown.
+ */
+class ImageDetailsCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs an empty cache.
+     * @param parent The parent object.
+     */
+    explicit ImageDetailsCache(QObject *parent = nullptr);
+
+    /**
+     * @brief Waits for the reads in flight.
+     */
+    ~ImageDetailsCache();
+
+    /**
+     * @brief Records details known without reading the files.
+     *
+     * Entries already read from their file are kept.
+     *
+     * @param ids Image IDs.
+     * @param details Details, index-aligned with ids; complete is ignored.
+     */
+    void prefill(const QVector<int> &ids, const QVector<ImageDetails> &details);
+
+    /**
+     * @brief Gets whatever is known about an image; never touches the file.
+     * @param id The image ID.
+     * @return The details, empty if nothing is known yet.
+     */
+    ImageDetails details(int id) const { return m_details.value(id); }
+
+    /**
+     * @brief Reads an image's file in the background unless that was done already.
+     *
+     * detailsLoaded() is emitted once the details are complete. A request
+     * that cannot start at once replaces any other waiting one.
+     *
+     * @param id The image ID.
+     * @param path The file path, virtual archive path or URL of the image.
+     */
+    void request(int id, const QString &path);
+
+    /**
+     * @brief Forgets everything, for a new collection.
+     */
+    void clear();
+
+    /**
+     * @brief Forgets details of files that changed on disk.
+     * @param ids Image IDs.
+     */
+    void invalidate(const QVector<int> &ids);
+
+signals:
+    /**
+     * @brief Signal emitted when the details of an image have been read.
+     * @param id The image ID.
+     */
+    void detailsLoaded(int id);
+
+private:
+    /**
+     * @brief Starts the waiting request if a worker is free.
+     */
+    void startWaiting();
+
+    /**
+     * @brief Stores the result of a read.
+     * @param id The image ID.
+     * @param details The details read.
+     */
+    void onDetailsRead(int id, const ImageDetails &details);
+
+    /**
+     * @brief Reads the details of an image from the head of its file; runs on a worker.
+     * @param path The image path.
+     * @param known Details already known, kept where the file says nothing.
+     * @return The details, marked complete.
+     */
+    static ImageDetails readDetails(const QString &path, ImageDetails known);
+
+    QHash<int, ImageDetails> m_details; ///< Details by image ID
+    QSet<int> m_inFlight;               ///< IDs being read
+    QSet<int> m_staleInFlight;          ///< IDs being read whose file changed meanwhile
+    int m_waitingId = -1;               ///< ID of the request waiting for a worker, -1 if none
+    QString m_waitingPath;              ///< Path of the waiting request
+    QThreadPool m_pool;                 ///< Workers reading file heads
+
+    static const int MaxReads = 2;      ///< Reads in flight at once
+};
+
+#endif // IMAGEDETAILSCACHE_H
@@ -1,34 +1,229 @@
 // imageloader.cpp
 #include "imageloader.h"
 #include "imageloadtask.h"
+#include "thumbnailloadtask.h"
+#include "imagesource.h"
 #include <QThread>
 #include <QMutexLocker>
+#include <QDebug>
+#include <memory>
 
 ImageLoader::ImageLoader(QObject *parent)
     : QObject(parent)
 {
     // Set thread pool limits - adjust based on system capabilities
     m_threadPool.setMaxThreadCount(QThread::idealThreadCount());
+
+    // Thumbnails are small and requested interactively; one worker is enough
+    m_thumbnailPool.setMaxThreadCount(1);
+
+    // Previews are small reads, so a few can be in flight next to full decodes
+    m_previewPool.setMaxThreadCount(4);
+
+    // Slow storage: keep many reads in flight, independent of decode threads
+    m_readAheadDepth = qBound(0, qEnvironmentVariableIntValue("DIV_READAHEAD_DEPTH"), 256);
+    if (m_readAheadDepth > 0) {
+        m_readPool.setMaxThreadCount(m_readAheadDepth);
+        qDebug() << "Read-ahead enabled with" << m_readAheadDepth << "reads in flight";
+    }
+
+    // Kernel readahead hints: one worker is plenty, the calls do not wait for the I/O
+    m_advisePool.setMaxThreadCount(1);
+    const QByteArray budget = qgetenv("DIV_READAHEAD_HINT_MB");
+    m_adviseBudget = (budget.isEmpty() ? 64 : qMax(0, budget.toInt())) * qint64(1024 * 1024);
 }
 
 ImageLoader::~ImageLoader()
 {
+    m_advisePool.clear();
+    m_advisePool.waitForDone();
+
+    // Readers queue decodes, so they stop first
+    m_readPool.clear();
+    m_readPool.waitForDone();
+    m_previewPool.clear();
+    m_previewPool.waitForDone();
+    m_thumbnailPool.clear();
+    m_thumbnailPool.waitForDone();
     m_threadPool.clear();
     m_threadPool.waitForDone();
 }
 
-void ImageLoader::loadImage(int index, const QString &path)
+void ImageLoader::loadImage(int index, int id, const QString &path, int priority)
 {
     QMutexLocker locker(&m_mutex);
 
-    // Create a task
-    ImageLoadTask *task = new ImageLoadTask(index, path);
+    const ImageFormat format = imageFormatLocked(id);
+    ++m_undecoded[id];
+
+    // Preview stage: the embedded EXIF thumbnail arrives long before the
+    // full decode and is shown in the meantime; only JPEGs carry one
+    const bool mayHaveEmbedded = (format == ImageFormat::Jpeg || format == ImageFormat::Unknown);
+    if (mayHaveEmbedded && !m_thumbnailCache.contains(path)) {
+        ThumbnailLoadTask *previewTask = new ThumbnailLoadTask(path, &m_thumbnailCache, true, format);
+        connect(previewTask, &ThumbnailLoadTask::thumbnailReady,
+                this, &ImageLoader::thumbnailLoaded,
+                Qt::QueuedConnection);
+        m_previewPool.start(previewTask);
+    }
+
+    if (m_readAheadDepth > 0) {
+        // The read completes on its own pool; the decode is queued only then
+        const quint64 generation = m_loadGeneration;
+        m_readPool.start([this, index, id, path, format, generation, priority]() {
+            QByteArray data;
+            if (std::unique_ptr<QIODevice> device = ImageSource::openPath(path)) {
+                data = device->readAll();
+            }
+
+            QMutexLocker locker(&m_mutex);
+            if (generation != m_loadGeneration)
+                return;
+            startDecode(index, id, path, format, data, priority);
+        }, priority);
+        return;
+    }
+
+    startDecode(index, id, path, format, QByteArray(), priority);
+}
+
+void ImageLoader::startDecode(int index, int id, const QString &path, ImageFormat format, const QByteArray &data,
+                              int priority)
+{
+    // Create a task; the pool entry owns it, so a cleared entry frees it too
+    std::shared_ptr<ImageLoadTask> task(new ImageLoadTask(index, path, &m_thumbnailCache, format));
+    task->setAutoDelete(false);
+    if (!data.isNull()) {
+        task->setPrefetchedData(data);
+    }
 
     // Connect the task's signal directly to our signal
-    connect(task, &ImageLoadTask::loadCompleted,
+    connect(task.get(), &ImageLoadTask::loadCompleted,
             this, &ImageLoader::imageLoaded,
             Qt::QueuedConnection);
 
-    // Start the task
-    m_threadPool.start(task);
+    // Start the task; queued tasks run highest priority first. Once it is
+    // past the generation check it reports, whatever is cancelled later.
+    const quint64 generation = m_loadGeneration;
+    m_threadPool.start([this, task, id, generation]() {
+        {
+            QMutexLocker locker(&m_mutex);
+            if (generation != m_loadGeneration)
+                return;
+            auto it = m_undecoded.find(id);
+            if (it != m_undecoded.end() && --it.value() <= 0) {
+                m_undecoded.erase(it);
+            }
+        }
+        task->run();
+    }, priority);
+}
+
+void ImageLoader::adviseUpcoming(const QStringList &paths)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_adviseBudget <= 0)
+        return;
+
+    // The page cache holds hinted files for a while; avoid hinting them every frame
+    if (m_advised.size() > MaxAdvisedPaths) {
+        m_advised.clear();
+    }
+    QStringList pending;
+    for (const QString &path : paths) {
+        if (!m_advised.contains(path)) {
+            pending.append(path);
+        }
+    }
+    if (pending.isEmpty())
+        return;
+
+    // Only the latest window matters; hints for an old one are dropped
+    m_advisePool.clear();
+
+    const qint64 budget = m_adviseBudget;
+    m_advisePool.start([this, pending, budget]() {
+        qint64 remaining = budget;
+        QStringList hinted;
+        for (const QString &path : pending) {
+            if (remaining <= 0)
+                break;
+            remaining -= ImageSource::forPath(path)->adviseWillNeed(path, remaining);
+            hinted.append(path);
+        }
+
+        QMutexLocker locker(&m_mutex);
+        for (const QString &path : hinted) {
+            m_advised.insert(path);
+        }
+    });
+}
+
+QVector<int> ImageLoader::cancelPendingLoads()
+{
+    QMutexLocker locker(&m_mutex);
+
+    // Removes queued (not yet running) tasks from the pools; reads already
+    // running finish but no longer queue their decode, and decodes taken
+    // off the queue but not yet started see the new generation and return
+    ++m_loadGeneration;
+    m_readPool.clear();
+    m_previewPool.clear();
+    m_threadPool.clear();
+
+    const QVector<int> cancelled = m_undecoded.keys();
+    m_undecoded.clear();
+    return cancelled;
+}
+
+void ImageLoader::loadThumbnail(int id, const QString &path)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // Only the latest request matters for interactive previews
+    m_thumbnailPool.clear();
+
+    ThumbnailLoadTask *task = new ThumbnailLoadTask(path, &m_thumbnailCache, false,
+                                                    imageFormatLocked(id));
+    connect(task, &ThumbnailLoadTask::thumbnailReady,
+            this, &ImageLoader::thumbnailLoaded,
+            Qt::QueuedConnection);
+
+    m_thumbnailPool.start(task);
+}
+
+void ImageLoader::setImageFormats(const QVector<int> &ids, const QByteArray &formats)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // IDs are dense, so one byte per ID beats a hash keyed by path
+    const int count = qMin(ids.size(), formats.size());
+    for (int i = 0; i < count; ++i) {
+        const int id = ids[i];
+        if (id < 0)
+            continue;
+        if (id >= m_formats.size()) {
+            m_formats.append(QByteArray(id + 1 - m_formats.size(), char(ImageFormat::Unknown)));
+        }
+        m_formats[id] = formats[i];
+    }
+}
+
+void ImageLoader::clearImageFormats()
+{
+    QMutexLocker locker(&m_mutex);
+    m_formats.clear();
+    m_advised.clear();
+}
+
+ImageFormat ImageLoader::imageFormat(int id) const
+{
+    QMutexLocker locker(&m_mutex);
+    return imageFormatLocked(id);
+}
+
+ImageFormat ImageLoader::imageFormatLocked(int id) const
+{
+    return (id >= 0 && id < m_formats.size()) ? ImageFormat(m_formats[id]) : ImageFormat::Unknown;
 }
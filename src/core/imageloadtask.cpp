@@ -1,33 +1,52 @@
 // imageloadtask.cpp
 #include "imageloadtask.h"
+#include "thumbnailcache.h"
+#include "imagesource.h"
 #include <QImage>
+#include <QImageReader>
+#include <QBuffer>
 #include <QDebug>
-#include <QFileInfo>
 
-ImageLoadTask::ImageLoadTask(int index, const QString &path)
+ImageLoadTask::ImageLoadTask(int index, const QString &path, ThumbnailCache *thumbnailCache,
+                             ImageFormat format)
     : QObject(nullptr), QRunnable()
     , m_index(index)
     , m_path(path)
+    , m_thumbnailCache(thumbnailCache)
+    , m_format(format)
 {
     setAutoDelete(true);
 }
 
 void ImageLoadTask::run()
 {
-    // Check if path is valid before loading
-    QFileInfo fileInfo(m_path);
-    if (!fileInfo.exists() || !fileInfo.isReadable()) {
+    // Check if path is valid before loading; any source the path names
+    std::unique_ptr<QIODevice> device;
+    if (m_prefetched) {
+        auto buffer = std::make_unique<QBuffer>(&m_data);
+        buffer->open(QIODevice::ReadOnly);
+        device = std::move(buffer);
+    } else {
+        device = ImageSource::openPath(m_path);
+    }
+    if (!device) {
         qDebug() << "Error: Cannot read image file:" << m_path;
-        emit loadCompleted(m_index, QPixmap());
+        emit loadCompleted(m_index, m_path, QPixmap());
         return;
     }
 
-    // Load the image in the background thread
-    QImage image(m_path);
+    // Load the image in the background thread, upright like its preview
+    QImageReader reader(device.get(), FormatSniffer::formatName(m_format));
+    if (m_format != ImageFormat::Unknown) {
+        // The scan already identified the file; go straight to its plugin
+        reader.setAutoDetectImageFormat(false);
+    }
+    reader.setAutoTransform(true);
+    QImage image = reader.read();
 
     if (image.isNull()) {
         qDebug() << "Error: Failed to load image:" << m_path;
-        emit loadCompleted(m_index, QPixmap());
+        emit loadCompleted(m_index, m_path, QPixmap());
         return;
     }
 
@@ -42,8 +61,13 @@ void ImageLoadTask::run()
             );
     }
 
+    // Keep a thumbnail so the image can be previewed later without a decode
+    if (m_thumbnailCache) {
+        m_thumbnailCache->insert(m_path, ThumbnailCache::makeThumbnail(image));
+    }
+
     m_pixmap = QPixmap::fromImage(image);
 
     // Signal completion
-    emit loadCompleted(m_index, m_pixmap);
+    emit loadCompleted(m_index, m_path, m_pixmap);
 }
@@ -6,6 +6,9 @@
 #include <QRunnable>
 #include <QString>
 #include <QPixmap>
+#include "formatsniffer.h"
+
+class ThumbnailCache;
 
 /**
  * @brief The ImageLoadTask class handles asynchronous loading of a single image.
@@ -22,14 +25,26 @@ public:
      * @brief Constructs an image loading task.
      * @param index The index of the image in the collection.
      * @param path The file path to the image.
+     * @param thumbnailCache Cache receiving a thumbnail of the decoded image (optional).
+     * @param format The format detected during scanning; Unknown lets Qt probe.
      */
-    ImageLoadTask(int index, const QString &path);
+    ImageLoadTask(int index, const QString &path, ThumbnailCache *thumbnailCache = nullptr,
+                  ImageFormat format = ImageFormat::Unknown);
 
     /**
      * @brief Default destructor.
      */
     ~ImageLoadTask() override = default;
 
+    /**
+     * @brief Supplies the file contents, read ahead of the decode.
+     *
+     * The task then decodes from memory and does no I/O of its own.
+     *
+     * @param data The complete file contents.
+     */
+    void setPrefetchedData(const QByteArray &data) { m_data = data; m_prefetched = true; }
+
     /**
      * @brief Executes the image loading operation.
      *
@@ -53,14 +68,19 @@ signals:
     /**
      * @brief Signal emitted when image loading completes.
      * @param index The index of the loaded image.
+     * @param path The file path of the loaded image.
      * @param pixmap The loaded image pixmap.
      */
-    void loadCompleted(int index, const QPixmap &pixmap);
+    void loadCompleted(int index, const QString &path, const QPixmap &pixmap);
 
 private:
     int m_index;         ///< Index of the image in the collection
     QString m_path;      ///< File path to the image
     QPixmap m_pixmap;    ///< Loaded image pixmap
+    ThumbnailCache *m_thumbnailCache; ///< Cache for the by-product thumbnail
+    ImageFormat m_format; ///< Known format, skips plugin probing
+    QByteArray m_data;   ///< File contents read ahead, if m_prefetched
+    bool m_prefetched = false; ///< Decode from m_data instead of opening the path
 };
 
 #endif // IMAGELOADTASK_H
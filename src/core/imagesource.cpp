@@ -0,0 +1,78 @@
+// imagesource.cpp
+#include "imagesource.h"
+#include "localimagesource.h"
+#include "archiveimagesource.h"
+#include "httpimagesource.h"
+#include "throttledimagesource.h"
+#include "ziparchive.h"
+#include <QHash>
+
+ImageSource *ImageSource::forPath(const QString &path)
+{
+    ImageSource *backend = LocalImageSource::instance();
+    if (HttpImageSource::isHttpPath(path))
+        backend = HttpImageSource::instance();
+    else if (ZipArchive::splitPath(path))
+        backend = ArchiveImageSource::instance();
+
+    // Development aid: simulate slow storage under every backend
+    if (ThrottledImageSource::isEnabled())
+        return ThrottledImageSource::wrap(backend);
+    return backend;
+}
+
+std::unique_ptr<QIODevice> ImageSource::openPath(const QString &path)
+{
+    return forPath(path)->open(path);
+}
+
+QVector<QByteArray> ImageSource::readPathHeads(const QStringList &paths, qint64 maxSize)
+{
+    QVector<QByteArray> heads(paths.size());
+
+    // Collections almost always come from one backend; skip the grouping then
+    ImageSource *first = paths.isEmpty() ? nullptr : forPath(paths.first());
+    bool mixed = false;
+    for (const QString &path : paths) {
+        if (forPath(path) != first) {
+            mixed = true;
+            break;
+        }
+    }
+    if (!mixed) {
+        return first ? first->readHeads(paths, maxSize) : heads;
+    }
+
+    QHash<ImageSource *, QVector<int>> groups;
+    for (int i = 0; i < paths.size(); ++i)
+        groups[forPath(paths[i])].append(i);
+
+    for (auto it = groups.cbegin(); it != groups.cend(); ++it) {
+        QStringList groupPaths;
+        groupPaths.reserve(it.value().size());
+        for (int index : it.value())
+            groupPaths.append(paths[index]);
+
+        const QVector<QByteArray> groupHeads = it.key()->readHeads(groupPaths, maxSize);
+        for (int i = 0; i < it.value().size(); ++i)
+            heads[it.value()[i]] = groupHeads[i];
+    }
+    return heads;
+}
+
+QByteArray ImageSource::readHead(const QString &path, qint64 maxSize)
+{
+    std::unique_ptr<QIODevice> device = open(path);
+    if (!device)
+        return QByteArray();
+    return device->read(maxSize);
+}
+
+QVector<QByteArray> ImageSource::readHeads(const QStringList &paths, qint64 maxSize)
+{
+    QVector<QByteArray> heads;
+    heads.reserve(paths.size());
+    for (const QString &path : paths)
+        heads.append(readHead(path, maxSize));
+    return heads;
+}
@@ -0,0 +1,119 @@
+// imagesource.h
+#ifndef IMAGESOURCE_H
+#define IMAGESOURCE_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+
+/**
+ * @brief The ImageSource class is the interface through which image bytes are read.
+ *
+ * A collection path is either a local file, an entry inside a zip or CBZ
+ * archive ("set.cbz!/page01.jpg"), or an http:// URL. forPath() picks the
+ * backend for a path; loaders only ever go through this interface, so they
+ * do not care where an image lives.
+ *
+ * Two kinds of reads are offered: open() for a full decode, and readHead()
+ * / readHeads() for the first bytes of a file, which is all that format
+ * detection and embedded EXIF thumbnails need. Remote backends answer head
+ * reads with small range requests and batch them. All backends are
+ * stateless singletons and thread-safe. With ThrottledImageSource enabled,
+ * every backend is wrapped to behave like slow storage.
+ */
+class ImageSource
+{
+public:
+    /**
+     * @brief Virtual destructor.
+     */
+    virtual ~ImageSource() = default;
+
+    /**
+     * @brief Gets the backend responsible for a path.
+     * @param path A file path, virtual archive path or URL.
+     * @return The backend; never null.
+     */
+    static ImageSource *forPath(const QString &path);
+
+    /**
+     * @brief Opens a path with its backend.
+     * @param path A file path, virtual archive path or URL.
+     * @return An open device, or null if the image cannot be read.
+     */
+    static std::unique_ptr<QIODevice> openPath(const QString &path);
+
+    /**
+     * @brief Reads the heads of paths that may belong to different backends.
+     *
+     * Paths are grouped by backend so each one can batch its reads.
+     *
+     * @param paths The paths to read.
+     * @param maxSize Bytes wanted from the start of each file.
+     * @return One head per path, in the same order; empty if unreadable.
+     */
+    static QVector<QByteArray> readPathHeads(const QStringList &paths, qint64 maxSize);
+
+    /**
+     * @brief Checks whether reads go over the network.
+     *
+     * Remote images are read in as few round trips as possible: callers
+     * prefer head reads over open() when the head is enough.
+     *
+     * @return True for remote backends.
+     */
+    virtual bool isRemote() const { return false; }
+
+    /**
+     * @brief Opens an image for reading.
+     * @param path The image path.
+     * @return An open device positioned at the start, or null on failure.
+     */
+    virtual std::unique_ptr<QIODevice> open(const QString &path) = 0;
+
+    /**
+     * @brief Reads the first bytes of an image.
+     * @param path The image path.
+     * @param maxSize Number of bytes wanted.
+     * @return Up to maxSize bytes; fewer for short files, empty on failure.
+     */
+    virtual QByteArray readHead(const QString &path, qint64 maxSize);
+
+    /**
+     * @brief Reads the first bytes of several images of this backend.
+     * @param paths The image paths.
+     * @param maxSize Number of bytes wanted from each.
+     * @return One head per path, in the same order.
+     */
+    virtual QVector<QByteArray> readHeads(const QStringList &paths, qint64 maxSize);
+
+    /**
+     * @brief Gets the size of an image file without reading it.
+     * @param path The image path.
+     * @return The size in bytes, or -1 if it is not known without a read.
+     */
+    virtual qint64 fileSize(const QString &path) = 0;
+
+    /**
+     * @brief Tells the storage that an image will be read soon.
+     *
+     * Only a hint: the call starts background I/O where the platform allows
+     * it and returns without waiting for the data. Backends without such a
+     * mechanism do nothing.
+     *
+     * @param path The image path.
+     * @param maxBytes Upper bound of bytes to hint, from the start of the file.
+     * @return Number of bytes hinted.
+     */
+    virtual qint64 adviseWillNeed(const QString &path, qint64 maxBytes)
+    {
+        Q_UNUSED(path);
+        Q_UNUSED(maxBytes);
+        return 0;
+    }
+};
+
+#endif // IMAGESOURCE_H
@@ -0,0 +1,86 @@
+// localimagesource.cpp
+#include "localimagesource.h"
+#include <QFile>
+#include <QFileInfo>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+LocalImageSource *LocalImageSource::instance()
+{
+    static LocalImageSource source;
+    return &source;
+}
+
+std::unique_ptr<QIODevice> LocalImageSource::open(const QString &path)
+{
+    auto file = std::make_unique<QFile>(path);
+    if (!file->open(QIODevice::ReadOnly))
+        return nullptr;
+    return file;
+}
+
+QByteArray LocalImageSource::readHead(const QString &path, qint64 maxSize)
+{
+    QByteArray head(maxSize, Qt::Uninitialized);
+    qint64 size = 0;
+
+#ifdef Q_OS_UNIX
+    // Plain syscalls: this runs for every file of a scan
+    int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return QByteArray();
+    ssize_t bytesRead = ::read(fd, head.data(), size_t(maxSize));
+    ::close(fd);
+    size = bytesRead > 0 ? bytesRead : 0;
+#else
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    size = qMax<qint64>(0, file.read(head.data(), maxSize));
+#endif
+
+    head.truncate(size);
+    return head;
+}
+
+qint64 LocalImageSource::fileSize(const QString &path)
+{
+    const QFileInfo info(path);
+    return info.exists() ? info.size() : -1;
+}
+
+qint64 LocalImageSource::adviseWillNeed(const QString &path, qint64 maxBytes)
+{
+#ifdef Q_OS_UNIX
+    int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return 0;
+
+    qint64 length = 0;
+    struct stat st;
+    if (fstat(fd, &st) == 0) {
+        length = qMin<qint64>(st.st_size, maxBytes);
+#if defined(Q_OS_MACOS)
+        radvisory advice;
+        advice.ra_offset = 0;
+        advice.ra_count = int(qMin<qint64>(length, INT_MAX));
+        if (fcntl(fd, F_RDADVISE, &advice) != 0)
+            length = 0;
+#else
+        // Queues the reads and returns; the page cache keeps the data for the decode
+        if (posix_fadvise(fd, 0, length, POSIX_FADV_WILLNEED) != 0)
+            length = 0;
+#endif
+    }
+    ::close(fd);
+    return length;
+#else
+    Q_UNUSED(path);
+    Q_UNUSED(maxBytes);
+    return 0;
+#endif
+}
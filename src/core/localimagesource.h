@@ -0,0 +1,28 @@
+// localimagesource.h
+#ifndef LOCALIMAGESOURCE_H
+#define LOCALIMAGESOURCE_H
+
+#include "imagesource.h"
+
+/**
+ * @brief The LocalImageSource class reads images from the local file system.
+ *
+ * Head reads use plain open/read syscalls on POSIX systems, since format
+ * detection runs them for every file of a scan.
+ */
+class LocalImageSource : public ImageSource
+{
+public:
+    /**
+     * @brief Gets the shared instance.
+     * @return The local backend.
+     */
+    static LocalImageSource *instance();
+
+    std::unique_ptr<QIODevice> open(const QString &path) override;
+    QByteArray readHead(const QString &path, qint64 maxSize) override;
+    qint64 fileSize(const QString &path) override;
+    qint64 adviseWillNeed(const QString &path, qint64 maxBytes) override;
+};
+
+#endif // LOCALIMAGESOURCE_H
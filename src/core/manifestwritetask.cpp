@@ -0,0 +1,123 @@
+// manifestwritetask.cpp
+#include "manifestwritetask.h"
+#include "collectionmanifest.h"
+#include "exifreader.h"
+#include <QFileInfo>
+#include <QImageReader>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QDebug>
+
+ManifestWriteTask::ManifestWriteTask(const QString &rootPath, bool recursive, const QStringList &paths,
+                                     std::shared_ptr<CollectionManifest> previous,
+                                     std::shared_ptr<std::atomic_bool> cancelled)
+    : QObject(nullptr), QRunnable()
+    , m_rootPath(rootPath)
+    , m_recursive(recursive)
+    , m_paths(paths)
+    , m_previous(std::move(previous))
+    , m_cancelled(std::move(cancelled))
+{
+    setAutoDelete(true);
+}
+
+ManifestWriteTask::~ManifestWriteTask() = default;
+
+void ManifestWriteTask::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    CollectionManifest::Builder builder(m_rootPath, m_paths.size());
+    QStringList modifiedPaths;
+    QHash<QString, int> previousIndex;
+    int probedCount = 0;
+
+    // Stays set while every file matches the previous manifest entry at the
+    // same index; the file on disk is then already correct
+    bool unchanged = m_previous && m_previous->count() == m_paths.size();
+
+    for (int i = 0; i < m_paths.size(); ++i) {
+        if (m_cancelled->load())
+            return;
+
+        const QString &path = m_paths[i];
+        const QFileInfo info(path);
+        if (!info.exists()) {
+            unchanged = false;
+            continue;
+        }
+
+        CollectionManifest::Entry entry;
+        entry.path = path;
+        entry.fileSize = info.size();
+        entry.modified = info.lastModified().toMSecsSinceEpoch();
+
+        // Collection order usually matches the previous manifest, so try the
+        // same index before falling back to a lookup table
+        int previous = -1;
+        if (m_previous) {
+            if (i < m_previous->count() && m_previous->path(i) == path) {
+                previous = i;
+            } else {
+                if (previousIndex.isEmpty()) {
+                    previousIndex.reserve(m_previous->count());
+                    for (int j = 0; j < m_previous->count(); ++j)
+                        previousIndex.insert(m_previous->path(j), j);
+                }
+                previous = previousIndex.value(path, -1);
+            }
+        }
+
+        bool known = false;
+        if (previous >= 0) {
+            const CollectionManifest::Entry old = m_previous->entry(previous);
+            if (old.fileSize == entry.fileSize && old.modified == entry.modified) {
+                entry.pixelSize = old.pixelSize;
+                entry.orientation = old.orientation;
+                entry.format = old.format;
+                known = true;
+            } else {
+                modifiedPaths.append(path);
+            }
+        }
+
+        if (!known || previous != i) {
+            unchanged = false;
+        }
+
+        if (!known) {
+            // Header-only reads: the reader reports the size without decoding
+            entry.format = FormatSniffer::sniff(path);
+            QImageReader reader(path, FormatSniffer::formatName(entry.format));
+            reader.setAutoTransform(false);
+            entry.pixelSize = reader.size();
+            if (entry.format == ImageFormat::Jpeg) {
+                entry.orientation = ExifReader::read(path).orientation;
+            }
+            ++probedCount;
+        }
+
+        builder.add(entry);
+    }
+
+    // Release the old mapping before the file is replaced
+    m_previous.reset();
+
+    if (unchanged) {
+        qDebug() << "Manifest for" << m_rootPath << "is up to date:" << m_paths.size()
+                 << "entries checked in" << timer.elapsed() << "ms";
+        emit manifestWritten(modifiedPaths, m_paths.size());
+        return;
+    }
+
+    const QString manifestPath = CollectionManifest::manifestPath(m_rootPath, m_recursive);
+    if (!builder.save(manifestPath))
+        return;
+
+    qDebug() << "Manifest for" << m_rootPath << "written:" << m_paths.size() << "entries,"
+             << probedCount << "probed," << modifiedPaths.size() << "modified in"
+             << timer.elapsed() << "ms";
+
+    emit manifestWritten(modifiedPaths, m_paths.size());
+}
@@ -0,0 +1,69 @@
+// manifestwritetask.h
+#ifndef MANIFESTWRITETASK_H
+#define MANIFESTWRITETASK_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <memory>
+
+class CollectionManifest;
+
+/**
+ * @brief The ManifestWriteTask class validates a collection and writes its manifest.
+ *
+ * Every image is checked against the filesystem (size and modification time).
+ * Entries of the previous manifest that still match are carried over as they
+ * are; new or changed files have their pixel size and orientation read from
+ * the file header, which never needs a decode. Changed files are reported so
+ * their cached data can be dropped. If every file still matches the
+ * previous manifest in the same order, the file is left as it is.
+ */
+class ManifestWriteTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs a manifest write task.
+     * @param rootPath The directory the collection was scanned from.
+     * @param recursive Whether the scan included subdirectories.
+     * @param paths The collection in display order.
+     * @param previous The manifest the collection was opened from, or null.
+     * @param cancelled Flag that stops the task when set.
+     */
+    ManifestWriteTask(const QString &rootPath, bool recursive, const QStringList &paths,
+                      std::shared_ptr<CollectionManifest> previous,
+                      std::shared_ptr<std::atomic_bool> cancelled);
+
+    /**
+     * @brief Default destructor.
+     */
+    ~ManifestWriteTask() override;
+
+    /**
+     * @brief Validates the collection and writes the manifest.
+     *
+     * This method runs in a worker thread and emits manifestWritten when done.
+     */
+    void run() override;
+
+signals:
+    /**
+     * @brief Signal emitted once the manifest has been written.
+     * @param modifiedPaths Paths whose file changed since the previous manifest.
+     * @param count Number of entries written.
+     */
+    void manifestWritten(const QStringList &modifiedPaths, int count);
+
+private:
+    QString m_rootPath;                            ///< Scanned directory
+    bool m_recursive;                              ///< Scan included subdirectories
+    QStringList m_paths;                           ///< Collection to describe
+    std::shared_ptr<CollectionManifest> m_previous; ///< Manifest to carry entries over from
+    std::shared_ptr<std::atomic_bool> m_cancelled; ///< Set when the collection is replaced
+};
+
+#endif // MANIFESTWRITETASK_H
@@ -0,0 +1,328 @@
+// metadatastore.cpp
+#include "metadatastore.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QElapsedTimer>
+#include <QDebug>
+
+MetadataStore::MetadataStore(QObject *parent)
+    : QObject(parent)
+    , m_connectionName(QString("metadata-%1").arg(quintptr(this)))
+{
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(FlushDelayMs);
+    connect(&m_flushTimer, &QTimer::timeout, this, &MetadataStore::flush);
+
+    // Queries of one view run one after the other; only the latest counts
+    m_queryPool.setMaxThreadCount(1);
+}
+
+MetadataStore::~MetadataStore()
+{
+    m_queryPool.clear();
+    m_queryPool.waitForDone();
+
+    flush();
+
+    if (m_db.isValid()) {
+        m_db.close();
+        m_db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(m_connectionName);
+    }
+}
+
+bool MetadataStore::open(const QString &filePath)
+{
+    m_filePath = filePath;
+    m_db = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+    m_db.setDatabaseName(filePath);
+    if (!m_db.open()) {
+        qDebug() << "Cannot open metadata database" << filePath << ":" << m_db.lastError().text();
+        return false;
+    }
+
+    // WAL keeps commits to an append plus an occasional checkpoint
+    exec("PRAGMA journal_mode = WAL");
+    exec("PRAGMA synchronous = NORMAL");
+
+    // Ratings and flags are indexed for filters; tags are keyed tag first,
+    // so a tag filter reads only the rows of that tag
+    return exec("CREATE TABLE IF NOT EXISTS images ("
+                "id INTEGER PRIMARY KEY, "
+                "path TEXT NOT NULL UNIQUE, "
+                "rating INTEGER NOT NULL DEFAULT 0, "
+                "flag INTEGER NOT NULL DEFAULT 0)")
+           && exec("CREATE INDEX IF NOT EXISTS images_rating ON images (rating)")
+           && exec("CREATE INDEX IF NOT EXISTS images_flag ON images (flag)")
+           && exec("CREATE TABLE IF NOT EXISTS tags ("
+                   "tag TEXT NOT NULL, "
+                   "image INTEGER NOT NULL REFERENCES images (id), "
+                   "PRIMARY KEY (tag, image)) WITHOUT ROWID")
+           && exec("CREATE INDEX IF NOT EXISTS tags_image ON tags (image)");
+}
+
+void MetadataStore::setRating(const QStringList &paths, int rating)
+{
+    QVector<Change> changes;
+    changes.reserve(paths.size());
+    for (const QString &path : paths) {
+        changes.append({Change::SetRating, path, qBound(0, rating, int(MaxRating)), QString()});
+    }
+    enqueue(changes);
+}
+
+void MetadataStore::setFlag(const QStringList &paths, int flag)
+{
+    QVector<Change> changes;
+    changes.reserve(paths.size());
+    for (const QString &path : paths) {
+        changes.append({Change::SetFlag, path, flag, QString()});
+    }
+    enqueue(changes);
+}
+
+void MetadataStore::addTag(const QStringList &paths, const QString &tag)
+{
+    QVector<Change> changes;
+    changes.reserve(paths.size());
+    for (const QString &path : paths) {
+        changes.append({Change::AddTag, path, 0, tag});
+    }
+    enqueue(changes);
+}
+
+void MetadataStore::removeTag(const QStringList &paths, const QString &tag)
+{
+    QVector<Change> changes;
+    changes.reserve(paths.size());
+    for (const QString &path : paths) {
+        changes.append({Change::RemoveTag, path, 0, tag});
+    }
+    enqueue(changes);
+}
+
+void MetadataStore::enqueue(const QVector<Change> &changes)
+{
+    if (!m_db.isOpen() || changes.isEmpty())
+        return;
+
+    m_pending.append(changes);
+    if (m_pending.size() >= MaxQueuedChanges) {
+        flush();
+    } else {
+        m_flushTimer.start();
+    }
+}
+
+void MetadataStore::flush()
+{
+    m_flushTimer.stop();
+    if (m_pending.isEmpty() || !m_db.isOpen())
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const QVector<Change> changes = m_pending;
+    m_pending.clear();
+
+    // One transaction for the whole queue: a single commit instead of one per change
+    m_db.transaction();
+
+    QSqlQuery insertImage(m_db);
+    insertImage.prepare("INSERT OR IGNORE INTO images (path) VALUES (?)");
+    QSqlQuery updateRating(m_db);
+    updateRating.prepare("UPDATE images SET rating = ? WHERE path = ?");
+    QSqlQuery updateFlag(m_db);
+    updateFlag.prepare("UPDATE images SET flag = ? WHERE path = ?");
+    QSqlQuery insertTag(m_db);
+    insertTag.prepare("INSERT OR IGNORE INTO tags (tag, image) SELECT ?, id FROM images WHERE path = ?");
+    QSqlQuery deleteTag(m_db);
+    deleteTag.prepare("DELETE FROM tags WHERE tag = ? AND image = (SELECT id FROM images WHERE path = ?)");
+
+    QSqlQuery *failed = nullptr;
+    for (const Change &change : changes) {
+        if (change.op != Change::RemoveTag) {
+            insertImage.addBindValue(change.path);
+            if (!insertImage.exec()) {
+                failed = &insertImage;
+                break;
+            }
+        }
+
+        QSqlQuery *query = nullptr;
+        switch (change.op) {
+        case Change::SetRating:
+            query = &updateRating;
+            query->addBindValue(change.value);
+            break;
+        case Change::SetFlag:
+            query = &updateFlag;
+            query->addBindValue(change.value);
+            break;
+        case Change::AddTag:
+            query = &insertTag;
+            query->addBindValue(change.tag);
+            break;
+        case Change::RemoveTag:
+            query = &deleteTag;
+            query->addBindValue(change.tag);
+            break;
+        }
+        query->addBindValue(change.path);
+        if (!query->exec()) {
+            failed = query;
+            break;
+        }
+    }
+
+    if (!failed && m_db.commit()) {
+        qDebug() << "Wrote" << changes.size() << "metadata changes in" << timer.elapsed() << "ms";
+    } else {
+        const QString error = failed ? failed->lastError().text() : m_db.lastError().text();
+        m_db.rollback();
+        qDebug() << "Discarded" << changes.size() << "metadata changes:" << error;
+    }
+}
+
+int MetadataStore::rating(const QString &path)
+{
+    flush();
+
+    QSqlQuery query(m_db);
+    query.prepare("SELECT rating FROM images WHERE path = ?");
+    query.addBindValue(path);
+    return (query.exec() && query.next()) ? query.value(0).toInt() : 0;
+}
+
+int MetadataStore::flag(const QString &path)
+{
+    flush();
+
+    QSqlQuery query(m_db);
+    query.prepare("SELECT flag FROM images WHERE path = ?");
+    query.addBindValue(path);
+    return (query.exec() && query.next()) ? query.value(0).toInt() : int(Unflagged);
+}
+
+QStringList MetadataStore::tags(const QString &path)
+{
+    flush();
+
+    QStringList result;
+    QSqlQuery query(m_db);
+    query.prepare("SELECT tag FROM tags WHERE image = (SELECT id FROM images WHERE path = ?) ORDER BY tag");
+    query.addBindValue(path);
+    if (query.exec()) {
+        while (query.next()) {
+            result.append(query.value(0).toString());
+        }
+    }
+    return result;
+}
+
+QString MetadataStore::filterClause(const Filter &filter)
+{
+    QStringList conditions;
+    if (filter.minRating > 0)
+        conditions.append("rating >= :minRating");
+    if (filter.flag >= 0)
+        conditions.append("flag = :flag");
+    if (!filter.tag.isEmpty())
+        conditions.append("id IN (SELECT image FROM tags WHERE tag = :tag)");
+    return conditions.isEmpty() ? QString("1") : conditions.join(" AND ");
+}
+
+void MetadataStore::bindFilter(QSqlQuery &query, const Filter &filter)
+{
+    if (filter.minRating > 0)
+        query.bindValue(":minRating", filter.minRating);
+    if (filter.flag >= 0)
+        query.bindValue(":flag", filter.flag);
+    if (!filter.tag.isEmpty())
+        query.bindValue(":tag", filter.tag);
+}
+
+int MetadataStore::startQuery(const Filter &filter)
+{
+    // Written here, so the worker's connection sees every change
+    flush();
+
+    const int ticket = ++m_lastTicket;
+    if (!m_db.isOpen()) {
+        QMetaObject::invokeMethod(this, [this, ticket]() {
+            emit queryFinished(ticket, QStringList());
+        }, Qt::QueuedConnection);
+        return ticket;
+    }
+
+    // A query still waiting for the worker is superseded
+    m_queryPool.clear();
+
+    const QString filePath = m_filePath;
+    const QString connectionName = QString("%1-query-%2").arg(m_connectionName).arg(ticket);
+    m_queryPool.start([this, filePath, connectionName, filter, ticket]() {
+        const QStringList paths = runQuery(filePath, connectionName, filter);
+        QMetaObject::invokeMethod(this, [this, ticket, paths]() {
+            emit queryFinished(ticket, paths);
+        }, Qt::QueuedConnection);
+    });
+    return ticket;
+}
+
+QStringList MetadataStore::runQuery(const QString &filePath, const QString &connectionName, const Filter &filter)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QStringList result;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(filePath);
+        db.setConnectOptions("QSQLITE_OPEN_READONLY");
+        if (db.open()) {
+            QSqlQuery query(db);
+            query.setForwardOnly(true);
+            query.prepare("SELECT path FROM images WHERE " + filterClause(filter));
+            bindFilter(query, filter);
+            if (query.exec()) {
+                while (query.next()) {
+                    result.append(query.value(0).toString());
+                }
+            } else {
+                qDebug() << "Metadata query failed:" << query.lastError().text();
+            }
+        } else {
+            qDebug() << "Cannot open metadata database for a query:" << db.lastError().text();
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    qDebug() << "Metadata query matched" << result.size() << "images in" << timer.elapsed() << "ms";
+    return result;
+}
+
+bool MetadataStore::matches(const QString &path, const Filter &filter)
+{
+    if (filter.isEmpty())
+        return true;
+
+    flush();
+
+    QSqlQuery query(m_db);
+    query.prepare("SELECT 1 FROM images WHERE path = :path AND " + filterClause(filter));
+    query.bindValue(":path", path);
+    bindFilter(query, filter);
+    return query.exec() && query.next();
+}
+
+bool MetadataStore::exec(const QString &sql)
+{
+    QSqlQuery query(m_db);
+    if (!query.exec(sql)) {
+        qDebug() << "Metadata statement failed:" << sql << ":" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
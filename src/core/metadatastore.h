@@ -0,0 +1,224 @@
+// metadatastore.h
+#ifndef METADATASTORE_H
+#define METADATASTORE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QSqlDatabase>
+#include <QTimer>
+#include <QThreadPool>
+
+class QSqlQuery;
+
+/**
+ * @brief The MetadataStore class keeps ratings, flags and tags of images in an SQLite database.
+ *
+ * Images are keyed by path, since image IDs only live as long as the
+ * viewer's path table. Ratings and flags are indexed columns and tags live
+ * in their own table keyed by tag first, so a filter is a single indexed
+ * query whose cost grows with the number of matches, not with the number
+ * of images known to the store.
+ *
+ * Changes are queued and written in one transaction, either shortly after
+ * the last change or before the next read, so rating images in quick
+ * succession or tagging thousands at once costs one commit. Reads and
+ * queries always see queued changes.
+ *
+ * Used from the GUI thread only; Qt SQL connections are bound to the
+ * thread that opened them. Filter queries, which may match a large part
+ * of the store, run on a worker with a connection of their own.
+ */
+class MetadataStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Review flags; an image has at most one.
+     */
+    enum Flag {
+        Unflagged = 0,
+        Picked = 1,
+        Rejected = 2
+    };
+
+    /**
+     * @brief Conditions a filtered view applies; all set conditions must hold.
+     */
+    struct Filter {
+        int minRating = 0;   ///< Lowest rating shown, 0 for any
+        int flag = -1;       ///< Required Flag, -1 for any
+        QString tag;         ///< Required tag, empty for any
+
+        /**
+         * @brief Checks whether the filter lets every image through.
+         * @return True if no condition is set.
+         */
+        bool isEmpty() const { return minRating <= 0 && flag < 0 && tag.isEmpty(); }
+    };
+
+    static const int MaxRating = 5; ///< Ratings run from 0 (unrated) to this
+
+    /**
+     * @brief Constructs a store that is not yet attached to a database.
+     * @param parent The parent object.
+     */
+    explicit MetadataStore(QObject *parent = nullptr);
+
+    /**
+     * @brief Writes queued changes and closes the database.
+     */
+    ~MetadataStore();
+
+    /**
+     * @brief Opens or creates the database.
+     * @param filePath The database file.
+     * @return True if the database is usable.
+     */
+    bool open(const QString &filePath);
+
+    /**
+     * @brief Sets the rating of images.
+     * @param paths The image paths.
+     * @param rating The rating, 0 to MaxRating.
+     */
+    void setRating(const QStringList &paths, int rating);
+
+    /**
+     * @brief Sets the flag of images.
+     * @param paths The image paths.
+     * @param flag The Flag.
+     */
+    void setFlag(const QStringList &paths, int flag);
+
+    /**
+     * @brief Adds a tag to images.
+     * @param paths The image paths.
+     * @param tag The tag.
+     */
+    void addTag(const QStringList &paths, const QString &tag);
+
+    /**
+     * @brief Removes a tag from images.
+     * @param paths The image paths.
+     * @param tag The tag.
+     */
+    void removeTag(const QStringList &paths, const QString &tag);
+
+    /**
+     * @brief Gets the rating of an image.
+     * @param path The image path.
+     * @return The rating, 0 if the image was never rated.
+     */
+    int rating(const QString &path);
+
+    /**
+     * @brief Gets the flag of an image.
+     * @param path The image path.
+     * @return The Flag.
+     */
+    int flag(const QString &path);
+
+    /**
+     * @brief Gets the tags of an image.
+     * @param path The image path.
+     * @return The tags, sorted.
+     */
+    QStringList tags(const QString &path);
+
+    /**
+     * @brief Starts finding every image the filter lets through, in the background.
+     *
+     * Queued changes are written first, so the query sees them.
+     * queryFinished() reports the result.
+     *
+     * @param filter The filter; must not be empty.
+     * @return Ticket identifying the query in queryFinished().
+     */
+    int startQuery(const Filter &filter);
+
+    /**
+     * @brief Checks whether one image passes a filter.
+     * @param path The image path.
+     * @param filter The filter.
+     * @return True if the image matches.
+     */
+    bool matches(const QString &path, const Filter &filter);
+
+    /**
+     * @brief Writes all queued changes in one transaction.
+     */
+    void flush();
+
+signals:
+    /**
+     * @brief Signal emitted when a query started with startQuery() is done.
+     * @param ticket The ticket startQuery() returned.
+     * @param paths Paths of all matching images the store knows, in no particular order.
+     */
+    void queryFinished(int ticket, const QStringList &paths);
+
+private:
+    /**
+     * @brief One queued change.
+     */
+    struct Change {
+        enum Op { SetRating, SetFlag, AddTag, RemoveTag };
+
+        Op op;         ///< What to change
+        QString path;  ///< The image
+        int value;     ///< Rating or flag
+        QString tag;   ///< Tag to add or remove
+    };
+
+    /**
+     * @brief Queues changes and arms the flush timer.
+     * @param changes The changes.
+     */
+    void enqueue(const QVector<Change> &changes);
+
+    /**
+     * @brief Builds the WHERE clause of a filter query.
+     * @param filter The filter.
+     * @return Conditions on the images table, without "WHERE".
+     */
+    static QString filterClause(const Filter &filter);
+
+    /**
+     * @brief Binds the values filterClause() refers to.
+     * @param query The prepared query.
+     * @param filter The filter.
+     */
+    static void bindFilter(QSqlQuery &query, const Filter &filter);
+
+    /**
+     * @brief Runs a filter query on its own connection; runs on a worker.
+     * @param filePath The database file.
+     * @param connectionName A connection name no other thread uses.
+     * @param filter The filter.
+     * @return Paths of all matching images.
+     */
+    static QStringList runQuery(const QString &filePath, const QString &connectionName, const Filter &filter);
+
+    /**
+     * @brief Runs a statement and logs failures.
+     * @param sql The statement.
+     * @return True on success.
+     */
+    bool exec(const QString &sql);
+
+    static const int FlushDelayMs = 500;     ///< Quiet time before queued changes are written
+    static const int MaxQueuedChanges = 10000; ///< Queue length that forces a write
+
+    QSqlDatabase m_db;          ///< The connection, unique to this store
+    QString m_connectionName;   ///< Name of the connection
+    QString m_filePath;         ///< The database file, reopened by queries
+    QThreadPool m_queryPool;    ///< Single worker running filter queries
+    int m_lastTicket = 0;       ///< Ticket of the latest query
+    QVector<Change> m_pending;  ///< Changes not yet written
+    QTimer m_flushTimer;        ///< Writes m_pending once changes stop coming
+};
+
+#endif // METADATASTORE_H
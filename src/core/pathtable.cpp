@@ -0,0 +1,141 @@
+// pathtable.cpp
+#include "pathtable.h"
+#include <QHashFunctions>
+#include <cstring>
+
+PathTable::PathTable()
+{
+    m_slots.fill(0, 1024);
+}
+
+int PathTable::intern(const QString &path)
+{
+    QString directoryPath;
+    QByteArray name;
+    split(path, &directoryPath, &name);
+
+    auto dir = m_directoryIds.constFind(directoryPath);
+    quint32 directory;
+    if (dir != m_directoryIds.constEnd()) {
+        directory = dir.value();
+    } else {
+        directory = quint32(m_directories.size());
+        m_directories.append(directoryPath);
+        m_directoryIds.insert(directoryPath, directory);
+    }
+
+    const quint32 hash = hashKey(directory, name);
+    int slot = findSlot(directory, name, hash);
+    if (m_slots[slot] > 0)
+        return m_slots[slot] - 1;
+
+    Entry entry;
+    entry.directory = directory;
+    entry.nameOffset = quint32(m_names.size());
+    entry.nameLength = quint32(name.size());
+    entry.hash = hash;
+    m_names.append(name);
+
+    const int id = m_entries.size();
+    m_entries.append(entry);
+    m_slots[slot] = id + 1;
+
+    // Keep probe sequences short: at most half the slots in use
+    if (m_entries.size() * 2 > m_slots.size()) {
+        grow();
+    }
+    return id;
+}
+
+QVector<int> PathTable::intern(const QStringList &paths)
+{
+    QVector<int> ids;
+    ids.reserve(paths.size());
+    for (const QString &path : paths) {
+        ids.append(intern(path));
+    }
+    return ids;
+}
+
+int PathTable::find(const QString &path) const
+{
+    QString directoryPath;
+    QByteArray name;
+    split(path, &directoryPath, &name);
+
+    auto dir = m_directoryIds.constFind(directoryPath);
+    if (dir == m_directoryIds.constEnd())
+        return -1;
+
+    const int slot = findSlot(dir.value(), name, hashKey(dir.value(), name));
+    return m_slots[slot] - 1;
+}
+
+QString PathTable::path(int id) const
+{
+    if (id < 0 || id >= m_entries.size())
+        return QString();
+
+    const Entry &entry = m_entries[id];
+    return m_directories[entry.directory]
+           + QString::fromUtf8(m_names.constData() + entry.nameOffset, entry.nameLength);
+}
+
+QStringList PathTable::paths(const QVector<int> &ids) const
+{
+    QStringList result;
+    result.reserve(ids.size());
+    for (int id : ids) {
+        result.append(path(id));
+    }
+    return result;
+}
+
+void PathTable::split(const QString &path, QString *directory, QByteArray *name)
+{
+    // Everything up to the last separator is shared with the file's siblings;
+    // archive entries ("a.zip!/x/y.jpg") and URLs split the same way
+    const qsizetype slash = path.lastIndexOf(QLatin1Char('/'));
+    *directory = path.left(slash + 1);
+    *name = QStringView(path).mid(slash + 1).toUtf8();
+}
+
+quint32 PathTable::hashKey(quint32 directory, const QByteArray &name)
+{
+    return quint32(qHashMulti(0, directory, name));
+}
+
+int PathTable::findSlot(quint32 directory, const QByteArray &name, quint32 hash) const
+{
+    const int mask = m_slots.size() - 1;
+    int slot = int(hash & quint32(mask));
+
+    // Linear probing; the stored hash rejects almost all mismatches before
+    // the names are compared
+    while (m_slots[slot] != 0) {
+        const Entry &entry = m_entries[m_slots[slot] - 1];
+        if (entry.hash == hash && entry.directory == directory
+            && entry.nameLength == quint32(name.size())
+            && std::memcmp(m_names.constData() + entry.nameOffset, name.constData(), name.size()) == 0) {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void PathTable::grow()
+{
+    QVector<qint32> slots(m_slots.size() * 2, 0);
+    const int mask = slots.size() - 1;
+
+    for (int id = 0; id < m_entries.size(); ++id) {
+        int slot = int(m_entries[id].hash & quint32(mask));
+        while (slots[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = id + 1;
+    }
+
+    m_slots = slots;
+}
@@ -0,0 +1,131 @@
+// pathtable.h
+#ifndef PATHTABLE_H
+#define PATHTABLE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QByteArray>
+
+/**
+ * @brief The PathTable class interns image paths and gives each an integer ID.
+ *
+ * Everything on the GUI side refers to images by ID (the collection order,
+ * favorites and rotations), so each path is stored once and comparisons are
+ * integer comparisons. Entries are never changed or removed once added, so
+ * an ID stays valid for the lifetime of the table.
+ *
+ * The flip side is that nothing is reclaimed: opening another collection
+ * adds its paths next to those of the previous ones, and favorites,
+ * rotations and the per-ID arrays elsewhere keep referring to the old IDs.
+ * A session that opens many large collections grows by roughly the cost
+ * above for every path it has ever seen.
+ *
+ * Paths are stored prefix-compressed: the directory part is interned
+ * separately and shared by all files in it, and file names are kept as
+ * UTF-8 in a single buffer. A collection of N images costs about
+ * 16 bytes plus the file name length per image, instead of a QString
+ * with the full path (plus hash node) per copy.
+ *
+ * Not thread-safe; used from the GUI thread. Background tasks keep working
+ * on plain path strings.
+ */
+class PathTable
+{
+public:
+    /**
+     * @brief Constructs an empty table.
+     */
+    PathTable();
+
+    /**
+     * @brief Gets the ID of a path, adding it if needed.
+     * @param path The path.
+     * @return The ID.
+     */
+    int intern(const QString &path);
+
+    /**
+     * @brief Interns a list of paths.
+     * @param paths The paths.
+     * @return The IDs, index-aligned with paths.
+     */
+    QVector<int> intern(const QStringList &paths);
+
+    /**
+     * @brief Looks up the ID of a path without adding it.
+     * @param path The path.
+     * @return The ID, or -1 if the path was never interned.
+     */
+    int find(const QString &path) const;
+
+    /**
+     * @brief Rebuilds the path of an ID.
+     * @param id The ID.
+     * @return The path, or an empty string for an unknown ID.
+     */
+    QString path(int id) const;
+
+    /**
+     * @brief Rebuilds the paths of a list of IDs.
+     * @param ids The IDs.
+     * @return The paths, index-aligned with ids.
+     */
+    QStringList paths(const QVector<int> &ids) const;
+
+    /**
+     * @brief Gets the number of interned paths.
+     * @return The number of IDs handed out; IDs are 0 to size() - 1.
+     */
+    int size() const { return m_entries.size(); }
+
+private:
+    /**
+     * @brief One interned path.
+     */
+    struct Entry {
+        quint32 directory;   ///< Index into m_directories
+        quint32 nameOffset;  ///< Start of the UTF-8 file name in m_names
+        quint32 nameLength;  ///< Length of the file name in bytes
+        quint32 hash;        ///< Hash of directory and name, kept for rehashing
+    };
+
+    /**
+     * @brief Splits a path after its last separator.
+     * @param path The path.
+     * @param directory Receives the directory part, including the separator.
+     * @param name Receives the UTF-8 file name.
+     */
+    static void split(const QString &path, QString *directory, QByteArray *name);
+
+    /**
+     * @brief Hashes an entry's key.
+     * @param directory The directory index.
+     * @param name The UTF-8 file name.
+     * @return The hash.
+     */
+    static quint32 hashKey(quint32 directory, const QByteArray &name);
+
+    /**
+     * @brief Finds the slot holding an entry, or the empty slot where it belongs.
+     * @param directory The directory index.
+     * @param name The UTF-8 file name.
+     * @param hash The key's hash.
+     * @return The slot index.
+     */
+    int findSlot(quint32 directory, const QByteArray &name, quint32 hash) const;
+
+    /**
+     * @brief Doubles the slot array and reinserts all entries.
+     */
+    void grow();
+
+    QVector<Entry> m_entries;               ///< Entries by ID
+    QByteArray m_names;                     ///< All file names, UTF-8, back to back
+    QStringList m_directories;              ///< Interned directories
+    QHash<QString, quint32> m_directoryIds; ///< Directory to index in m_directories
+    QVector<qint32> m_slots;                ///< Open-addressing index: ID + 1, or 0 if empty
+};
+
+#endif // PATHTABLE_H
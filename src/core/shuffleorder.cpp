@@ -0,0 +1,84 @@
+// shuffleorder.cpp
+#include "shuffleorder.h"
+#include <QRandomGenerator>
+#include <utility>
+
+void ShuffleOrder::reset(const QVector<int> &ids)
+{
+    QRandomGenerator *random = QRandomGenerator::global();
+
+    // Fisher-Yates
+    m_order = ids;
+    for (int i = m_order.size() - 1; i > 0; --i) {
+        std::swap(m_order[i], m_order[random->bounded(i + 1)]);
+    }
+    m_position = 0;
+
+    // Back to back, the same image would look like a repeat
+    if (m_order.size() > 1 && m_order.first() == m_last) {
+        std::swap(m_order[0], m_order[1 + random->bounded(m_order.size() - 1)]);
+    }
+
+    m_known.fill(false);
+    for (int id : std::as_const(m_order)) {
+        if (id >= m_known.size()) {
+            m_known.resize(qMax(id + 1, int(m_known.size()) * 2));
+        }
+        m_known.setBit(id);
+    }
+}
+
+void ShuffleOrder::sync(const QVector<int> &ids)
+{
+    QRandomGenerator *random = QRandomGenerator::global();
+
+    for (int id : ids) {
+        if (id < m_known.size() && m_known.testBit(id))
+            continue;
+
+        if (id >= m_known.size()) {
+            m_known.resize(qMax(id + 1, int(m_known.size()) * 2));
+        }
+        m_known.setBit(id);
+
+        // Inside-out shuffle step: a uniform position among the undealt entries
+        m_order.append(id);
+        const int swapWith = m_position + random->bounded(m_order.size() - m_position);
+        std::swap(m_order.last(), m_order[swapWith]);
+    }
+}
+
+int ShuffleOrder::take(const Predicate &accept)
+{
+    while (m_position < m_order.size()) {
+        const int id = m_order[m_position++];
+        if (accept(id)) {
+            m_last = id;
+            return id;
+        }
+    }
+    return -1;
+}
+
+int ShuffleOrder::next(const QVector<int> &ids, const Predicate &accept)
+{
+    sync(ids);
+
+    int id = take(accept);
+    if (id < 0) {
+        reset(ids);
+        id = take(accept);
+    }
+    return id;
+}
+
+QVector<int> ShuffleOrder::peek(int count, const Predicate &accept) const
+{
+    QVector<int> upcoming;
+    for (int i = m_position; i < m_order.size() && upcoming.size() < count; ++i) {
+        if (accept(m_order[i])) {
+            upcoming.append(m_order[i]);
+        }
+    }
+    return upcoming;
+}
@@ -0,0 +1,81 @@
+// shuffleorder.h
+#ifndef SHUFFLEORDER_H
+#define SHUFFLEORDER_H
+
+#include <QVector>
+#include <QBitArray>
+#include <functional>
+
+/**
+ * @brief The ShuffleOrder class deals out image IDs in a random order without repeats.
+ *
+ * The order is a permutation generated up front, so the next few picks
+ * are known before they are needed and can be decoded ahead of time.
+ * Every image comes up once before any comes up again; when the
+ * permutation runs out, a new one is drawn over the current collection.
+ *
+ * Images added to the collection are shuffled into the part of the
+ * permutation not yet dealt. Removed or filtered-out images are not
+ * taken out; callers pass a predicate and they are skipped when reached.
+ */
+class ShuffleOrder
+{
+public:
+    /**
+     * @brief Decides whether an image ID may be dealt.
+     */
+    using Predicate = std::function<bool(int)>;
+
+    /**
+     * @brief Draws a new permutation.
+     * @param ids The image IDs to shuffle.
+     */
+    void reset(const QVector<int> &ids);
+
+    /**
+     * @brief Shuffles images the permutation does not know yet into its undealt part.
+     * @param ids The current collection.
+     */
+    void sync(const QVector<int> &ids);
+
+    /**
+     * @brief Deals the next image.
+     *
+     * Starts a new permutation over the collection once the current one is
+     * used up; it never begins with the image dealt last.
+     *
+     * @param ids The current collection.
+     * @param accept Whether an ID may be dealt now.
+     * @return The image ID, or -1 if the collection has none to deal.
+     */
+    int next(const QVector<int> &ids, const Predicate &accept);
+
+    /**
+     * @brief Looks at the images next() will deal, without dealing them.
+     * @param count How many to look at.
+     * @param accept Whether an ID may be dealt.
+     * @return Up to count image IDs in dealing order; fewer near the end of a permutation.
+     */
+    QVector<int> peek(int count, const Predicate &accept) const;
+
+    /**
+     * @brief Gets how many images are left before the order repeats.
+     * @return The number of undealt entries, including ones that will be skipped.
+     */
+    int remaining() const { return m_order.size() - m_position; }
+
+private:
+    /**
+     * @brief Takes the next acceptable ID from the current permutation.
+     * @param accept Whether an ID may be dealt.
+     * @return The ID, or -1 if the permutation is used up.
+     */
+    int take(const Predicate &accept);
+
+    QVector<int> m_order;  ///< The permutation; entries before m_position are dealt
+    int m_position = 0;    ///< Next entry to deal
+    QBitArray m_known;     ///< Bit per image ID in m_order
+    int m_last = -1;       ///< ID dealt last, kept from starting the next permutation
+};
+
+#endif // SHUFFLEORDER_H
@@ -0,0 +1,142 @@
+// throttledimagesource.cpp
+#include "throttledimagesource.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QHash>
+#include <QDebug>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Passes reads through to another device, delaying each one.
+ */
+class ThrottledDevice : public QIODevice
+{
+public:
+    explicit ThrottledDevice(std::unique_ptr<QIODevice> inner)
+        : m_inner(std::move(inner))
+    {
+    }
+
+    bool isSequential() const override { return m_inner->isSequential(); }
+    qint64 size() const override { return m_inner->size(); }
+
+    bool seek(qint64 pos) override
+    {
+        return m_inner->seek(pos) && QIODevice::seek(pos);
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        const qint64 bytesRead = m_inner->read(data, maxSize);
+        if (bytesRead > 0)
+            ThrottledImageSource::delay(bytesRead);
+        return bytesRead;
+    }
+
+    qint64 writeData(const char *, qint64) override { return -1; }
+
+private:
+    std::unique_ptr<QIODevice> m_inner; ///< The real device
+};
+
+QMutex s_linkMutex;
+Clock::time_point s_linkFreeAt; ///< When the simulated link finishes its queued transfers
+
+} // namespace
+
+const ThrottledImageSource::Settings &ThrottledImageSource::settings()
+{
+    static const Settings settings = []() {
+        Settings s;
+        s.latencyMs = qMax(0, qEnvironmentVariableIntValue("DIV_IO_LATENCY_MS"));
+        s.bytesPerSecond = qMax(0, qEnvironmentVariableIntValue("DIV_IO_BANDWIDTH_KBPS")) * qint64(1024);
+        if (s.latencyMs > 0 || s.bytesPerSecond > 0) {
+            qDebug() << "Simulating slow storage:" << s.latencyMs << "ms per read,"
+                     << (s.bytesPerSecond > 0 ? s.bytesPerSecond / 1024 : -1) << "KiB/s";
+        }
+        return s;
+    }();
+    return settings;
+}
+
+bool ThrottledImageSource::isEnabled()
+{
+    return settings().latencyMs > 0 || settings().bytesPerSecond > 0;
+}
+
+ThrottledImageSource *ThrottledImageSource::wrap(ImageSource *backend)
+{
+    static QMutex mutex;
+    static QHash<ImageSource *, ThrottledImageSource *> wrappers;
+
+    QMutexLocker locker(&mutex);
+    ThrottledImageSource *&wrapper = wrappers[backend];
+    if (!wrapper)
+        wrapper = new ThrottledImageSource(backend); // Lives as long as the backend singletons
+    return wrapper;
+}
+
+void ThrottledImageSource::delay(qint64 bytes)
+{
+    const Settings &s = settings();
+
+    // The request waits out its latency, then queues for the shared link
+    Clock::time_point done = Clock::now() + std::chrono::milliseconds(s.latencyMs);
+    if (s.bytesPerSecond > 0) {
+        const auto transfer = std::chrono::nanoseconds(bytes * 1000000000 / s.bytesPerSecond);
+        QMutexLocker locker(&s_linkMutex);
+        s_linkFreeAt = qMax(s_linkFreeAt, done) + std::chrono::duration_cast<Clock::duration>(transfer);
+        done = s_linkFreeAt;
+    }
+    std::this_thread::sleep_until(done);
+}
+
+std::unique_ptr<QIODevice> ThrottledImageSource::open(const QString &path)
+{
+    // Opening is a request of its own (lookup and open on the server)
+    delay(0);
+    std::unique_ptr<QIODevice> inner = m_backend->open(path);
+    if (!inner)
+        return nullptr;
+
+    auto device = std::make_unique<ThrottledDevice>(std::move(inner));
+    device->open(QIODevice::ReadOnly);
+    return device;
+}
+
+QByteArray ThrottledImageSource::readHead(const QString &path, qint64 maxSize)
+{
+    const QByteArray head = m_backend->readHead(path, maxSize);
+    delay(head.size());
+    return head;
+}
+
+QVector<QByteArray> ThrottledImageSource::readHeads(const QStringList &paths, qint64 maxSize)
+{
+    // The backend batches as it would without throttling; the batch is one
+    // request on the simulated storage, transferring all the heads
+    const QVector<QByteArray> heads = m_backend->readHeads(paths, maxSize);
+    qint64 bytes = 0;
+    for (const QByteArray &head : heads)
+        bytes += head.size();
+    delay(bytes);
+    return heads;
+}
+
+qint64 ThrottledImageSource::fileSize(const QString &path)
+{
+    delay(0);
+    return m_backend->fileSize(path);
+}
+
+qint64 ThrottledImageSource::adviseWillNeed(const QString &path, qint64 maxBytes)
+{
+    // Hints cost nothing on the simulated storage; the real backend still takes them
+    return m_backend->adviseWillNeed(path, maxBytes);
+}
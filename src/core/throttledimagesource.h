@@ -0,0 +1,73 @@
+// throttledimagesource.h
+#ifndef THROTTLEDIMAGESOURCE_H
+#define THROTTLEDIMAGESOURCE_H
+
+#include "imagesource.h"
+
+/**
+ * @brief The ThrottledImageSource class makes any backend behave like slow storage.
+ *
+ * A development aid for reproducing NFS/SMB-like conditions on a local
+ * disk. When enabled, ImageSource::forPath() wraps every backend in one of
+ * these; each read then waits for a fixed per-request latency, and all
+ * reads share one simulated link of limited bandwidth, so concurrent reads
+ * slow each other down as they would on a real network.
+ *
+ * Configured from the environment when first used:
+ * - DIV_IO_LATENCY_MS: latency added to every read request.
+ * - DIV_IO_BANDWIDTH_KBPS: bandwidth of the shared link in KiB/s (0 = unlimited).
+ */
+class ThrottledImageSource : public ImageSource
+{
+public:
+    /**
+     * @brief The simulated storage parameters.
+     */
+    struct Settings {
+        int latencyMs = 0;            ///< Latency per read request
+        qint64 bytesPerSecond = 0;    ///< Link bandwidth, 0 for unlimited
+    };
+
+    /**
+     * @brief Gets the settings read from the environment.
+     * @return The settings.
+     */
+    static const Settings &settings();
+
+    /**
+     * @brief Checks whether throttling is configured.
+     * @return True if any limit is set.
+     */
+    static bool isEnabled();
+
+    /**
+     * @brief Gets the throttled wrapper of a backend.
+     * @param backend The backend to wrap.
+     * @return The wrapper, shared by all callers.
+     */
+    static ThrottledImageSource *wrap(ImageSource *backend);
+
+    /**
+     * @brief Waits as long as a read of the given size takes on the simulated storage.
+     * @param bytes Number of bytes read.
+     */
+    static void delay(qint64 bytes);
+
+    bool isRemote() const override { return m_backend->isRemote(); }
+    std::unique_ptr<QIODevice> open(const QString &path) override;
+    QByteArray readHead(const QString &path, qint64 maxSize) override;
+    QVector<QByteArray> readHeads(const QStringList &paths, qint64 maxSize) override;
+    qint64 fileSize(const QString &path) override;
+    qint64 adviseWillNeed(const QString &path, qint64 maxBytes) override;
+
+private:
+    /**
+     * @brief Constructs a wrapper.
+     * @param backend The backend to wrap.
+     */
+    explicit ThrottledImageSource(ImageSource *backend) : m_backend(backend) {}
+
+    ImageSource *m_backend; ///< The wrapped backend
+};
+
+#endif // THROTTLEDIMAGESOURCE_H
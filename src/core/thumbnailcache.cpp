@@ -0,0 +1,60 @@
+// thumbnailcache.cpp
+#include "thumbnailcache.h"
+#include <QMutexLocker>
+
+ThumbnailCache::ThumbnailCache(qint64 maxBytes)
+{
+    // QCache costs are ints, so account in kilobytes
+    m_cache.setMaxCost(static_cast<int>(maxBytes / 1024));
+}
+
+void ThumbnailCache::insert(const QString &path, const QImage &thumbnail)
+{
+    if (thumbnail.isNull())
+        return;
+
+    int cost = qMax(1, static_cast<int>(thumbnail.sizeInBytes() / 1024));
+
+    QMutexLocker locker(&m_mutex);
+    m_cache.insert(path, new QImage(thumbnail), cost);
+}
+
+QImage ThumbnailCache::find(const QString &path) const
+{
+    QMutexLocker locker(&m_mutex);
+    const QImage *thumbnail = m_cache.object(path);
+    return thumbnail ? *thumbnail : QImage();
+}
+
+bool ThumbnailCache::contains(const QString &path) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cache.contains(path);
+}
+
+void ThumbnailCache::remove(const QString &path)
+{
+    QMutexLocker locker(&m_mutex);
+    m_cache.remove(path);
+}
+
+void ThumbnailCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_cache.clear();
+}
+
+QImage ThumbnailCache::makeThumbnail(const QImage &image)
+{
+    if (image.isNull() || image.height() <= ThumbnailHeight)
+        return image;
+
+    // A fast pass down to twice the final size keeps the smooth pass cheap
+    // for very large sources without visibly hurting quality
+    QImage reduced = image;
+    if (image.height() > ThumbnailHeight * 4) {
+        reduced = image.scaledToHeight(ThumbnailHeight * 2, Qt::FastTransformation);
+    }
+
+    return reduced.scaledToHeight(ThumbnailHeight, Qt::SmoothTransformation);
+}
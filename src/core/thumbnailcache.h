@@ -0,0 +1,76 @@
+// thumbnailcache.h
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+
+/**
+ * @brief The ThumbnailCache class holds small, low-resolution copies of images.
+ *
+ * Thumbnails are cheap to keep for far more images than fit in the decoded
+ * image window, so the viewer can show something for any image it has seen
+ * before without going back to the decoder. The cache is thread-safe: load
+ * tasks insert from worker threads while the GUI thread reads.
+ */
+class ThumbnailCache
+{
+public:
+    /**
+     * @brief The height thumbnails are scaled to.
+     */
+    static constexpr int ThumbnailHeight = 160;
+
+    /**
+     * @brief Constructs a thumbnail cache.
+     * @param maxBytes The memory budget for all cached thumbnails.
+     */
+    explicit ThumbnailCache(qint64 maxBytes = 128 * 1024 * 1024);
+
+    /**
+     * @brief Stores a thumbnail for an image.
+     * @param path The file path of the image.
+     * @param thumbnail The thumbnail image.
+     */
+    void insert(const QString &path, const QImage &thumbnail);
+
+    /**
+     * @brief Looks up the thumbnail for an image.
+     * @param path The file path of the image.
+     * @return The thumbnail, or a null image if none is cached.
+     */
+    QImage find(const QString &path) const;
+
+    /**
+     * @brief Checks whether a thumbnail is cached for an image.
+     * @param path The file path of the image.
+     * @return True if a thumbnail is cached.
+     */
+    bool contains(const QString &path) const;
+
+    /**
+     * @brief Removes the thumbnail for an image.
+     * @param path The file path of the image.
+     */
+    void remove(const QString &path);
+
+    /**
+     * @brief Removes all thumbnails.
+     */
+    void clear();
+
+    /**
+     * @brief Scales an image down to thumbnail size.
+     * @param image The source image.
+     * @return The thumbnail, or the source image if it is already small enough.
+     */
+    static QImage makeThumbnail(const QImage &image);
+
+private:
+    mutable QMutex m_mutex;                      ///< Guards the cache
+    QCache<QString, QImage> m_cache;             ///< Thumbnails by path, cost in KB
+};
+
+#endif // THUMBNAILCACHE_H
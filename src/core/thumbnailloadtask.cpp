@@ -0,0 +1,92 @@
+// thumbnailloadtask.cpp
+#include "thumbnailloadtask.h"
+#include "thumbnailcache.h"
+#include "exifreader.h"
+#include "imagesource.h"
+#include <QImage>
+#include <QImageReader>
+#include <QDebug>
+
+ThumbnailLoadTask::ThumbnailLoadTask(const QString &path, ThumbnailCache *thumbnailCache,
+                                     bool embeddedOnly, ImageFormat format)
+    : QObject(nullptr), QRunnable()
+    , m_path(path)
+    , m_thumbnailCache(thumbnailCache)
+    , m_embeddedOnly(embeddedOnly)
+    , m_format(format)
+{
+    setAutoDelete(true);
+}
+
+void ThumbnailLoadTask::run()
+{
+    // Another request may have filled the cache while this one was queued
+    if (m_thumbnailCache->contains(m_path)) {
+        emit thumbnailReady(m_path);
+        return;
+    }
+
+    // Locally one device serves both reads, so an archive entry is located
+    // only once; a remote image is not downloaded unless the head has no thumbnail
+    ImageSource *source = ImageSource::forPath(m_path);
+    std::unique_ptr<QIODevice> device;
+    if (!source->isRemote()) {
+        device = source->open(m_path);
+        if (!device) {
+            qDebug() << "Error: Cannot read thumbnail source:" << m_path;
+            return;
+        }
+    }
+
+    // Camera JPEGs usually carry a small thumbnail in the first few KB;
+    // other formats known from the scan have none worth reading for
+    if (m_format == ImageFormat::Jpeg || m_format == ImageFormat::Unknown) {
+        ExifInfo info = device ? ExifReader::read(device.get()) : ExifReader::read(m_path);
+        QImage embedded;
+        if (!info.thumbnailData.isEmpty())
+            embedded = QImage::fromData(info.thumbnailData, "JPEG");
+        if (!embedded.isNull()) {
+            embedded = ExifReader::applyOrientation(embedded, info.orientation);
+            m_thumbnailCache->insert(m_path, ThumbnailCache::makeThumbnail(embedded));
+            emit thumbnailReady(m_path);
+            return;
+        }
+        if (device)
+            device->seek(0);
+    }
+
+    if (m_embeddedOnly)
+        return;
+
+    if (!device) {
+        device = source->open(m_path);
+        if (!device) {
+            qDebug() << "Error: Cannot read thumbnail source:" << m_path;
+            return;
+        }
+    }
+
+    QImageReader reader(device.get(), FormatSniffer::formatName(m_format));
+    if (m_format != ImageFormat::Unknown) {
+        reader.setAutoDetectImageFormat(false);
+    }
+    reader.setAutoTransform(true);
+
+    // Ask the decoder for a reduced size up front; JPEG can skip most of
+    // the work this way
+    QSize originalSize = reader.size();
+    if (originalSize.isValid() && originalSize.height() > ThumbnailCache::ThumbnailHeight) {
+        reader.setScaledSize(originalSize.scaled(originalSize.width(),
+                                                 ThumbnailCache::ThumbnailHeight,
+                                                 Qt::KeepAspectRatio));
+    }
+
+    QImage image = reader.read();
+    if (image.isNull()) {
+        qDebug() << "Error: Failed to load thumbnail:" << m_path << reader.errorString();
+        return;
+    }
+
+    m_thumbnailCache->insert(m_path, ThumbnailCache::makeThumbnail(image));
+    emit thumbnailReady(m_path);
+}
@@ -0,0 +1,63 @@
+// thumbnailloadtask.h
+#ifndef THUMBNAILLOADTASK_H
+#define THUMBNAILLOADTASK_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QString>
+#include "formatsniffer.h"
+
+class ThumbnailCache;
+
+/**
+ * @brief The ThumbnailLoadTask class produces a low-resolution thumbnail for one image.
+ *
+ * Uses the thumbnail embedded in the EXIF header when there is one, which
+ * only needs a small read at the start of the file. Otherwise (unless limited
+ * to embedded thumbnails) decodes at reduced size where the format allows it
+ * (JPEG scales during decoding), which is still far cheaper than a full
+ * decode. The result goes into the thumbnail cache; the full-size image
+ * pipeline is not involved.
+ */
+class ThumbnailLoadTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs a thumbnail loading task.
+     * @param path The file path to the image.
+     * @param thumbnailCache The cache receiving the thumbnail.
+     * @param embeddedOnly Only use an embedded EXIF thumbnail, never decode the image.
+     * @param format The format detected during scanning; Unknown lets Qt probe.
+     */
+    ThumbnailLoadTask(const QString &path, ThumbnailCache *thumbnailCache,
+                      bool embeddedOnly = false, ImageFormat format = ImageFormat::Unknown);
+
+    /**
+     * @brief Default destructor.
+     */
+    ~ThumbnailLoadTask() override = default;
+
+    /**
+     * @brief Decodes the thumbnail.
+     *
+     * This method runs in a worker thread and emits thumbnailReady when done.
+     */
+    void run() override;
+
+signals:
+    /**
+     * @brief Signal emitted when the thumbnail has been cached.
+     * @param path The file path of the image.
+     */
+    void thumbnailReady(const QString &path);
+
+private:
+    QString m_path;                   ///< File path to the image
+    ThumbnailCache *m_thumbnailCache; ///< Cache receiving the thumbnail
+    bool m_embeddedOnly;              ///< Skip the reduced-size decode fallback
+    ImageFormat m_format;             ///< Known format, skips plugin probing
+};
+
+#endif // THUMBNAILLOADTASK_H
@@ -0,0 +1,409 @@
+// ziparchive.cpp
+#include "ziparchive.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QFileInfo>
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+#include <zlib.h>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const quint32 LocalHeaderSignature = 0x04034b50;
+const quint32 CentralHeaderSignature = 0x02014b50;
+const quint32 EndOfCentralDirSignature = 0x06054b50;
+const quint32 Zip64LocatorSignature = 0x07064b50;
+const quint32 Zip64EndOfCentralDirSignature = 0x06064b50;
+const quint16 Zip64ExtraFieldId = 0x0001;
+
+const int LocalHeaderSize = 30;
+const int CentralHeaderSize = 46;
+const int EndOfCentralDirSize = 22;
+const int Zip64LocatorSize = 20;
+const int Zip64EndOfCentralDirSize = 56;
+const int MaxCommentSize = 0xFFFF;
+
+const quint16 MethodStored = 0;
+const quint16 MethodDeflated = 8;
+
+quint16 read16(const uchar *p) { return qFromLittleEndian<quint16>(p); }
+quint32 read32(const uchar *p) { return qFromLittleEndian<quint32>(p); }
+quint64 read64(const uchar *p) { return qFromLittleEndian<quint64>(p); }
+
+/**
+ * @brief Reads one archive entry straight from the mapping.
+ *
+ * Stored data is copied out of the mapping as requested; deflated data is
+ * inflated incrementally, so only the part the reader consumes is ever
+ * decompressed. Seeking backwards restarts the inflater, which decoders
+ * only do to re-read the first bytes of the header.
+ */
+class ZipEntryDevice : public QIODevice
+{
+public:
+    ZipEntryDevice(std::shared_ptr<const ZipArchive> archive, const uchar *data,
+                   quint64 compressedSize, quint64 uncompressedSize, quint16 method)
+        : m_archive(std::move(archive))
+        , m_data(data)
+        , m_compressedSize(compressedSize)
+        , m_uncompressedSize(uncompressedSize)
+        , m_method(method)
+    {
+    }
+
+    ~ZipEntryDevice() override
+    {
+        if (m_inflating)
+            inflateEnd(&m_stream);
+    }
+
+    bool open(OpenMode mode) override
+    {
+        if ((mode & QIODevice::WriteOnly) || !resetStream())
+            return false;
+        return QIODevice::open(mode);
+    }
+
+    void close() override
+    {
+        if (m_inflating) {
+            inflateEnd(&m_stream);
+            m_inflating = false;
+        }
+        QIODevice::close();
+    }
+
+    bool isSequential() const override { return false; }
+    qint64 size() const override { return qint64(m_uncompressedSize); }
+
+    bool seek(qint64 pos) override
+    {
+        if (pos < 0 || quint64(pos) > m_uncompressedSize)
+            return false;
+        if (m_method == MethodDeflated) {
+            if (quint64(pos) < m_outPos && !resetStream())
+                return false;
+            char scratch[16384];
+            while (m_outPos < quint64(pos)) {
+                const qint64 skip = qMin<qint64>(sizeof(scratch), pos - qint64(m_outPos));
+                if (inflateInto(scratch, skip) <= 0)
+                    return false;
+            }
+        } else {
+            m_outPos = quint64(pos);
+        }
+        return QIODevice::seek(pos);
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        if (m_outPos >= m_uncompressedSize)
+            return 0;
+        const qint64 wanted = qMin<qint64>(maxSize, qint64(m_uncompressedSize - m_outPos));
+        if (m_method == MethodStored) {
+            // Only the compressed span was checked against the mapping
+            if (m_outPos >= m_compressedSize)
+                return 0;
+            const qint64 copied = qMin<qint64>(wanted, qint64(m_compressedSize - m_outPos));
+            std::memcpy(data, m_data + m_outPos, size_t(copied));
+            m_outPos += quint64(copied);
+            return copied;
+        }
+        return inflateInto(data, wanted);
+    }
+
+    qint64 writeData(const char *, qint64) override { return -1; }
+
+private:
+    bool resetStream()
+    {
+        m_outPos = 0;
+        if (m_method != MethodDeflated)
+            return true;
+        if (m_inflating)
+            inflateEnd(&m_stream);
+        std::memset(&m_stream, 0, sizeof(m_stream));
+        // Raw deflate: zip entries carry no zlib header
+        m_inflating = inflateInit2(&m_stream, -MAX_WBITS) == Z_OK;
+        m_inputPos = 0;
+        return m_inflating;
+    }
+
+    qint64 inflateInto(char *out, qint64 maxSize)
+    {
+        m_stream.next_out = reinterpret_cast<Bytef *>(out);
+        m_stream.avail_out = uInt(qMin<qint64>(maxSize, 0x7FFFFFFF));
+        while (m_stream.avail_out > 0) {
+            if (m_stream.avail_in == 0 && m_inputPos < m_compressedSize) {
+                // Feed the mapping in bounded slices; avail_in is 32-bit
+                const quint64 slice = qMin<quint64>(m_compressedSize - m_inputPos, 1u << 30);
+                m_stream.next_in = const_cast<Bytef *>(m_data + m_inputPos);
+                m_stream.avail_in = uInt(slice);
+                m_inputPos += slice;
+            }
+            const int result = inflate(&m_stream, Z_NO_FLUSH);
+            if (result == Z_STREAM_END)
+                break;
+            if (result != Z_OK) {
+                setErrorString(QStringLiteral("Corrupt deflate stream"));
+                return -1;
+            }
+            if (m_stream.avail_in == 0 && m_inputPos >= m_compressedSize)
+                break;
+        }
+        const qint64 produced = qMin<qint64>(maxSize, 0x7FFFFFFF) - m_stream.avail_out;
+        m_outPos += quint64(produced);
+        return produced;
+    }
+
+    std::shared_ptr<const ZipArchive> m_archive; ///< Keeps the mapping alive
+    const uchar *m_data;                         ///< Start of the entry data
+    quint64 m_compressedSize;
+    quint64 m_uncompressedSize;
+    quint16 m_method;
+    z_stream m_stream;
+    bool m_inflating = false;                    ///< m_stream is initialized
+    quint64 m_inputPos = 0;                      ///< Compressed bytes handed to zlib
+    quint64 m_outPos = 0;                        ///< Uncompressed position
+};
+
+QMutex s_registryMutex;
+QHash<QString, std::weak_ptr<ZipArchive>> s_registry;
+
+} // namespace
+
+ZipArchive::~ZipArchive()
+{
+    if (m_data)
+        m_file.unmap(const_cast<uchar *>(m_data));
+}
+
+std::shared_ptr<ZipArchive> ZipArchive::open(const QString &archivePath)
+{
+    const QString key = QFileInfo(archivePath).absoluteFilePath();
+
+    QMutexLocker locker(&s_registryMutex);
+    if (std::shared_ptr<ZipArchive> existing = s_registry.value(key).lock())
+        return existing;
+
+    std::shared_ptr<ZipArchive> archive(new ZipArchive());
+    if (!archive->load(key))
+        return nullptr;
+    archive->m_self = archive;
+    s_registry.insert(key, archive);
+    return archive;
+}
+
+bool ZipArchive::isArchiveFile(const QString &path)
+{
+    return path.endsWith(QLatin1String(".zip"), Qt::CaseInsensitive)
+           || path.endsWith(QLatin1String(".cbz"), Qt::CaseInsensitive);
+}
+
+bool ZipArchive::splitPath(const QString &path, QString *archivePath, QString *entryName)
+{
+    qsizetype separator = path.indexOf(QLatin1String("!/"));
+    while (separator >= 0) {
+        if (isArchiveFile(path.left(separator))) {
+            if (archivePath)
+                *archivePath = path.left(separator);
+            if (entryName)
+                *entryName = path.mid(separator + 2);
+            return true;
+        }
+        separator = path.indexOf(QLatin1String("!/"), separator + 2);
+    }
+    return false;
+}
+
+QString ZipArchive::entryPath(const QString &archivePath, const QString &entryName)
+{
+    return archivePath + QLatin1String("!/") + entryName;
+}
+
+std::unique_ptr<QIODevice> ZipArchive::openEntry(int index) const
+{
+    if (index < 0 || index >= m_entries.size())
+        return nullptr;
+
+    const Entry &entry = m_entries[index];
+    const qint64 offset = dataOffset(entry);
+    if (offset < 0)
+        return nullptr;
+
+    std::shared_ptr<const ZipArchive> self = m_self.lock();
+    auto device = std::make_unique<ZipEntryDevice>(self, m_data + offset, entry.compressedSize,
+                                                   entry.uncompressedSize, entry.method);
+    if (!device->open(QIODevice::ReadOnly))
+        return nullptr;
+    return device;
+}
+
+qint64 ZipArchive::adviseWillNeed(int index, qint64 maxBytes) const
+{
+    if (index < 0 || index >= m_entries.size())
+        return 0;
+
+    const Entry &entry = m_entries[index];
+    const qint64 offset = dataOffset(entry);
+    if (offset < 0)
+        return 0;
+    const qint64 length = qMin<qint64>(qint64(entry.compressedSize), maxBytes);
+
+#ifdef Q_OS_UNIX
+    // madvise needs a page-aligned start
+    static const qint64 pageSize = sysconf(_SC_PAGESIZE);
+    const qint64 alignedOffset = offset - offset % pageSize;
+    if (madvise(const_cast<uchar *>(m_data) + alignedOffset, size_t(length + offset - alignedOffset),
+                MADV_WILLNEED) != 0)
+        return 0;
+    return length;
+#else
+    return 0;
+#endif
+}
+
+bool ZipArchive::load(const QString &archivePath)
+{
+    m_archivePath = archivePath;
+    m_file.setFileName(archivePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Cannot open archive" << archivePath;
+        return false;
+    }
+
+    m_size = m_file.size();
+    if (m_size < EndOfCentralDirSize)
+        return false;
+    m_data = m_file.map(0, m_size);
+    if (!m_data) {
+        qDebug() << "Cannot map archive" << archivePath;
+        return false;
+    }
+
+    // The end record sits before a trailing comment of up to 64 KB
+    qint64 eocd = -1;
+    const qint64 searchStart = qMax<qint64>(0, m_size - EndOfCentralDirSize - MaxCommentSize);
+    for (qint64 pos = m_size - EndOfCentralDirSize; pos >= searchStart; --pos) {
+        if (read32(m_data + pos) == EndOfCentralDirSignature) {
+            eocd = pos;
+            break;
+        }
+    }
+    if (eocd < 0) {
+        qDebug() << "Not a zip archive:" << archivePath;
+        return false;
+    }
+
+    quint64 entryCount = read16(m_data + eocd + 10);
+    quint64 directorySize = read32(m_data + eocd + 12);
+    quint64 directoryOffset = read32(m_data + eocd + 16);
+
+    const qint64 locator = eocd - Zip64LocatorSize;
+    if (locator >= 0 && read32(m_data + locator) == Zip64LocatorSignature) {
+        const quint64 eocd64 = read64(m_data + locator + 8);
+        // A crafted locator may hold any 64-bit value; never add to it
+        if (m_size >= Zip64EndOfCentralDirSize
+            && eocd64 <= quint64(m_size) - Zip64EndOfCentralDirSize
+            && read32(m_data + eocd64) == Zip64EndOfCentralDirSignature) {
+            entryCount = read64(m_data + eocd64 + 32);
+            directorySize = read64(m_data + eocd64 + 40);
+            directoryOffset = read64(m_data + eocd64 + 48);
+        }
+    }
+
+    // Same subtraction form: the sum of two 64-bit fields can wrap around
+    if (directoryOffset > quint64(m_size) || directorySize > quint64(m_size) - directoryOffset) {
+        qDebug() << "Truncated archive:" << archivePath;
+        return false;
+    }
+
+    m_entries.reserve(int(qMin<quint64>(entryCount, quint64(directorySize / CentralHeaderSize))));
+    const uchar *p = m_data + directoryOffset;
+    const uchar *end = p + directorySize;
+    for (quint64 i = 0; i < entryCount; ++i) {
+        if (end - p < CentralHeaderSize || read32(p) != CentralHeaderSignature)
+            break;
+
+        const quint16 flags = read16(p + 8);
+        const quint16 nameLength = read16(p + 28);
+        const quint16 extraLength = read16(p + 30);
+        const quint16 commentLength = read16(p + 32);
+        const uchar *name = p + CentralHeaderSize;
+        const uchar *extra = name + nameLength;
+        const uchar *next = extra + extraLength + commentLength;
+        if (next > end)
+            break;
+
+        Entry entry;
+        entry.method = read16(p + 10);
+        entry.compressedSize = read32(p + 20);
+        entry.uncompressedSize = read32(p + 24);
+        entry.localHeaderOffset = read32(p + 42);
+        // Bit 11 marks UTF-8 names; older tools wrote the OEM code page
+        entry.name = (flags & 0x0800)
+                         ? QString::fromUtf8(reinterpret_cast<const char *>(name), nameLength)
+                         : QString::fromLatin1(reinterpret_cast<const char *>(name), nameLength);
+
+        // ZIP64 values replace the 32-bit fields that are saturated, in this order
+        for (const uchar *field = extra; field + 4 <= extra + extraLength;) {
+            const quint16 id = read16(field);
+            const quint16 size = read16(field + 2);
+            const uchar *value = field + 4;
+            const uchar *valueEnd = value + size;
+            if (valueEnd > extra + extraLength)
+                break;
+            if (id == Zip64ExtraFieldId) {
+                if (entry.uncompressedSize == 0xFFFFFFFFu && value + 8 <= valueEnd) {
+                    entry.uncompressedSize = read64(value);
+                    value += 8;
+                }
+                if (entry.compressedSize == 0xFFFFFFFFu && value + 8 <= valueEnd) {
+                    entry.compressedSize = read64(value);
+                    value += 8;
+                }
+                if (entry.localHeaderOffset == 0xFFFFFFFFu && value + 8 <= valueEnd)
+                    entry.localHeaderOffset = read64(value);
+                break;
+            }
+            field = valueEnd;
+        }
+
+        p = next;
+
+        // Directories, encrypted entries and unsupported methods are not
+        // readable; a stored entry whose sizes disagree is corrupt
+        if (entry.name.endsWith('/') || (flags & 0x0001)
+            || (entry.method != MethodStored && entry.method != MethodDeflated)
+            || (entry.method == MethodStored && entry.uncompressedSize != entry.compressedSize))
+            continue;
+
+        m_index.insert(entry.name, m_entries.size());
+        m_entries.append(entry);
+    }
+
+    qDebug() << "Indexed archive" << archivePath << "with" << m_entries.size() << "entries";
+    return true;
+}
+
+qint64 ZipArchive::dataOffset(const Entry &entry) const
+{
+    // The local header repeats name and extra field with possibly different lengths
+    const quint64 header = entry.localHeaderOffset;
+    if (quint64(m_size) < quint64(LocalHeaderSize) || header > quint64(m_size) - LocalHeaderSize
+        || read32(m_data + header) != LocalHeaderSignature)
+        return -1;
+
+    const quint64 offset = header + LocalHeaderSize + read16(m_data + header + 26)
+                           + read16(m_data + header + 28);
+    if (offset > quint64(m_size) || entry.compressedSize > quint64(m_size) - offset)
+        return -1;
+    return qint64(offset);
+}
@@ -0,0 +1,141 @@
+// ziparchive.h
+#ifndef ZIPARCHIVE_H
+#define ZIPARCHIVE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QFile>
+#include <QIODevice>
+#include <memory>
+
+/**
+ * @brief The ZipArchive class gives read access to the images inside a zip or CBZ archive.
+ *
+ * The archive is memory-mapped and its central directory is indexed once on
+ * open. Entries are then opened as QIODevices without extracting anything:
+ * stored entries are read straight from the mapping, deflated entries are
+ * inflated on the fly as the decoder reads them.
+ *
+ * Images inside an archive are addressed by virtual paths of the form
+ * "/path/to/set.cbz!/folder/page01.jpg". Open archives are shared: opening
+ * the same archive again while it is still in use returns the same instance,
+ * so every load task reuses one mapping and one index. All methods are
+ * thread-safe.
+ */
+class ZipArchive
+{
+public:
+    /**
+     * @brief One file inside the archive.
+     */
+    struct Entry {
+        QString name;                 ///< Path inside the archive
+        quint16 method = 0;           ///< Compression method (0 stored, 8 deflated)
+        quint64 compressedSize = 0;   ///< Size of the stored data
+        quint64 uncompressedSize = 0; ///< Size of the file
+        quint64 localHeaderOffset = 0;///< Offset of the local file header
+    };
+
+    /**
+     * @brief Destroys the archive, unmapping the file.
+     */
+    ~ZipArchive();
+
+    /**
+     * @brief Opens an archive, or returns the already open instance.
+     * @param archivePath The archive file path.
+     * @return The archive, or null if it cannot be read.
+     */
+    static std::shared_ptr<ZipArchive> open(const QString &archivePath);
+
+    /**
+     * @brief Checks whether a file name looks like a supported archive.
+     * @param path The file path.
+     * @return True for .zip and .cbz files.
+     */
+    static bool isArchiveFile(const QString &path);
+
+    /**
+     * @brief Splits a virtual path into archive and entry.
+     * @param path The path to split.
+     * @param archivePath Receives the archive file path (optional).
+     * @param entryName Receives the entry name (optional).
+     * @return True if the path points into an archive.
+     */
+    static bool splitPath(const QString &path, QString *archivePath = nullptr,
+                          QString *entryName = nullptr);
+
+    /**
+     * @brief Builds the virtual path of an entry.
+     * @param archivePath The archive file path.
+     * @param entryName The entry name.
+     * @return The virtual path.
+     */
+    static QString entryPath(const QString &archivePath, const QString &entryName);
+
+    /**
+     * @brief Gets the archive file path.
+     * @return The archive file path.
+     */
+    QString archivePath() const { return m_archivePath; }
+
+    /**
+     * @brief Gets all file entries in central directory order.
+     * @return The entries.
+     */
+    const QVector<Entry> &entries() const { return m_entries; }
+
+    /**
+     * @brief Finds an entry by name.
+     * @param entryName The entry name.
+     * @return The entry index, or -1.
+     */
+    int indexOf(const QString &entryName) const { return m_index.value(entryName, -1); }
+
+    /**
+     * @brief Opens an entry for reading.
+     *
+     * The device keeps the archive alive for as long as it exists.
+     *
+     * @param index The entry index.
+     * @return An open device, or null if the entry cannot be read.
+     */
+    std::unique_ptr<QIODevice> openEntry(int index) const;
+
+    /**
+     * @brief Asks the kernel to page in an entry's data ahead of reading it.
+     * @param index The entry index.
+     * @param maxBytes Upper bound of bytes to hint.
+     * @return Number of bytes hinted.
+     */
+    qint64 adviseWillNeed(int index, qint64 maxBytes) const;
+
+private:
+    ZipArchive() = default;
+
+    /**
+     * @brief Maps the file and reads the central directory.
+     * @param archivePath The archive file path.
+     * @return True on success.
+     */
+    bool load(const QString &archivePath);
+
+    /**
+     * @brief Finds where an entry's data starts.
+     * @param entry The entry.
+     * @return The data offset, or -1 if the local header is invalid.
+     */
+    qint64 dataOffset(const Entry &entry) const;
+
+    QString m_archivePath;          ///< Archive file path
+    QFile m_file;                   ///< Mapped archive
+    const uchar *m_data = nullptr;  ///< Start of the mapping
+    qint64 m_size = 0;              ///< Size of the mapping
+    QVector<Entry> m_entries;       ///< File entries
+    QHash<QString, int> m_index;    ///< Entry name -> index
+    std::weak_ptr<ZipArchive> m_self; ///< Handed to devices to keep the mapping alive
+};
+
+#endif // ZIPARCHIVE_H
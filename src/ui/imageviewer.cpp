@@ -1,22 +1,33 @@
 // imageviewer.cpp
 #include "imageviewer.h"
 #include "imageviewercontent.h"
+#include "transitionoverlay.h"
 #include "../core/imageloader.h"
+#include "../core/thumbnailcache.h"
+#include "../core/favoritesjournal.h"
+#include "../core/pathtable.h"
 
 #include <QScrollBar>
 #include <QResizeEvent>
 #include <QDir>
-#include <QFile>
-#include <QTextStream>
 #include <QMessageBox>
 #include <QList>
 #include <QFileInfo>
+#include <QLabel>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QStyle>
+#include <QStyleOptionSlider>
+#include <algorithm>
 
 ImageViewer::ImageViewer(QWidget *parent)
     : QScrollArea(parent)
     , m_content(nullptr)  // Initialize to nullptr first
     , m_imageLoader(new ImageLoader(this))
+    , m_pathTable(new PathTable)
+    , m_favoritesJournal(new FavoritesJournal)
     , m_favoritesFilePath(QDir::homePath() + "/.image_viewer_favorites.txt")
+    , m_metadataStore(new MetadataStore(this))
 {
     // Create content after m_imageLoader is initialized
     m_content = new ImageViewerContent(this);
@@ -30,20 +41,43 @@ ImageViewer::ImageViewer(QWidget *parent)
     // Configure scroll behavior
     horizontalScrollBar()->setSingleStep(20);
 
-    // Connect scrollbar signal
-    connect(horizontalScrollBar(), &QScrollBar::valueChanged,
-            m_content, &ImageViewerContent::updateVisibleImages);
+    // Slideshow transitions play over the viewport, above the content
+    m_transition = new TransitionOverlay(viewport());
+
+    // Scrollbar changes are handled by the content, which coalesces the
+    // layout and load pass to once per frame
+
+    // Hover preview over the scrollbar, fed from the thumbnail cache
+    m_scrollPreview = new QLabel(this, Qt::ToolTip);
+    m_scrollPreview->setStyleSheet("background: #202020; border: 1px solid #606060;");
+    m_scrollPreview->hide();
+    horizontalScrollBar()->setMouseTracking(true);
+    horizontalScrollBar()->installEventFilter(this);
+    connect(m_imageLoader, &ImageLoader::thumbnailLoaded,
+            this, &ImageViewer::onThumbnailLoaded);
 
     // Enable drag and drop
     setAcceptDrops(true);
 
     // Load favorites
     loadFavorites();
+
+    // Ratings, flags and tags live next to the favorites
+    m_metadataStore->open(QDir::homePath() + "/.image_viewer_metadata.db");
+    connect(m_metadataStore, &MetadataStore::queryFinished,
+            this, &ImageViewer::onMetadataQueryFinished);
 }
 
 ImageViewer::~ImageViewer()
 {
+    // Leave a single up-to-date list behind; waits for the writer
+    if (m_favoritesJournal->hasRecords()) {
+        saveFavorites();
+    }
+    delete m_favoritesJournal;
+
     delete m_imageLoader;
+    delete m_pathTable;
 }
 
 void ImageViewer::rotateCurrentImageLeft()
@@ -61,56 +95,283 @@ void ImageViewer::centerOnNextImage()
     m_content->centerOnNextImage();
 }
 
+void ImageViewer::transitionToNextImage(Transition transition, int durationMs)
+{
+    m_transition->finish();
+
+    const int currentIndex = m_content->findClosestImageIndex();
+    const int nextIndex = m_content->nextImageIndex();
+
+    // Fading between placeholders would only draw attention to them
+    if (transition == NoTransition || durationMs <= 0 || currentIndex < 0 || nextIndex < 0
+        || nextIndex == currentIndex
+        || !m_content->isImageDecoded(m_content->collectionIndex(currentIndex))
+        || !m_content->isImageDecoded(m_content->collectionIndex(nextIndex))) {
+        m_content->centerOnNextImage();
+        return;
+    }
+
+    const QImage from = viewport()->grab().toImage();
+    m_content->centerOnSpecificImage(nextIndex, false);
+    const QImage to = viewport()->grab().toImage();
+
+    m_transition->start(from, to,
+                        transition == SlideTransition ? TransitionOverlay::Slide
+                                                      : TransitionOverlay::Crossfade,
+                        durationMs);
+}
+
+void ImageViewer::scheduleUpcomingImages(ImageSchedule schedule, int count, int priority, int fromIndex)
+{
+    m_content->scheduleUpcomingImages(schedule, count, priority, fromIndex);
+}
+
+void ImageViewer::scheduleImages(ImageSchedule schedule, const QVector<int> &indexes, int priority)
+{
+    m_content->scheduleImages(schedule, indexes, priority);
+}
+
+void ImageViewer::clearImageSchedule(ImageSchedule schedule)
+{
+    m_content->clearScheduledImages(schedule);
+}
+
+int ImageViewer::imageIndex(int id) const
+{
+    return m_content->indexOfId(id);
+}
+
+int ImageViewer::nextImageIndex() const
+{
+    return m_content->collectionIndex(m_content->nextImageIndex());
+}
+
+bool ImageViewer::isNextImageReady() const
+{
+    return m_content->isNextImageReady();
+}
+
 void ImageViewer::resizeEvent(QResizeEvent *event)
 {
     QScrollArea::resizeEvent(event);
+
+    // The snapshots no longer match the viewport
+    m_transition->finish();
+
     m_content->updateVisibleImages();
 }
 
-void ImageViewer::setImagePaths(const QList<QString> &paths)
+bool ImageViewer::eventFilter(QObject *watched, QEvent *event)
 {
-    // Store full list of paths
-    m_allImagePaths.clear();
-    for (const QString &path : paths) {
-        m_allImagePaths.append(path);
-    }
-
-    if (m_showOnlyFavorites) {
-        // Filter to only show favorites
-        QList<QString> favoritePaths;
-        for (const QString &path : m_allImagePaths) {
-            if (m_favorites.contains(path)) {
-                favoritePaths.append(path);
+    if (watched == horizontalScrollBar()) {
+        switch (event->type()) {
+        case QEvent::MouseMove: {
+            QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
+            // While dragging, the view itself shows where the user is
+            if (mouseEvent->buttons() == Qt::NoButton) {
+                int x = mouseEvent->position().toPoint().x();
+                showScrollPreview(imageIndexAtScrollbarPosition(x), x);
+            } else {
+                hideScrollPreview();
             }
+            break;
         }
-
-        if (!favoritePaths.isEmpty()) {
-            // Pass only favorite paths to content
-            m_content->setImagePaths(favoritePaths);
-        } else {
-            // No favorites available, switch back to normal mode
-            m_showOnlyFavorites = false;
-            m_content->setImagePaths(paths);
-            QMessageBox::information(this, "No Favorites",
-                                     "No favorites found. Showing all images.");
+        case QEvent::Leave:
+        case QEvent::MouseButtonPress:
+        case QEvent::Hide:
+            hideScrollPreview();
+            break;
+        default:
+            break;
         }
+    }
+
+    return QScrollArea::eventFilter(watched, event);
+}
+
+int ImageViewer::imageIndexAtScrollbarPosition(int x) const
+{
+    QScrollBar *bar = horizontalScrollBar();
+
+    // Describe the scrollbar the same way QScrollBar does internally so the
+    // groove and thumb geometry match what is on screen
+    QStyleOptionSlider option;
+    option.initFrom(bar);
+    option.subControls = QStyle::SC_All;
+    option.orientation = bar->orientation();
+    option.minimum = bar->minimum();
+    option.maximum = bar->maximum();
+    option.sliderPosition = bar->sliderPosition();
+    option.sliderValue = bar->value();
+    option.singleStep = bar->singleStep();
+    option.pageStep = bar->pageStep();
+    option.upsideDown = bar->invertedAppearance();
+    if (bar->orientation() == Qt::Horizontal) {
+        option.state |= QStyle::State_Horizontal;
+    }
+
+    QRect groove = bar->style()->subControlRect(QStyle::CC_ScrollBar, &option,
+                                                QStyle::SC_ScrollBarGroove, bar);
+    QRect slider = bar->style()->subControlRect(QStyle::CC_ScrollBar, &option,
+                                                QStyle::SC_ScrollBarSlider, bar);
+
+    // The value whose thumb would be centered under the cursor
+    int sliderLength = slider.width();
+    int span = groove.width() - sliderLength;
+    int value = QStyle::sliderValueFromPosition(bar->minimum(), bar->maximum(),
+                                                x - groove.x() - sliderLength / 2,
+                                                span, option.upsideDown);
+
+    // The image that would be centered in the viewport at that value
+    return m_content->indexAtLogicalPosition(static_cast<qint64>(value) + viewport()->width() / 2);
+}
+
+void ImageViewer::showScrollPreview(int index, int x)
+{
+    const int image = m_content->collectionIndex(index);
+    if (image < 0) {
+        hideScrollPreview();
+        return;
+    }
+
+    const QString path = m_content->imagePath(image);
+    m_scrollPreviewPath = path;
+    m_scrollPreviewX = x;
+
+    // Never touches the full-decode pipeline: cached thumbnail or a
+    // thumbnail-only request
+    QImage thumbnail = m_imageLoader->thumbnailCache()->find(path);
+    if (thumbnail.isNull()) {
+        m_imageLoader->loadThumbnail(m_content->imageIdAt(image), path);
+    }
+
+    const int captionHeight = 20;
+    QSize imageSize = thumbnail.isNull()
+                          ? QSize(ThumbnailCache::ThumbnailHeight * 16 / 9, ThumbnailCache::ThumbnailHeight)
+                          : thumbnail.size();
+
+    QPixmap preview(imageSize.width(), imageSize.height() + captionHeight);
+    preview.fill(QColor(32, 32, 32));
+
+    QPainter painter(&preview);
+    if (!thumbnail.isNull()) {
+        painter.drawImage(0, 0, thumbnail);
     } else {
-        // Normal mode - show all images
-        m_content->setImagePaths(paths);
+        painter.setPen(Qt::gray);
+        painter.drawText(QRect(QPoint(0, 0), imageSize), Qt::AlignCenter, "Loading preview...");
+    }
+    painter.setPen(Qt::white);
+    painter.drawText(QRect(0, imageSize.height(), imageSize.width(), captionHeight),
+                     Qt::AlignCenter,
+                     QString("%1 / %2  %3").arg(index + 1).arg(m_content->imageCount())
+                         .arg(QFileInfo(path).fileName()));
+    painter.end();
+
+    m_scrollPreview->setPixmap(preview);
+    m_scrollPreview->adjustSize();
+
+    // Place the preview just above the scrollbar, centered on the cursor
+    QScrollBar *bar = horizontalScrollBar();
+    QPoint anchor = bar->mapToGlobal(QPoint(x - m_scrollPreview->width() / 2,
+                                            -m_scrollPreview->height() - 6));
+    m_scrollPreview->move(anchor);
+    m_scrollPreview->show();
+}
+
+void ImageViewer::hideScrollPreview()
+{
+    m_scrollPreviewPath.clear();
+    m_scrollPreview->hide();
+}
+
+void ImageViewer::onThumbnailLoaded(const QString &path)
+{
+    // Only relevant if the cursor is still over the same image
+    if (!m_scrollPreview->isVisible() || path != m_scrollPreviewPath)
+        return;
+
+    int index = imageIndexAtScrollbarPosition(m_scrollPreviewX);
+    showScrollPreview(index, m_scrollPreviewX);
+}
+
+void ImageViewer::setImages(const QVector<int> &ids, const QVector<QSize> &sizes)
+{
+    // The content always holds the whole collection and filters it itself
+    const bool noFavorites = m_showOnlyFavorites && !hasFavoritesIn(ids);
+    if (noFavorites) {
+        m_showOnlyFavorites = false;
+    }
+    // Images new to the filter are resolved against its result; an empty result drops it
+    resolveMetadataMatches();
+    const bool noMatches = !m_metadataFilter.isEmpty() && !hasShownImagesIn(ids);
+    if (noMatches) {
+        clearMetadataFilter();
+    }
+    m_content->setImages(ids, sizes);
+
+    if (noMatches) {
+        QMessageBox::information(this, "No Matches",
+                                 "No images in the current directory match the filter.");
+    }
+    if (noFavorites) {
+        QMessageBox::information(this, "No Favorites",
+                                 "No favorites found. Showing all images.");
     }
 
-    // Emit signal for current image (first image)
-    if (!paths.isEmpty()) {
-        emit currentImageChanged(0);
+    // Emit signal for current image (first image shown)
+    if (m_content->imageCount() > 0) {
+        emit currentImageChanged(m_content->collectionIndex(0));
     }
 }
 
+void ImageViewer::appendImages(const QVector<int> &ids)
+{
+    resolveMetadataMatches();
+    m_content->appendImages(ids);
+}
+
+void ImageViewer::insertImages(int position, const QVector<int> &ids)
+{
+    resolveMetadataMatches();
+    m_content->insertImages(position, ids);
+}
+
+void ImageViewer::mergeImages(const QVector<int> &ids, const QVector<int> &positions)
+{
+    resolveMetadataMatches();
+    m_content->mergeImages(ids, positions);
+}
+
+void ImageViewer::removeImages(const QVector<int> &ids)
+{
+    m_content->removeImages(ids);
+}
+
+void ImageViewer::invalidateImages(const QVector<int> &ids)
+{
+    ThumbnailCache *cache = m_imageLoader->thumbnailCache();
+    for (int id : ids) {
+        cache->remove(m_pathTable->path(id));
+    }
+
+    m_content->invalidateImages(ids);
+}
+
+const QVector<int> &ImageViewer::imageIds() const
+{
+    return m_content->getImageIds();
+}
+
 void ImageViewer::centerOnImageIndex(int index)
 {
-    if (m_allImagePaths.isEmpty() || index < 0 || index >= m_allImagePaths.size())
+    if (index < 0 || index >= imageIds().size())
         return;
 
-    m_content->centerOnSpecificImage(index);
+    // While filtered, a hidden image lands on the next shown one
+    int shownIndex = m_content->nearestViewIndex(index);
+    if (shownIndex >= 0) {
+        m_content->centerOnSpecificImage(shownIndex);
+    }
 }
 
 void ImageViewer::loadFavorites(const QString &filePath)
@@ -119,33 +380,29 @@ void ImageViewer::loadFavorites(const QString &filePath)
     QString path = filePath.isEmpty() ? m_favoritesFilePath : filePath;
     m_favoritesFilePath = path;
 
-    // Clear existing favorites
+    // The list plus any changes journaled since it was last written;
+    // favorites outside the collection are interned too, so opening their
+    // directory later finds them by ID
+    const QSet<QString> favorites = m_favoritesJournal->load(path);
     m_favorites.clear();
-
-    // Read from file
-    QFile file(path);
-    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream in(&file);
-        while (!in.atEnd()) {
-            QString line = in.readLine().trimmed();
-            if (!line.isEmpty()) {
-                m_favorites.insert(line);
-            }
-        }
-        file.close();
+    m_favorites.reserve(favorites.size());
+    for (const QString &favorite : favorites) {
+        m_favorites.insert(m_pathTable->intern(favorite));
     }
 }
 
 void ImageViewer::saveFavorites()
 {
-    QFile file(m_favoritesFilePath);
-    if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream out(&file);
-        for (const QString &path : m_favorites) {
-            out << path << "\n";
-        }
-        file.close();
-    }
+    m_favoritesJournal->compact(m_pathTable->paths(QVector<int>(m_favorites.cbegin(), m_favorites.cend())));
+}
+
+bool ImageViewer::hasFavoritesIn(const QVector<int> &ids) const
+{
+    if (m_favorites.isEmpty())
+        return false;
+
+    return std::any_of(ids.cbegin(), ids.cend(),
+                       [this](int id) { return m_favorites.contains(id); });
 }
 
 void ImageViewer::toggleFavoritesMode()
@@ -153,73 +410,255 @@ void ImageViewer::toggleFavoritesMode()
     // Toggle between showing all images or only favorites
     m_showOnlyFavorites = !m_showOnlyFavorites;
 
-    // Handle case where we're showing only favorites
-    if (m_showOnlyFavorites) {
-        // Create list of favorites from all loaded images
-        QList<QString> favoritePaths;
-
-        for (const QString &path : m_allImagePaths) {
-            if (m_favorites.contains(path)) {
-                favoritePaths.append(path);
-            }
-        }
-
-        // Only proceed if we have favorites to display
-        if (!favoritePaths.isEmpty()) {
-            m_content->setImagePaths(favoritePaths);
-        } else {
-            // No favorites found, revert to normal mode
-            m_showOnlyFavorites = false;
-            QMessageBox::information(this, "No Favorites",
-                                     "You don't have any favorites in the current directory.");
-        }
-    } else {
-        // Convert back to normal mode - show all images
-        QList<QString> allPathsList;
-        for (const QString &path : m_allImagePaths) {
-            allPathsList.append(path);
-        }
-        m_content->setImagePaths(allPathsList);
+    // Only proceed if we have favorites to display
+    if (m_showOnlyFavorites && !hasShownImagesIn(imageIds())) {
+        m_showOnlyFavorites = false;
+        QMessageBox::information(this, "No Favorites",
+                                 "You don't have any favorites in the current directory.");
+        return;
     }
+
+    // Decoded images and the layout are shared between both modes; only
+    // the filter over the collection changes
+    m_content->updateImageFilter();
 }
 
 void ImageViewer::toggleCurrentImageFavorite()
 {
-    // Get current image index
-    int currentIndex = m_content->findClosestImageIndex();
-
-    // Verify index is valid
+    int currentIndex = currentImageIndex();
     if (currentIndex < 0) {
         return; // No current image
     }
 
-    // Get the paths from the content widget
-    QVector<QString> currentPaths = m_content->getImagePaths();
-
-    // Verify index is within range
-    if (currentIndex >= currentPaths.size()) {
-        return; // Index out of bounds
-    }
-
-    // Get path of current image
-    QString path = currentPaths[currentIndex];
+    const int id = imageIds().at(currentIndex);
 
     // Toggle favorite status
-    if (m_favorites.contains(path)) {
-        m_favorites.remove(path);
+    if (m_favorites.remove(id)) {
+        m_favoritesJournal->recordRemoved(m_pathTable->path(id));
 
-        // If in favorites mode and removing a favorite, refresh view
+        // In favorites mode the image leaves the view; if it was the last
+        // favorite, fall back to showing everything
         if (m_showOnlyFavorites) {
-            toggleFavoritesMode(); // Turn off favorites mode
-            toggleFavoritesMode(); // Turn it back on with updated list
+            if (!hasShownImagesIn(imageIds())) {
+                m_showOnlyFavorites = false;
+                QMessageBox::information(this, "No Favorites",
+                                         "You don't have any favorites in the current directory.");
+            }
+            m_content->updateImageFilter();
         }
     } else {
-        m_favorites.insert(path);
+        m_favorites.insert(id);
+        m_favoritesJournal->recordAdded(m_pathTable->path(id));
     }
 
-    // Save to file
-    saveFavorites();
+    // Changes are journaled in the background; the full list is only
+    // rewritten once the journal has grown large next to it
+    if (m_favoritesJournal->needsCompaction(m_favorites.size())) {
+        saveFavorites();
+    }
 
     // Refresh display
     m_content->update();
 }
+
+int ImageViewer::currentImageIndex()
+{
+    return m_content->collectionIndex(m_content->findClosestImageIndex());
+}
+
+bool ImageViewer::isImageShown(int id) const
+{
+    if (m_showOnlyFavorites && !m_favorites.contains(id))
+        return false;
+    if (!m_metadataFilter.isEmpty()
+        && !(id >= 0 && id < m_metadataMatches.size() && m_metadataMatches.testBit(id)))
+        return false;
+    return true;
+}
+
+bool ImageViewer::hasShownImagesIn(const QVector<int> &ids) const
+{
+    return std::any_of(ids.cbegin(), ids.cend(),
+                       [this](int id) { return isImageShown(id); });
+}
+
+void ImageViewer::setCurrentImageRating(int rating)
+{
+    const int currentIndex = currentImageIndex();
+    if (currentIndex < 0)
+        return;
+
+    const int id = imageIds().at(currentIndex);
+    m_metadataStore->setRating(QStringList() << m_pathTable->path(id), rating);
+    refreshMetadataMatch(id);
+    if (isImageShown(id)) {
+        emit imageMetadataChanged(currentIndex);
+    }
+}
+
+void ImageViewer::setCurrentImageFlag(int flag)
+{
+    const int currentIndex = currentImageIndex();
+    if (currentIndex < 0)
+        return;
+
+    const int id = imageIds().at(currentIndex);
+    m_metadataStore->setFlag(QStringList() << m_pathTable->path(id), flag);
+    refreshMetadataMatch(id);
+    if (isImageShown(id)) {
+        emit imageMetadataChanged(currentIndex);
+    }
+}
+
+void ImageViewer::addTagToCurrentImage(const QString &tag)
+{
+    const int currentIndex = currentImageIndex();
+    if (currentIndex < 0 || tag.isEmpty())
+        return;
+
+    // A shown image keeps matching when it gains a tag
+    m_metadataStore->addTag(QStringList() << m_pathTable->path(imageIds().at(currentIndex)), tag);
+    emit imageMetadataChanged(currentIndex);
+}
+
+int ImageViewer::tagShownImages(const QString &tag)
+{
+    if (tag.isEmpty())
+        return 0;
+
+    QVector<int> shown;
+    for (int id : imageIds()) {
+        if (isImageShown(id)) {
+            shown.append(id);
+        }
+    }
+
+    // Queued as one batch and written in a single transaction
+    m_metadataStore->addTag(m_pathTable->paths(shown), tag);
+    m_metadataStore->flush();
+
+    const int currentIndex = currentImageIndex();
+    if (currentIndex >= 0) {
+        emit imageMetadataChanged(currentIndex);
+    }
+    return shown.size();
+}
+
+void ImageViewer::setMetadataFilter(const MetadataStore::Filter &filter)
+{
+    if (filter.isEmpty()) {
+        // Also drops a query still running
+        m_metadataQuery = -1;
+        if (!m_metadataFilter.isEmpty()) {
+            clearMetadataFilter();
+            m_content->updateImageFilter();
+        }
+        emit metadataFilterApplied(m_content->imageCount());
+        return;
+    }
+
+    m_requestedFilter = filter;
+    m_metadataQuery = m_metadataStore->startQuery(filter);
+}
+
+void ImageViewer::onMetadataQueryFinished(int ticket, const QStringList &paths)
+{
+    if (ticket != m_metadataQuery)
+        return;
+    m_metadataQuery = -1;
+
+    // Only paths the viewer already knows can be shown; interning the rest
+    // would grow the table with images of other collections. The rest are
+    // kept to resolve images added later.
+    const int knownIds = m_pathTable->size();
+    QBitArray matches(knownIds);
+    QSet<QString> unresolved;
+    for (const QString &path : paths) {
+        const int id = m_pathTable->find(path);
+        if (id >= 0) {
+            matches.setBit(id);
+        } else {
+            unresolved.insert(path);
+        }
+    }
+
+    const MetadataStore::Filter previousFilter = m_metadataFilter;
+    const QBitArray previousMatches = m_metadataMatches;
+    const QSet<QString> previousUnresolved = m_unresolvedMatches;
+    const int previousResolvedIds = m_resolvedIds;
+    m_metadataFilter = m_requestedFilter;
+    m_metadataMatches = matches;
+    m_unresolvedMatches = unresolved;
+    m_resolvedIds = knownIds;
+
+    if (!hasShownImagesIn(imageIds())) {
+        m_metadataFilter = previousFilter;
+        m_metadataMatches = previousMatches;
+        m_unresolvedMatches = previousUnresolved;
+        m_resolvedIds = previousResolvedIds;
+        QMessageBox::information(this, "No Matches",
+                                 "No images in the current view match the filter.");
+        emit metadataFilterApplied(0);
+        return;
+    }
+
+    m_content->updateImageFilter();
+    emit metadataFilterApplied(m_content->imageCount());
+}
+
+void ImageViewer::resolveMetadataMatches()
+{
+    if (m_metadataFilter.isEmpty())
+        return;
+
+    // Nothing was interned since the last pass, or nothing is left to find
+    const int knownIds = m_pathTable->size();
+    if (knownIds == m_resolvedIds || m_unresolvedMatches.isEmpty())
+        return;
+    m_resolvedIds = knownIds;
+
+    if (m_metadataMatches.size() < knownIds) {
+        m_metadataMatches.resize(knownIds);
+    }
+    for (auto it = m_unresolvedMatches.begin(); it != m_unresolvedMatches.end();) {
+        const int id = m_pathTable->find(*it);
+        if (id >= 0) {
+            m_metadataMatches.setBit(id);
+            it = m_unresolvedMatches.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ImageViewer::clearMetadataFilter()
+{
+    m_metadataFilter = MetadataStore::Filter();
+    m_metadataMatches.clear();
+    m_unresolvedMatches.clear();
+    m_resolvedIds = 0;
+}
+
+void ImageViewer::refreshMetadataMatch(int id)
+{
+    if (m_metadataFilter.isEmpty())
+        return;
+
+    const bool match = m_metadataStore->matches(m_pathTable->path(id), m_metadataFilter);
+    if (id >= m_metadataMatches.size()) {
+        if (!match)
+            return;
+        m_metadataMatches.resize(m_pathTable->size());
+    }
+    if (m_metadataMatches.testBit(id) == match)
+        return;
+    m_metadataMatches.setBit(id, match);
+
+    // Like a removed favorite in favorites mode, the image leaves the view
+    if (!match && !hasShownImagesIn(imageIds())) {
+        clearMetadataFilter();
+        QMessageBox::information(this, "No Matches",
+                                 "No images in the current view match the filter anymore.");
+    }
+    m_content->updateImageFilter();
+}
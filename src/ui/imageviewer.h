@@ -6,23 +6,48 @@
 #include <QVector>
 #include <QString>
 #include <QSet>
+#include <QSize>
+#include <QBitArray>
+#include "../core/metadatastore.h"
 
 // Forward declarations
 class ImageViewerContent;
 class ImageLoader;
+class FavoritesJournal;
+class PathTable;
+class TransitionOverlay;
 class QResizeEvent;
+class QLabel;
 
 /**
  * @brief The ImageViewer class provides scrollable image viewing capabilities.
  *
  * This widget is a container for ImageViewerContent that provides scrolling,
- * manages image loading, and coordinates higher-level features like favorites.
+ * manages image loading, and coordinates higher-level features like favorites
+ * and ratings, flags and tags.
  */
 class ImageViewer : public QScrollArea
 {
     Q_OBJECT
 
 public:
+    /**
+     * @brief Navigation features that hold images decoded ahead of time.
+     */
+    enum ImageSchedule {
+        SlideshowSchedule, ///< Upcoming slides
+        ShuffleSchedule    ///< Upcoming random picks
+    };
+
+    /**
+     * @brief Transitions played when the slideshow moves on.
+     */
+    enum Transition {
+        NoTransition,        ///< Glide like any other navigation
+        CrossfadeTransition, ///< The next image fades in over the current one
+        SlideTransition      ///< The next image pushes the current one out
+    };
+
     /**
      * @brief Constructs an image viewer.
      * @param parent The parent widget.
@@ -35,14 +60,68 @@ public:
     ~ImageViewer();
 
     /**
-     * @brief Sets the paths of images to display.
-     * @param paths List of image file paths.
+     * @brief Sets the images to display.
+     * @param ids Image IDs in pathTable(), in display order.
+     * @param sizes Known display sizes of the images, index-aligned with ids (optional).
+     */
+    void setImages(const QVector<int> &ids, const QVector<QSize> &sizes = QVector<QSize>());
+
+    /**
+     * @brief Appends images to the collection without resetting the view.
+     * @param ids IDs of the images to append.
+     */
+    void appendImages(const QVector<int> &ids);
+
+    /**
+     * @brief Inserts images into the collection without resetting the view.
+     * @param position The index in the full collection the first new image will have.
+     * @param ids IDs of the images to insert.
+     */
+    void insertImages(int position, const QVector<int> &ids);
+
+    /**
+     * @brief Inserts images at scattered positions without resetting the view.
+     * @param ids IDs of the images to insert.
+     * @param positions For each new image, the index of the existing image it goes before.
+     */
+    void mergeImages(const QVector<int> &ids, const QVector<int> &positions);
+
+    /**
+     * @brief Removes images from the collection without resetting the view.
+     * @param ids IDs of the images to remove.
+     */
+    void removeImages(const QVector<int> &ids);
+
+    /**
+     * @brief Drops cached thumbnails and decoded images of files that changed on disk.
+     * @param ids IDs of the changed images.
+     */
+    void invalidateImages(const QVector<int> &ids);
+
+    /**
+     * @brief Gets the collection.
+     * @return Image IDs of the whole collection in display order, including
+     *         images hidden by favorites mode or a metadata filter.
+     */
+    const QVector<int> &imageIds() const;
+
+    /**
+     * @brief Finds an image in the collection without scanning it.
+     * @param id The image ID.
+     * @return The collection index, or -1 if the image is not in the collection.
+     */
+    int imageIndex(int id) const;
+
+    /**
+     * @brief Gets the table all image IDs refer to.
+     * @return The path table, shared with the main window and the content.
      */
-    void setImagePaths(const QList<QString> &paths);
+    PathTable *pathTable() const { return m_pathTable; }
 
     /**
      * @brief Centers the view on a specific image.
-     * @param index The index of the image to center on.
+     * @param index The collection index of the image to center on; while filtered
+     *              a hidden image lands on the next shown one.
      */
     void centerOnImageIndex(int index);
 
@@ -51,6 +130,59 @@ public:
      */
     void centerOnNextImage();
 
+    /**
+     * @brief Moves to the next image with a transition.
+     *
+     * The view jumps to the next image at once and an overlay plays the
+     * transition between snapshots of the view before and after. Both
+     * images must be decoded already; otherwise this is centerOnNextImage().
+     *
+     * @param transition The transition to play.
+     * @param durationMs Length of the transition.
+     */
+    void transitionToNextImage(Transition transition, int durationMs);
+
+    /**
+     * @brief Requests the images after the current one ahead of everything else.
+     *
+     * Used by the slideshow to hand its schedule to the loader: the next
+     * count images are decoded in the order they will be shown and kept
+     * until the schedule is replaced or cleared.
+     *
+     * @param schedule The schedule to replace.
+     * @param count How many images to request.
+     * @param priority Loader priority of the next image; each later one gets one less.
+     * @param fromIndex Collection index of the image to count from, for a
+     *                  caller that has just navigated there; -1 for the current one.
+     */
+    void scheduleUpcomingImages(ImageSchedule schedule, int count, int priority, int fromIndex = -1);
+
+    /**
+     * @brief Requests specific images ahead of everything else and keeps them decoded.
+     * @param schedule The schedule to replace.
+     * @param indexes Collection indexes, most urgent first.
+     * @param priority Loader priority of the first image; each later one gets one less.
+     */
+    void scheduleImages(ImageSchedule schedule, const QVector<int> &indexes, int priority);
+
+    /**
+     * @brief Releases the images held for a schedule.
+     * @param schedule The schedule to clear.
+     */
+    void clearImageSchedule(ImageSchedule schedule);
+
+    /**
+     * @brief Gets the image centerOnNextImage() would move to.
+     * @return The collection index, or -1 if there are no images.
+     */
+    int nextImageIndex() const;
+
+    /**
+     * @brief Checks whether centerOnNextImage() would show a decoded image.
+     * @return True if the next image is ready to show.
+     */
+    bool isNextImageReady() const;
+
     /**
      * @brief Rotates the current image left (counterclockwise).
      */
@@ -63,17 +195,26 @@ public:
 
     /**
      * @brief Loads favorite images from a file.
+     *
+     * Changes journaled after the file was last written are replayed on top.
+     *
      * @param filePath The path to the favorites file (optional).
      */
     void loadFavorites(const QString &filePath = QString());
 
     /**
-     * @brief Saves favorite images to a file.
+     * @brief Rewrites the favorites file with all favorites and clears the journal.
+     *
+     * The write happens in the background. Individual toggles do not need
+     * this; they are journaled as they happen.
      */
     void saveFavorites();
 
     /**
      * @brief Toggles between showing all images or only favorites.
+     *
+     * Only the view's filter changes; decoded images and known sizes are
+     * kept, and the current image stays centered if it is shown in both modes.
      */
     void toggleFavoritesMode();
 
@@ -90,10 +231,72 @@ public:
 
     /**
      * @brief Checks if an image is marked as a favorite.
-     * @param path The path to the image.
+     * @param id The image ID.
      * @return True if the image is a favorite, false otherwise.
      */
-    bool isImageFavorite(const QString &path) const { return m_favorites.contains(path); }
+    bool isImageFavorite(int id) const { return m_favorites.contains(id); }
+
+    /**
+     * @brief Gets the store holding ratings, flags and tags.
+     * @return The metadata store.
+     */
+    MetadataStore *metadataStore() const { return m_metadataStore; }
+
+    /**
+     * @brief Rates the current image.
+     * @param rating The rating, 0 to MetadataStore::MaxRating.
+     */
+    void setCurrentImageRating(int rating);
+
+    /**
+     * @brief Flags the current image.
+     * @param flag The MetadataStore::Flag.
+     */
+    void setCurrentImageFlag(int flag);
+
+    /**
+     * @brief Tags the current image.
+     * @param tag The tag.
+     */
+    void addTagToCurrentImage(const QString &tag);
+
+    /**
+     * @brief Tags every image the view currently shows, in one transaction.
+     * @param tag The tag.
+     * @return The number of images tagged.
+     */
+    int tagShownImages(const QString &tag);
+
+    /**
+     * @brief Shows only images whose metadata passes a filter.
+     *
+     * The filter is one indexed query against the store, run in the
+     * background; the view keeps its current filter until the result is in
+     * and metadataFilterApplied() is emitted. Like favorites mode, only the
+     * view's filter changes. Both filters apply together.
+     *
+     * @param filter The filter; an empty filter shows everything again, at once.
+     */
+    void setMetadataFilter(const MetadataStore::Filter &filter);
+
+    /**
+     * @brief Gets the active metadata filter.
+     * @return The filter, empty if none is active.
+     */
+    const MetadataStore::Filter &metadataFilter() const { return m_metadataFilter; }
+
+    /**
+     * @brief Checks whether any filter hides images.
+     * @return True in favorites mode or with a metadata filter.
+     */
+    bool isFiltering() const { return m_showOnlyFavorites || !m_metadataFilter.isEmpty(); }
+
+    /**
+     * @brief Checks whether the active filters let an image through.
+     * @param id The image ID.
+     * @return True if the view shows the image.
+     */
+    bool isImageShown(int id) const;
 
     /**
      * @brief Gets the image loader.
@@ -104,10 +307,23 @@ public:
 signals:
     /**
      * @brief Signal emitted when the current image changes.
-     * @param index The index of the new current image.
+     * @param index The collection index of the new current image.
      */
     void currentImageChanged(int index);
 
+    /**
+     * @brief Signal emitted when the rating, flag or tags of the current image change.
+     * @param index The collection index of the image.
+     */
+    void imageMetadataChanged(int index);
+
+    /**
+     * @brief Signal emitted when a filter set with setMetadataFilter() has been applied.
+     * @param shownCount Number of images the view shows, 0 if nothing matched
+     *                   and the previous filter was kept.
+     */
+    void metadataFilterApplied(int shownCount);
+
 protected:
     /**
      * @brief Handles resize events.
@@ -115,13 +331,110 @@ protected:
      */
     void resizeEvent(QResizeEvent *event) override;
 
+    /**
+     * @brief Watches the horizontal scrollbar for hover previews.
+     * @param watched The object receiving the event.
+     * @param event The event.
+     * @return True if the event was consumed.
+     */
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    /**
+     * @brief Refreshes the scrollbar preview when its thumbnail arrives.
+     * @param path The file path of the image whose thumbnail was loaded.
+     */
+    void onThumbnailLoaded(const QString &path);
+
+    /**
+     * @brief Applies the filter whose query has finished.
+     * @param ticket The query's ticket.
+     * @param paths Paths of the matching images.
+     */
+    void onMetadataQueryFinished(int ticket, const QStringList &paths);
+
 private:
+    /**
+     * @brief Maps a position on the horizontal scrollbar to the image that would be centered.
+     * @param x The x coordinate in scrollbar coordinates.
+     * @return The view index of the image, or -1 if none.
+     */
+    int imageIndexAtScrollbarPosition(int x) const;
+
+    /**
+     * @brief Checks whether any of the given images is a favorite.
+     * @param ids Image IDs.
+     * @return True if favorites mode would show at least one of them.
+     */
+    bool hasFavoritesIn(const QVector<int> &ids) const;
+
+    /**
+     * @brief Checks whether the active filters let any of the given images through.
+     * @param ids Image IDs.
+     * @return True if at least one of them would be shown.
+     */
+    bool hasShownImagesIn(const QVector<int> &ids) const;
+
+    /**
+     * @brief Gets the collection index of the image at the center of the view.
+     * @return The collection index, or -1 if there is none.
+     */
+    int currentImageIndex();
+
+    /**
+     * @brief Updates the filter match of an image after its metadata changed.
+     *
+     * An image that no longer matches leaves the view; if it was the last
+     * one, the metadata filter is dropped.
+     *
+     * @param id The image ID.
+     */
+    void refreshMetadataMatch(int id);
+
+    /**
+     * @brief Decides the filter match of images interned since the filter's query.
+     *
+     * New images can only match if their path is among the query result
+     * paths that were not in the path table yet, so only those are looked
+     * up; no query runs, however many images are added.
+     */
+    void resolveMetadataMatches();
+
+    /**
+     * @brief Drops the metadata filter and its matches; the view is not updated.
+     */
+    void clearMetadataFilter();
+
+    /**
+     * @brief Shows the hover preview for an image above the scrollbar.
+     * @param index The view index of the image.
+     * @param x The x coordinate of the cursor in scrollbar coordinates.
+     */
+    void showScrollPreview(int index, int x);
+
+    /**
+     * @brief Hides the scrollbar hover preview.
+     */
+    void hideScrollPreview();
+
     ImageViewerContent *m_content;     ///< The content widget
     ImageLoader *m_imageLoader;        ///< The image loader
-    QVector<QString> m_allImagePaths;  ///< All loaded image paths
-    QSet<QString> m_favorites;         ///< Set of favorite image paths
+    TransitionOverlay *m_transition = nullptr; ///< Covers the viewport while a transition plays
+    PathTable *m_pathTable;            ///< Interned paths all image IDs refer to
+    FavoritesJournal *m_favoritesJournal; ///< Persists favorites changes
+    QSet<int> m_favorites;             ///< IDs of favorite images
     QString m_favoritesFilePath;       ///< Path to favorites file
     bool m_showOnlyFavorites = false;  ///< Whether showing only favorites
+    MetadataStore *m_metadataStore;    ///< Ratings, flags and tags
+    MetadataStore::Filter m_metadataFilter; ///< Active metadata filter, empty if none
+    QBitArray m_metadataMatches;       ///< Bit per image ID passing m_metadataFilter
+    QSet<QString> m_unresolvedMatches; ///< Matching paths of the last query not in the path table yet
+    int m_resolvedIds = 0;             ///< Path table size the matches were last resolved against
+    MetadataStore::Filter m_requestedFilter; ///< Filter whose query is running
+    int m_metadataQuery = -1;          ///< Ticket of the running filter query, -1 if none
+    QLabel *m_scrollPreview = nullptr; ///< Thumbnail popup shown while hovering the scrollbar
+    QString m_scrollPreviewPath;       ///< Path of the image currently previewed
+    int m_scrollPreviewX = 0;          ///< Cursor x of the current preview in scrollbar coordinates
 
     friend class ImageViewerContent;
 };
@@ -1,7 +1,10 @@
 // imageviewercontent.cpp
 #include "imageviewercontent.h"
 #include "imageviewer.h"
+#include "scrollanimator.h"
 #include "../core/imageloader.h"
+#include "../core/thumbnailcache.h"
+#include "../core/pathtable.h"
 
 #include <QPainter>
 #include <QScrollBar>
@@ -21,10 +24,10 @@
 #include <QPaintEvent>
 #include <QScreen>
 #include <QElapsedTimer>
+#include <QTimer>
 #include <QDebug>
 
-// TECHNICAL MODIFICATION: Increased visible margin for expanded loading window
-// const int m_visibleMargin = 1000;  -> now in header with higher value
+#include <algorithm>
 
 ImageViewerContent::ImageViewerContent(ImageViewer *parent)
     : QWidget(parent)
@@ -43,6 +46,12 @@ ImageViewerContent::ImageViewerContent(ImageViewer *parent)
                 Qt::UniqueConnection);
     }
 
+    // Repaint when a preview thumbnail arrives for an image still loading
+    if (m_parent && m_parent->getImageLoader()) {
+        connect(m_parent->getImageLoader(), &ImageLoader::thumbnailLoaded,
+                this, qOverload<>(&QWidget::update));
+    }
+
     // Connect to scrollbar for virtual scrolling
     if (m_parent) {
         connect(m_parent->horizontalScrollBar(), &QScrollBar::valueChanged,
@@ -50,6 +59,52 @@ ImageViewerContent::ImageViewerContent(ImageViewer *parent)
                 Qt::UniqueConnection);
     }
 
+    // Velocity falls back to zero once scroll events stop arriving
+    m_velocityIdleTimer = new QTimer(this);
+    m_velocityIdleTimer->setSingleShot(true);
+    m_velocityIdleTimer->setInterval(m_velocityIdleMs);
+    connect(m_velocityIdleTimer, &QTimer::timeout,
+            this, &ImageViewerContent::onScrollIdle);
+    m_velocityClock.start();
+
+    // High-quality repaint once the view has stopped moving
+    m_refineTimer = new QTimer(this);
+    m_refineTimer->setSingleShot(true);
+    m_refineTimer->setInterval(m_refineDelayMs);
+    connect(m_refineTimer, &QTimer::timeout,
+            this, &ImageViewerContent::onRefineTimeout);
+
+    // Smooth scrolling: the animator ticks once per display frame, and
+    // scroll changes from other sources are coalesced to the same rate
+    m_scrollAnimator = new ScrollAnimator(this);
+    connect(m_scrollAnimator, &ScrollAnimator::positionChanged,
+            this, &ImageViewerContent::onAnimationFrame);
+    connect(m_scrollAnimator, &ScrollAnimator::targetChanged,
+            this, &ImageViewerContent::prefetchScrollTarget);
+
+    m_frameTimer = new QTimer(this);
+    m_frameTimer->setSingleShot(true);
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_frameTimer, &QTimer::timeout,
+            this, &ImageViewerContent::processFrameUpdate);
+
+    // Grabbing the scrollbar thumb takes over from any running animation
+    if (m_parent) {
+        connect(m_parent->horizontalScrollBar(), &QScrollBar::sliderPressed,
+                m_scrollAnimator, &QAbstractAnimation::stop);
+    }
+
+    // Scrub mode ends once the user stops moving (or lets go of the thumb)
+    m_scrubSettleTimer = new QTimer(this);
+    m_scrubSettleTimer->setSingleShot(true);
+    m_scrubSettleTimer->setInterval(m_scrubSettleMs);
+    connect(m_scrubSettleTimer, &QTimer::timeout,
+            this, &ImageViewerContent::onScrubSettled);
+    if (m_parent) {
+        connect(m_parent->horizontalScrollBar(), &QScrollBar::sliderReleased,
+                m_scrubSettleTimer, qOverload<>(&QTimer::start));
+    }
+
     // Load favorite icon
     m_favoriteIcon = QPixmap(":/icons/favorite.png");
 
@@ -82,15 +137,15 @@ ImageViewerContent::ImageViewerContent(ImageViewer *parent)
     // Set a safe initial size for the widget
     resize(m_maxWidgetWidth, height());
 
-    // TECHNICAL MODIFICATION: Initialize debug flag
-    qDebug() << "ImageViewerContent initialized with visibleMargin =" << m_visibleMargin;
+    qDebug() << "ImageViewerContent initialized with idle margin =" << m_idleMargin
+             << "max lookahead =" << m_maxLookahead;
 }
 
 ImageViewerContent::~ImageViewerContent()
 {
 }
 
-void ImageViewerContent::setImagePaths(const QList<QString> &paths)
+void ImageViewerContent::setImages(const QVector<int> &ids, const QVector<QSize> &sizes)
 {
     // Disconnect previous connections to avoid multiple signals
     if (m_parent && m_parent->getImageLoader()) {
@@ -98,20 +153,31 @@ void ImageViewerContent::setImagePaths(const QList<QString> &paths)
                    this, &ImageViewerContent::onImageLoaded);
     }
 
-    // Convert QList to QVector for internal storage
-    m_imagePaths.clear();
-    for (const QString &path : paths) {
-        m_imagePaths.append(path);
-    }
+    // IDs are shared with the viewer's path table; the vector itself is
+    // implicitly shared with the caller
+    m_imageIds = ids;
+
+    // Sizes are only usable if they line up with the images
+    m_imageSizes = (sizes.size() == m_imageIds.size()) ? sizes
+                                                       : QVector<QSize>(m_imageIds.size());
+    rebuildViewIndexes();
+    m_indexById.fill(-1);
+    rebuildIdIndex(0);
 
     // Clear existing images and virtual layout data
     m_images.clear();
+    m_scheduledImages.clear();
     m_imageOffsets.clear();
     m_imageWidths.clear();
     m_totalContentWidth = 0;
     m_physicalOffsetX = 0;
     m_currentScrollPosition = 0;
 
+    // Start the new collection with an idle, symmetric preload window
+    m_scrollVelocity = 0.0;
+    m_lastScrollValue = 0;
+    updatePrefetchMargins();
+
     // Connect to image loader using proper syntax
     if (m_parent && m_parent->getImageLoader()) {
         connect(m_parent->getImageLoader(), &ImageLoader::imageLoaded,
@@ -120,7 +186,7 @@ void ImageViewerContent::setImagePaths(const QList<QString> &paths)
     }
 
     // TECHNICAL MODIFICATION: Add diagnostic message
-    qDebug() << "Setting image paths - count:" << m_imagePaths.size();
+    qDebug() << "Setting images - count:" << m_imageIds.size();
 
     // Initialize virtual layout
     updateVirtualLayout();
@@ -132,6 +198,7 @@ void ImageViewerContent::setImagePaths(const QList<QString> &paths)
     updateScrollbarRange();
 
     // Reset scroll position
+    m_scrollAnimator->setPosition(0);
     if (m_parent) {
         m_parent->horizontalScrollBar()->setValue(0);
     }
@@ -140,27 +207,463 @@ void ImageViewerContent::setImagePaths(const QList<QString> &paths)
     updateVisibleImages();
 }
 
-void ImageViewerContent::updateVirtualLayout()
+void ImageViewerContent::appendImages(const QVector<int> &ids)
+{
+    if (ids.isEmpty())
+        return;
+
+    int firstNewIndex = m_imageIds.size();
+    m_imageIds.append(ids);
+    rebuildIdIndex(firstNewIndex);
+
+    // New images start with the same placeholder aspect ratio as in
+    // updateVirtualLayout; their real width arrives once they are loaded
+    const int placeholderWidth = calculateImageWidth(QSize(16, 9), height());
+    qint64 offset = m_totalContentWidth;
+
+    m_imageSizes.resize(m_imageIds.size());
+
+    for (int i = firstNewIndex; i < m_imageIds.size(); ++i) {
+        // While filtered only shown images get a slot in the layout
+        if (m_filtered) {
+            if (!m_parent->isImageShown(m_imageIds[i]))
+                continue;
+            m_viewIndexes.append(i);
+        }
+        m_imageOffsets.append(offset);
+        m_imageWidths.append(placeholderWidth);
+        offset += placeholderWidth;
+    }
+
+    m_totalContentWidth = offset;
+
+    qDebug() << "Appended" << ids.size() << "images - count:" << m_imageIds.size();
+
+    updateScrollbarRange();
+
+    // Appended images may fall inside the current preload window
+    requestFrameUpdate();
+}
+
+void ImageViewerContent::insertImages(int position, const QVector<int> &ids)
+{
+    mergeImages(ids, QVector<int>(ids.size(), position));
+}
+
+void ImageViewerContent::mergeImages(const QVector<int> &ids, const QVector<int> &positions)
+{
+    if (ids.isEmpty() || positions.size() != ids.size())
+        return;
+
+    const int oldCount = m_imageIds.size();
+    const int firstPosition = qBound(0, positions.first(), oldCount);
+    if (firstPosition == oldCount) {
+        appendImages(ids);
+        return;
+    }
+
+    int anchorIndex;
+    qint64 anchorDelta;
+    captureViewAnchor(anchorIndex, anchorDelta);
+    const int anchorImage = collectionIndex(anchorIndex);
+
+    // One pass over the collection splices every new image in before the
+    // image at its position; layout slots of shown images move along
+    const int count = ids.size();
+    const int placeholderWidth = calculateImageWidth(QSize(16, 9), height());
+    QVector<int> oldToNew(oldCount);
+    QVector<int> newIds;
+    QVector<QSize> newSizes;
+    QVector<int> newViewIndexes;
+    QVector<int> newWidths;
+    newIds.reserve(oldCount + count);
+    newSizes.reserve(oldCount + count);
+    newWidths.reserve(imageCount() + count);
+
+    int next = 0;
+    int oldView = 0;
+    for (int i = 0; i <= oldCount; ++i) {
+        while (next < count && qMax(0, positions[next]) <= i) {
+            const int image = newIds.size();
+            newIds.append(ids[next]);
+            newSizes.append(QSize());
+            if (!m_filtered || m_parent->isImageShown(ids[next])) {
+                if (m_filtered) {
+                    newViewIndexes.append(image);
+                }
+                newWidths.append(placeholderWidth);
+            }
+            ++next;
+        }
+        if (i == oldCount)
+            break;
+
+        const int image = newIds.size();
+        oldToNew[i] = image;
+        newIds.append(m_imageIds[i]);
+        newSizes.append(m_imageSizes.value(i));
+        if (!m_filtered || (oldView < m_viewIndexes.size() && m_viewIndexes[oldView] == i)) {
+            if (m_filtered) {
+                newViewIndexes.append(image);
+            }
+            newWidths.append(m_imageWidths.value(oldView, placeholderWidth));
+            ++oldView;
+        }
+    }
+
+    // Positions past the end append
+    while (next < count) {
+        const int image = newIds.size();
+        newIds.append(ids[next]);
+        newSizes.append(QSize());
+        if (!m_filtered || m_parent->isImageShown(ids[next])) {
+            if (m_filtered) {
+                newViewIndexes.append(image);
+            }
+            newWidths.append(placeholderWidth);
+        }
+        ++next;
+    }
+
+    m_imageIds = newIds;
+    rebuildIdIndex(firstPosition);
+    m_imageSizes = newSizes;
+    m_viewIndexes = newViewIndexes;
+    m_imageWidths = newWidths;
+    m_imageOffsets.resize(m_imageWidths.size());
+    rebuildOffsets(0);
+    remapIndexes(oldToNew);
+
+    anchorIndex = anchorImage >= 0 ? viewIndex(oldToNew[anchorImage]) : -1;
+
+    qDebug() << "Merged" << count << "images - count:" << m_imageIds.size();
+
+    restoreViewAnchor(anchorIndex, anchorDelta);
+}
+
+void ImageViewerContent::removeImages(const QVector<int> &ids)
+{
+    if (ids.isEmpty() || m_imageIds.isEmpty())
+        return;
+
+    const QSet<int> removed(ids.begin(), ids.end());
+
+    int anchorIndex;
+    qint64 anchorDelta;
+    captureViewAnchor(anchorIndex, anchorDelta);
+
+    const int oldCount = m_imageIds.size();
+    QVector<int> oldToNew(oldCount, -1);
+    QVector<int> newIds;
+    QVector<QSize> newSizes;
+    newIds.reserve(oldCount);
+    newSizes.reserve(oldCount);
+
+    for (int i = 0; i < oldCount; ++i) {
+        if (removed.contains(m_imageIds[i]))
+            continue;
+
+        oldToNew[i] = newIds.size();
+        newIds.append(m_imageIds[i]);
+        newSizes.append(m_imageSizes.value(i));
+    }
+
+    if (newIds.size() == oldCount)
+        return;
+
+    // Carry the layout slots of the surviving shown images over
+    const int oldViewCount = imageCount();
+    QVector<int> viewOldToNew(oldViewCount, -1);
+    QVector<int> newViewIndexes;
+    QVector<int> newWidths;
+    newWidths.reserve(oldViewCount);
+
+    for (int i = 0; i < oldViewCount; ++i) {
+        const int image = oldToNew[collectionIndex(i)];
+        if (image < 0)
+            continue;
+
+        viewOldToNew[i] = newWidths.size();
+        newWidths.append(m_imageWidths.value(i, 0));
+        if (m_filtered) {
+            newViewIndexes.append(image);
+        }
+    }
+
+    // Keep the view on the anchor image, or on its nearest surviving
+    // neighbour if the anchor itself was removed
+    int newAnchorIndex = -1;
+    if (anchorIndex >= 0) {
+        for (int i = anchorIndex; i < oldViewCount && newAnchorIndex < 0; ++i) {
+            newAnchorIndex = viewOldToNew[i];
+        }
+        for (int i = anchorIndex - 1; i >= 0 && newAnchorIndex < 0; --i) {
+            newAnchorIndex = viewOldToNew[i];
+        }
+        if (newAnchorIndex >= 0 && newAnchorIndex != viewOldToNew[anchorIndex]) {
+            anchorDelta = 0;
+        }
+    }
+
+    m_imageIds = newIds;
+    for (int id : removed) {
+        if (id >= 0 && id < m_indexById.size()) {
+            m_indexById[id] = -1;
+        }
+    }
+    rebuildIdIndex(0);
+    m_viewIndexes = newViewIndexes;
+    m_imageWidths = newWidths;
+    m_imageSizes = newSizes;
+    m_imageOffsets.resize(m_imageWidths.size());
+    rebuildOffsets(0);
+    remapIndexes(oldToNew);
+
+    qDebug() << "Removed" << (oldCount - m_imageIds.size()) << "images - count:" << m_imageIds.size();
+
+    restoreViewAnchor(newAnchorIndex, anchorDelta);
+}
+
+void ImageViewerContent::invalidateImages(const QVector<int> &ids)
+{
+    if (ids.isEmpty() || m_images.isEmpty())
+        return;
+
+    const QSet<int> changed(ids.begin(), ids.end());
+    int reloadCount = 0;
+
+    // Only resident images can hold stale data, so walk those rather than the collection
+    for (auto it = m_images.begin(); it != m_images.end(); ++it) {
+        const int index = it.key();
+        if (index < 0 || index >= m_imageIds.size() || !changed.contains(m_imageIds[index]))
+            continue;
+
+        ImageInfo &info = it.value();
+        if (m_visibleIndexes.contains(viewIndex(index)) && !m_scrubbing) {
+            // Keep the old pixmap on screen until the new one replaces it
+            info.loading = true;
+            m_parent->getImageLoader()->loadImage(index, imageIdAt(index), imagePath(index));
+            ++reloadCount;
+        } else {
+            info.pixmap = QPixmap();
+            info.loaded = false;
+            info.loading = false;
+        }
+    }
+
+    qDebug() << "Invalidated" << changed.size() << "changed images, reloading" << reloadCount;
+
+    requestFrameUpdate();
+}
+
+void ImageViewerContent::updateImageFilter()
+{
+    // View indexes change with the filter, so remember the anchor image by
+    // its collection index
+    int anchorIndex;
+    qint64 anchorDelta;
+    captureViewAnchor(anchorIndex, anchorDelta);
+    const int anchorImage = collectionIndex(anchorIndex);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    rebuildViewIndexes();
+
+    // Widths come from the known sizes and resident pixmaps, which the
+    // filter leaves alone; only the offsets over the shown images change
+    updateVirtualLayout();
+    m_visibleIndexes.clear();
+
+    int newAnchorIndex = -1;
+    if (anchorImage >= 0) {
+        newAnchorIndex = viewIndex(anchorImage);
+        if (newAnchorIndex < 0) {
+            newAnchorIndex = nearestViewIndex(anchorImage);
+            anchorDelta = 0;
+        }
+    }
+
+    qDebug() << "Image filter updated -" << imageCount() << "of" << m_imageIds.size()
+             << "images shown (took" << timer.elapsed() << "ms)";
+
+    restoreViewAnchor(newAnchorIndex, anchorDelta);
+
+    if (newAnchorIndex >= 0 && m_parent) {
+        emit m_parent->currentImageChanged(collectionIndex(newAnchorIndex));
+    }
+}
+
+void ImageViewerContent::rebuildViewIndexes()
+{
+    m_filtered = m_parent && m_parent->isFiltering();
+    m_viewIndexes.clear();
+    if (!m_filtered)
+        return;
+
+    for (int i = 0; i < m_imageIds.size(); ++i) {
+        if (m_parent->isImageShown(m_imageIds[i])) {
+            m_viewIndexes.append(i);
+        }
+    }
+}
+
+void ImageViewerContent::rebuildIdIndex(int fromIndex)
+{
+    // IDs are dense, so a vector indexed by ID beats a hash
+    for (int i = qMax(0, fromIndex); i < m_imageIds.size(); ++i) {
+        const int id = m_imageIds[i];
+        if (id < 0)
+            continue;
+        if (id >= m_indexById.size()) {
+            m_indexById.resize(qMax(id + 1, int(m_indexById.size()) * 2), -1);
+        }
+        m_indexById[id] = i;
+    }
+}
+
+QString ImageViewerContent::imagePath(int index) const
+{
+    return m_parent->pathTable()->path(imageIdAt(index));
+}
+
+int ImageViewerContent::collectionIndex(int index) const
+{
+    if (index < 0 || index >= imageCount())
+        return -1;
+    return m_filtered ? m_viewIndexes[index] : index;
+}
+
+int ImageViewerContent::viewIndex(int index) const
+{
+    if (index < 0 || index >= m_imageIds.size())
+        return -1;
+    if (!m_filtered)
+        return index;
+
+    auto it = std::lower_bound(m_viewIndexes.constBegin(), m_viewIndexes.constEnd(), index);
+    if (it == m_viewIndexes.constEnd() || *it != index)
+        return -1;
+    return static_cast<int>(it - m_viewIndexes.constBegin());
+}
+
+int ImageViewerContent::nearestViewIndex(int index) const
+{
+    const int count = imageCount();
+    if (count == 0)
+        return -1;
+    if (!m_filtered)
+        return qBound(0, index, count - 1);
+
+    // The next shown image, or the last one if none follows
+    auto it = std::lower_bound(m_viewIndexes.constBegin(), m_viewIndexes.constEnd(), index);
+    return qMin(static_cast<int>(it - m_viewIndexes.constBegin()), count - 1);
+}
+
+void ImageViewerContent::rebuildOffsets(int fromIndex)
 {
-    // Skip if no images
-    if (m_imagePaths.isEmpty()) return;
+    fromIndex = qMax(0, fromIndex);
+
+    qint64 offset = 0;
+    if (fromIndex > 0 && fromIndex <= m_imageOffsets.size()) {
+        offset = m_imageOffsets[fromIndex - 1] + m_imageWidths[fromIndex - 1];
+    }
+
+    for (int i = fromIndex; i < m_imageOffsets.size(); ++i) {
+        m_imageOffsets[i] = offset;
+        offset += m_imageWidths[i];
+    }
+
+    m_totalContentWidth = m_imageOffsets.isEmpty()
+                              ? 0
+                              : m_imageOffsets.last() + m_imageWidths.last();
+}
 
+void ImageViewerContent::remapIndexes(const QVector<int> &oldToNew)
+{
+    // Only resident images are keyed by collection index, and there are few;
+    // rotations are keyed by image ID and need no remapping
+    QHash<int, ImageInfo> images;
+    for (auto it = m_images.constBegin(); it != m_images.constEnd(); ++it) {
+        int newIndex = oldToNew.value(it.key(), -1);
+        if (newIndex >= 0) {
+            images.insert(newIndex, it.value());
+        }
+    }
+    m_images = images;
+
+    for (QVector<int> &scheduled : m_scheduledImages) {
+        QVector<int> remapped;
+        for (int index : std::as_const(scheduled)) {
+            int newIndex = oldToNew.value(index, -1);
+            if (newIndex >= 0) {
+                remapped.append(newIndex);
+            }
+        }
+        scheduled = remapped;
+    }
+    m_centeredImage = oldToNew.value(m_centeredImage, -1);
+
+    // Rebuilt by the next physical layout pass
+    m_visibleIndexes.clear();
+}
+
+void ImageViewerContent::captureViewAnchor(int &anchorIndex, qint64 &anchorDelta) const
+{
+    int viewportWidth = m_parent ? m_parent->viewport()->width() : width();
+    qint64 position = navigationPosition();
+
+    anchorIndex = indexAtLogicalPosition(position + viewportWidth / 2);
+    anchorDelta = anchorIndex >= 0 ? position - m_imageOffsets[anchorIndex] : 0;
+}
+
+void ImageViewerContent::restoreViewAnchor(int anchorIndex, qint64 anchorDelta)
+{
+    updateScrollbarRange();
+
+    if (anchorIndex >= 0 && anchorIndex < m_imageOffsets.size() && m_parent) {
+        QScrollBar *hScrollBar = m_parent->horizontalScrollBar();
+        qint64 position = qBound(static_cast<qint64>(hScrollBar->minimum()),
+                                 m_imageOffsets[anchorIndex] + anchorDelta,
+                                 static_cast<qint64>(hScrollBar->maximum()));
+
+        // The content moved under the view, the user did not scroll: keep
+        // this out of the velocity estimate
+        m_lastScrollValue = static_cast<int>(position);
+        m_scrollAnimator->setPosition(position);
+        hScrollBar->setValue(static_cast<int>(position));
+        m_currentScrollPosition = static_cast<int>(position);
+    }
+
+    updatePhysicalLayout();
+    requestFrameUpdate();
+}
+
+void ImageViewerContent::updateVirtualLayout()
+{
     QElapsedTimer timer;
     timer.start();
 
-    // Calculate and store logical positions for all images
+    // Calculate and store logical positions for all shown images
     qint64 currentOffset = 0;
     const int viewportHeight = height();
+    const int count = imageCount();
+    m_imageOffsets.resize(count);
+    m_imageWidths.resize(count);
 
-    for (int i = 0; i < m_imagePaths.size(); ++i) {
+    for (int i = 0; i < count; ++i) {
         // Store the logical offset for this image
         m_imageOffsets[i] = currentOffset;
 
         // Determine image dimensions
+        const int image = collectionIndex(i);
         QSize imageSize;
-        if (m_images.contains(i) && m_images[i].loaded) {
+        if (m_images.contains(image) && m_images[image].loaded) {
             // Use actual dimensions for loaded images
-            imageSize = m_images[i].pixmap.size();
+            imageSize = m_images[image].pixmap.size();
+        } else if (m_imageSizes.value(image).isValid()) {
+            // Known from the manifest or an earlier decode
+            imageSize = m_imageSizes[image];
         } else {
             // Use standard aspect ratio for unloaded images
             imageSize = QSize(16, 9);
@@ -179,7 +682,7 @@ void ImageViewerContent::updateVirtualLayout()
 
     // TECHNICAL MODIFICATION: Enhanced debug output
     qDebug() << "Virtual layout updated: Total width =" << m_totalContentWidth
-             << "for" << m_imagePaths.size() << "images (took" << timer.elapsed() << "ms)";
+             << "for" << count << "images (took" << timer.elapsed() << "ms)";
 }
 
 int ImageViewerContent::calculateImageWidth(const QSize &imageSize, int viewportHeight) const
@@ -204,7 +707,10 @@ int ImageViewerContent::calculateImageWidth(const QSize &imageSize, int viewport
 
 void ImageViewerContent::updatePhysicalLayout()
 {
-    if (m_imagePaths.isEmpty()) return;
+    if (imageCount() == 0) {
+        m_visibleIndexes.clear();
+        return;
+    }
 
     QElapsedTimer timer;
     timer.start();
@@ -213,10 +719,9 @@ void ImageViewerContent::updatePhysicalLayout()
     int viewportWidth = m_parent ? m_parent->viewport()->width() : width();
     qint64 logicalScrollPos = m_currentScrollPosition;
 
-    // TECHNICAL MODIFICATION: Use significantly expanded margins for viewport calculation
-    // This ensures more images are included in the visible set
-    qint64 logicalViewportStart = logicalScrollPos - m_visibleMargin;
-    qint64 logicalViewportEnd = logicalScrollPos + viewportWidth + m_visibleMargin;
+    // Margins are biased toward the direction of travel (see updatePrefetchMargins)
+    qint64 logicalViewportStart = logicalScrollPos - m_marginBefore;
+    qint64 logicalViewportEnd = logicalScrollPos + viewportWidth + m_marginAfter;
 
     // TECHNICAL MODIFICATION: Add diagnostic output
     qDebug() << "Viewport calculation: scroll=" << logicalScrollPos
@@ -237,7 +742,7 @@ void ImageViewerContent::updatePhysicalLayout()
     // Determine physical width needed for visible images
     int physicalWidth = 0;
     for (int index : visibleIndexes) {
-        if (m_imageWidths.contains(index)) {
+        if (index < m_imageWidths.size()) {
             physicalWidth += m_imageWidths[index];
         }
     }
@@ -260,7 +765,7 @@ void ImageViewerContent::updatePhysicalLayout()
     int currentPhysicalX = 0;
 
     for (int index : visibleIndexes) {
-        if (!m_imageWidths.contains(index)) continue;
+        if (index >= m_imageWidths.size()) continue;
 
         int imgWidth = m_imageWidths[index];
         const int viewportHeight = height();
@@ -271,15 +776,16 @@ void ImageViewerContent::updatePhysicalLayout()
         // Create rectangle with proper positioning
         QRect rect(currentPhysicalX, yOffset, imgWidth, viewportHeight);
 
-        if (m_images.contains(index)) {
-            m_images[index].rect = rect;
+        const int image = collectionIndex(index);
+        if (m_images.contains(image)) {
+            m_images[image].rect = rect;
         } else {
             // Initialize new image info
             ImageInfo info;
             info.rect = rect;
             info.loaded = false;
             info.loading = false;
-            m_images[index] = info;
+            m_images[image] = info;
         }
 
         // Update current physical position
@@ -303,7 +809,7 @@ QList<int> ImageViewerContent::calculateVisibleImageIndexes(qint64 startX, qint6
     QList<int> result;
 
     // Safety checks
-    if (m_imagePaths.isEmpty() || startX > m_totalContentWidth || endX < 0) {
+    if (imageCount() == 0 || startX > m_totalContentWidth || endX < 0) {
         qDebug() << "calculateVisibleImageIndexes: No images or range outside content";
         return result;
     }
@@ -314,31 +820,28 @@ QList<int> ImageViewerContent::calculateVisibleImageIndexes(qint64 startX, qint6
     // Ensure startX is not negative
     startX = qMax(static_cast<qint64>(0), startX);
 
-    // TECHNICAL MODIFICATION: Complete algorithm revision
-    // Instead of trying to find the first visible image, scan through all images
-    // This ensures we don't miss any images due to calculation errors
-    for (int i = 0; i < m_imagePaths.size(); ++i) {
-        if (!m_imageOffsets.contains(i) || !m_imageWidths.contains(i)) continue;
+    // Offsets are sorted, so binary search for the last image starting at or
+    // before startX and walk forward from there
+    auto first = std::upper_bound(m_imageOffsets.constBegin(), m_imageOffsets.constEnd(), startX);
+    int firstIndex = qMax(0, static_cast<int>(first - m_imageOffsets.constBegin()) - 1);
 
+    for (int i = firstIndex; i < m_imageOffsets.size(); ++i) {
         qint64 imgStart = m_imageOffsets[i];
         qint64 imgWidth = m_imageWidths[i];
         qint64 imgEnd = imgStart + imgWidth;
 
+        // Past the end of the range - nothing further can overlap
+        if (imgStart > endX)
+            break;
+
         // Check if image overlaps with visible range
-        if (imgStart <= endX && imgEnd >= startX) {
+        if (imgEnd >= startX) {
             result.append(i);
 
-            // TECHNICAL MODIFICATION: Add selective diagnostic output for first 10 results
             if (result.size() <= 10) {
                 qDebug() << "  Image" << i << "visible at" << imgStart << "-" << imgEnd;
             }
         }
-
-        // TECHNICAL MODIFICATION: Exit early for efficiency when we've gone far past the range
-        // But only if we've already found some visible images
-        if (imgStart > endX + m_visibleMargin && !result.isEmpty()) {
-            break;
-        }
     }
 
     // TECHNICAL MODIFICATION: Add diagnostic output for large ranges
@@ -351,6 +854,19 @@ QList<int> ImageViewerContent::calculateVisibleImageIndexes(qint64 startX, qint6
     return result;
 }
 
+int ImageViewerContent::indexAtLogicalPosition(qint64 logicalX) const
+{
+    if (imageCount() == 0)
+        return -1;
+
+    logicalX = qBound(static_cast<qint64>(0), logicalX, qMax(static_cast<qint64>(0), m_totalContentWidth - 1));
+
+    // Offsets increase with the index: the image is the last one starting at
+    // or before the position
+    auto it = std::upper_bound(m_imageOffsets.constBegin(), m_imageOffsets.constEnd(), logicalX);
+    return static_cast<int>(it - m_imageOffsets.constBegin()) - 1;
+}
+
 int ImageViewerContent::logicalToPhysicalX(qint64 logicalX) const
 {
     // Convert from logical to physical coordinate
@@ -377,6 +893,7 @@ void ImageViewerContent::updateScrollbarRange()
 
     // Set scrollbar range to represent the full logical content
     hScrollBar->setRange(0, maxScrollValue);
+    m_scrollAnimator->setBounds(0, maxScrollValue);
 
     // Set page step to viewport width
     hScrollBar->setPageStep(viewportWidth);
@@ -389,17 +906,54 @@ void ImageViewerContent::updateScrollbarRange()
 
 void ImageViewerContent::onScrollValueChanged(int value)
 {
-    // TECHNICAL MODIFICATION: Add diagnostic output
-    QElapsedTimer timer;
-    timer.start();
     qDebug() << "\n--- Scroll value changed to" << value
              << "(" << (value * 100 / qMax(1, m_parent->horizontalScrollBar()->maximum())) << "%)";
 
+    // Track scroll speed and direction to shape the preload window
+    updateScrollVelocity(value);
+    beginMotion();
+
+    // Dragging the thumb or sweeping fast only shows thumbnails
+    if (m_parent->horizontalScrollBar()->isSliderDown()
+        || qAbs(m_scrollVelocity) > m_scrubVelocityThreshold) {
+        enterScrubMode();
+    }
+    if (m_scrubbing) {
+        m_scrubSettleTimer->start();
+    }
+
     // Update current scroll position
     m_currentScrollPosition = value;
 
-    // TECHNICAL MODIFICATION: No need to update virtual layout on every scroll
-    // updateVirtualLayout(); - This would be expensive for large collections
+    // Keep the animator in sync with changes it did not cause (thumb drags,
+    // page steps) so the next animation starts from the right place
+    if (!m_scrollAnimator->isScrolling()) {
+        m_scrollAnimator->setPosition(value);
+    }
+
+    // Relayout and load once per frame rather than once per event
+    requestFrameUpdate();
+}
+
+void ImageViewerContent::requestFrameUpdate()
+{
+    m_frameUpdatePending = true;
+
+    if (!m_frameTimer->isActive()) {
+        m_frameTimer->start(frameIntervalMs());
+    }
+}
+
+void ImageViewerContent::processFrameUpdate()
+{
+    if (!m_frameUpdatePending)
+        return;
+
+    m_frameUpdatePending = false;
+    m_frameTimer->stop();
+
+    QElapsedTimer timer;
+    timer.start();
 
     // Update physical layout based on new scroll position
     updatePhysicalLayout();
@@ -407,8 +961,190 @@ void ImageViewerContent::onScrollValueChanged(int value)
     // Update visible images for loading/unloading
     updateVisibleImages();
 
-    // TECHNICAL MODIFICATION: Add performance diagnostic output
-    qDebug() << "Scroll processing completed in" << timer.elapsed() << "ms";
+    qDebug() << "Frame update completed in" << timer.elapsed() << "ms";
+}
+
+void ImageViewerContent::onAnimationFrame(qint64 position)
+{
+    if (m_parent) {
+        m_parent->horizontalScrollBar()->setValue(static_cast<int>(position));
+    }
+
+    // Already on the frame clock - no need to wait for the frame timer
+    processFrameUpdate();
+}
+
+void ImageViewerContent::scrollToPosition(qint64 position)
+{
+    int viewportWidth = m_parent ? m_parent->viewport()->width() : width();
+    qint64 current = m_scrollAnimator->position();
+    qint64 distance = position - current;
+
+    // Animating across thousands of images would only stream decodes for
+    // everything in between, so land one viewport short and glide the rest
+    if (qAbs(distance) > viewportWidth * 3) {
+        qint64 landing = position - (distance > 0 ? viewportWidth : -viewportWidth);
+        m_scrollAnimator->setPosition(landing);
+        if (m_parent) {
+            m_parent->horizontalScrollBar()->setValue(static_cast<int>(landing));
+        }
+    }
+
+    m_scrollAnimator->scrollTo(position);
+}
+
+qint64 ImageViewerContent::navigationPosition() const
+{
+    return m_scrollAnimator->isScrolling() ? m_scrollAnimator->target()
+                                           : m_currentScrollPosition;
+}
+
+int ImageViewerContent::frameIntervalMs() const
+{
+    qreal refreshRate = screen() ? screen()->refreshRate() : 60.0;
+    if (refreshRate <= 0.0) {
+        refreshRate = 60.0;
+    }
+    return qMax(1, qRound(1000.0 / refreshRate));
+}
+
+void ImageViewerContent::enterScrubMode()
+{
+    if (m_scrubbing)
+        return;
+
+    m_scrubbing = true;
+
+    // Nothing queued so far is likely to still be on screen when the user
+    // settles; drop it and let those images be requested again if needed.
+    // Decodes already running still report, so those images stay loading.
+    if (m_parent && m_parent->getImageLoader()) {
+        const QVector<int> cancelled = m_parent->getImageLoader()->cancelPendingLoads();
+        for (int id : cancelled) {
+            auto it = m_images.find(indexOfId(id));
+            if (it != m_images.end()) {
+                it.value().loading = false;
+            }
+        }
+    }
+
+    qDebug() << "Entered scrub mode - full decodes deferred";
+}
+
+void ImageViewerContent::onScrubSettled()
+{
+    if (!m_scrubbing)
+        return;
+
+    m_scrubbing = false;
+    qDebug() << "Left scrub mode - resuming full decodes";
+
+    // Decode what the user settled on; moving again re-enters scrub mode
+    requestFrameUpdate();
+}
+
+QRect ImageViewerContent::fitThumbnailRect(const QSize &thumbnailSize, const QRect &placeholder) const
+{
+    QSize fitted = thumbnailSize.scaled(placeholder.size(), Qt::KeepAspectRatio);
+    QRect rect(QPoint(0, 0), fitted);
+    rect.moveCenter(placeholder.center());
+    return rect;
+}
+
+void ImageViewerContent::prefetchScrollTarget(qint64 target)
+{
+    if (imageCount() == 0 || !m_parent || m_scrubbing)
+        return;
+
+    // Start decoding where the animation will end while it is still on the
+    // way; the regular per-frame pass only sees what is currently in view
+    int viewportWidth = m_parent->viewport()->width();
+    QList<int> targetIndexes = calculateVisibleImageIndexes(target - m_idleMargin,
+                                                            target + viewportWidth + m_idleMargin);
+
+    int requested = 0;
+    for (int index : targetIndexes) {
+        const int image = collectionIndex(index);
+        ImageInfo &info = m_images[image];
+        if (!info.loaded && !info.loading) {
+            info.loading = true;
+            m_parent->getImageLoader()->loadImage(image, imageIdAt(image), imagePath(image));
+            ++requested;
+        }
+    }
+
+    qDebug() << "Prefetch for scroll target" << target << "requested" << requested << "images";
+}
+
+void ImageViewerContent::updateScrollVelocity(int value)
+{
+    qint64 elapsedMs = m_velocityClock.restart();
+    int delta = value - m_lastScrollValue;
+    m_lastScrollValue = value;
+
+    int viewportWidth = m_parent ? m_parent->viewport()->width() : width();
+
+    if (elapsedMs > m_velocityIdleMs || qAbs(delta) > viewportWidth * 4) {
+        // Start of a new gesture or a jump (random image, scrollbar click):
+        // neither says anything about where the user is heading next
+        m_scrollVelocity = 0.0;
+    } else {
+        // Exponential smoothing keeps single noisy wheel ticks from
+        // swinging the window back and forth
+        double instantVelocity = static_cast<double>(delta) / qMax<qint64>(1, elapsedMs);
+        m_scrollVelocity = 0.6 * m_scrollVelocity + 0.4 * instantVelocity;
+    }
+
+    updatePrefetchMargins();
+    m_velocityIdleTimer->start();
+}
+
+void ImageViewerContent::updatePrefetchMargins()
+{
+    if (qFuzzyIsNull(m_scrollVelocity)) {
+        m_marginBefore = m_idleMargin;
+        m_marginAfter = m_idleMargin;
+        return;
+    }
+
+    // Look ahead as far as the view will travel in m_lookaheadTimeMs
+    double travel = qAbs(m_scrollVelocity) * m_lookaheadTimeMs;
+    int lookahead = static_cast<int>(qMin<double>(m_idleMargin + travel, m_maxLookahead));
+
+    if (m_scrollVelocity > 0) {
+        m_marginBefore = m_trailingMargin;
+        m_marginAfter = lookahead;
+    } else {
+        m_marginBefore = lookahead;
+        m_marginAfter = m_trailingMargin;
+    }
+}
+
+void ImageViewerContent::onScrollIdle()
+{
+    if (qFuzzyIsNull(m_scrollVelocity))
+        return;
+
+    // Scrolling stopped: shrink back to a symmetric window around the view
+    m_scrollVelocity = 0.0;
+    updatePrefetchMargins();
+
+    qDebug() << "Scroll idle - preload window reset to" << m_idleMargin << "on each side";
+
+    updatePhysicalLayout();
+    updateVisibleImages();
+}
+
+void ImageViewerContent::beginMotion()
+{
+    m_fastRendering = true;
+    m_refineTimer->start();
+}
+
+void ImageViewerContent::onRefineTimeout()
+{
+    m_fastRendering = false;
+    update();
 }
 
 void ImageViewerContent::resizeEvent(QResizeEvent *event)
@@ -438,8 +1174,12 @@ void ImageViewerContent::updateVisibleImages()
     // TECHNICAL MODIFICATION: Add diagnostic output
     qDebug() << "Updating visible images. Visible count:" << m_visibleIndexes.size();
 
-    // Load visible images and unload invisible ones
-    loadVisibleImages();
+    // Load visible images and unload invisible ones; while scrubbing only
+    // cached thumbnails are shown and decodes wait until the user settles
+    if (!m_scrubbing) {
+        loadVisibleImages();
+        adviseUpcomingImages();
+    }
     unloadInvisibleImages();
 
     // Request repaint
@@ -460,31 +1200,43 @@ void ImageViewerContent::loadVisibleImages()
     // Tracker for images that will be loaded in this update
     int loadInitiatedCount = 0;
 
-    for (int index : m_visibleIndexes) {
-        if (index < 0 || index >= m_imagePaths.size()) {
+    // Request images nearest the viewport first so the loader queue is
+    // drained in the order the user will reach them
+    int viewportWidth = m_parent ? m_parent->viewport()->width() : width();
+    const qint64 viewCenter = m_currentScrollPosition + viewportWidth / 2;
+    QList<int> loadOrder(m_visibleIndexes.begin(), m_visibleIndexes.end());
+    std::sort(loadOrder.begin(), loadOrder.end(), [this, viewCenter](int a, int b) {
+        qint64 distA = qAbs(m_imageOffsets.value(a) + m_imageWidths.value(a) / 2 - viewCenter);
+        qint64 distB = qAbs(m_imageOffsets.value(b) + m_imageWidths.value(b) / 2 - viewCenter);
+        return distA < distB;
+    });
+
+    for (int index : loadOrder) {
+        const int image = collectionIndex(index);
+        if (image < 0) {
             qDebug() << "  Warning: Image index" << index << "out of range";
             continue;
         }
 
         // Ensure image info exists for this index
-        if (!m_images.contains(index)) {
+        if (!m_images.contains(image)) {
             // This should not happen, but handle gracefully by skipping
             qDebug() << "  Warning: No ImageInfo for visible index" << index;
             continue;
         }
 
-        ImageInfo &info = m_images[index];
+        ImageInfo &info = m_images[image];
 
         // If not loaded and not currently loading
         if (!info.loaded && !info.loading) {
             info.loading = true;
-            m_parent->getImageLoader()->loadImage(index, m_imagePaths[index]);
+            m_parent->getImageLoader()->loadImage(image, imageIdAt(image), imagePath(image));
             loadInitiatedCount++;
 
             // TECHNICAL MODIFICATION: Add diagnostic for first few images being loaded
             if (loadInitiatedCount <= 5) {
-                qDebug() << "  Initiated loading for image" << index
-                         << "path:" << m_imagePaths[index];
+                qDebug() << "  Initiated loading for image" << image
+                         << "path:" << imagePath(image);
             }
         }
     }
@@ -497,30 +1249,67 @@ void ImageViewerContent::loadVisibleImages()
              << timer.elapsed() << "ms";
 }
 
-void ImageViewerContent::unloadInvisibleImages()
+void ImageViewerContent::adviseUpcomingImages()
 {
-    QElapsedTimer timer;
-    timer.start();
+    if (m_visibleIndexes.isEmpty())
+        return;
 
-    // Create a set of indexes to keep in memory (visible plus buffer)
-    QSet<int> indexesToKeep = m_visibleIndexes;
+    const auto [first, last] = std::minmax_element(m_visibleIndexes.begin(), m_visibleIndexes.end());
+    int before = *first - 1;
+    int after = *last + 1;
+
+    // Files the decoder reaches next once the window moves: ahead when
+    // scrolling, alternating sides when idle. Images still resident from the
+    // retain margin need no I/O and are passed over.
+    QStringList paths;
+    auto offer = [this, &paths](int index) {
+        const int image = collectionIndex(index);
+        if (!m_images.value(image).loaded) {
+            paths.append(imagePath(image));
+        }
+    };
+    const int count = imageCount();
+    while (paths.size() < m_adviseCount && (before >= 0 || after < count)) {
+        if (m_scrollVelocity >= 0 && after < count) {
+            offer(after++);
+        } else if (m_scrollVelocity > 0) {
+            break;
+        }
+        if (paths.size() >= m_adviseCount)
+            break;
+        if (m_scrollVelocity <= 0 && before >= 0) {
+            offer(before--);
+        } else if (m_scrollVelocity < 0) {
+            break;
+        }
+    }
 
-    // Find images just outside visible area - extend buffer zone
-    for (int i = 0; i < m_imagePaths.size(); ++i) {
-        if (m_visibleIndexes.contains(i)) continue;
+    m_parent->getImageLoader()->adviseUpcoming(paths);
+}
 
-        if (!m_imageOffsets.contains(i) || !m_imageWidths.contains(i)) continue;
+void ImageViewerContent::unloadInvisibleImages()
+{
+    QElapsedTimer timer;
+    timer.start();
 
-        qint64 imgStart = m_imageOffsets[i];
-        qint64 imgEnd = imgStart + m_imageWidths[i];
+    // Create a set of collection indexes to keep in memory (visible plus buffer)
+    QSet<int> indexesToKeep;
+    for (int index : std::as_const(m_visibleIndexes)) {
+        indexesToKeep.insert(collectionIndex(index));
+    }
 
-        // TECHNICAL MODIFICATION: Extended buffer zone (3x margin)
-        qint64 extendedStart = m_viewportStartX - m_visibleMargin * 3;
-        qint64 extendedEnd = m_viewportEndX + m_visibleMargin * 3;
+    // Already decoded images stay resident within the retain margin, so
+    // reversing direction does not immediately trigger new decodes
+    const QList<int> retainedIndexes = calculateVisibleImageIndexes(m_viewportStartX - m_retainMargin,
+                                                                    m_viewportEndX + m_retainMargin);
+    for (int index : retainedIndexes) {
+        indexesToKeep.insert(collectionIndex(index));
+    }
 
-        // Keep images in extended buffer
-        if (imgStart <= extendedEnd && imgEnd >= extendedStart) {
-            indexesToKeep.insert(i);
+    // Images scheduled for upcoming navigation stay however far away they are
+    for (const QVector<int> &scheduled : std::as_const(m_scheduledImages)) {
+        for (int image : scheduled) {
+            indexesToKeep.insert(image);
         }
     }
 
@@ -532,8 +1321,12 @@ void ImageViewerContent::unloadInvisibleImages()
         int index = it.key();
         ImageInfo &info = it.value();
 
-        // Skip if not loaded or in the keep set
-        if (!info.loaded || indexesToKeep.contains(index)) {
+        // Images hidden by the filter stay decoded so clearing it shows
+        // them at once; nothing new is decoded while they are hidden
+        const int shownIndex = viewIndex(index);
+
+        // Skip if not loaded, hidden or in the keep set
+        if (!info.loaded || shownIndex < 0 || indexesToKeep.contains(index)) {
             ++it;
             continue;
         }
@@ -544,7 +1337,7 @@ void ImageViewerContent::unloadInvisibleImages()
         unloadedCount++;
 
         // Remove from images if not visible
-        if (!m_visibleIndexes.contains(index)) {
+        if (!m_visibleIndexes.contains(shownIndex)) {
             it = m_images.erase(it);
         } else {
             ++it;
@@ -555,10 +1348,17 @@ void ImageViewerContent::unloadInvisibleImages()
     qDebug() << "Unloaded" << unloadedCount << "images in" << timer.elapsed() << "ms";
 }
 
-void ImageViewerContent::onImageLoaded(int index, const QPixmap &pixmap)
+void ImageViewerContent::onImageLoaded(int index, const QString &path, const QPixmap &pixmap)
 {
+    // The collection may have been edited while the image was decoding;
+    // follow the image to wherever it is now
+    const int id = m_parent->pathTable()->find(path);
+    if (index < 0 || index >= m_imageIds.size() || m_imageIds[index] != id) {
+        index = indexOfId(id);
+    }
+
     // Safety checks
-    if (!m_images.contains(index) || index < 0 || index >= m_imagePaths.size()) {
+    if (!m_images.contains(index) || index < 0 || index >= m_imageIds.size()) {
         qDebug() << "onImageLoaded: Invalid image index" << index;
         return;
     }
@@ -577,15 +1377,26 @@ void ImageViewerContent::onImageLoaded(int index, const QPixmap &pixmap)
     // Handle invalid pixmaps gracefully
     if (pixmap.isNull()) {
         info.loaded = false;
+        info.failed = true;
         update(info.rect);
         return;
     }
 
     info.pixmap = pixmap;
     info.loaded = true;
+    info.failed = false;
+    if (index < m_imageSizes.size()) {
+        m_imageSizes[index] = pixmap.size();
+    }
+
+    // An image the filter has hidden since it was requested has no slot in
+    // the layout; its size is recorded for when it is shown again
+    const int shownIndex = viewIndex(index);
+    if (shownIndex < 0)
+        return;
 
     // Update virtual layout with actual image dimensions
-    qint64 oldWidth = m_imageWidths.value(index, 0);
+    qint64 oldWidth = m_imageWidths.value(shownIndex, 0);
     int newWidth = calculateImageWidth(pixmap.size(), height());
 
     if (oldWidth != newWidth) {
@@ -593,20 +1404,17 @@ void ImageViewerContent::onImageLoaded(int index, const QPixmap &pixmap)
         qDebug() << "Image" << index << "width changed: old=" << oldWidth << "new=" << newWidth;
 
         // Update image width
-        m_imageWidths[index] = newWidth;
+        m_imageWidths[shownIndex] = newWidth;
 
         // Update offsets for all subsequent images
-        qint64 offset = m_imageOffsets[index];
         qint64 widthDiff = newWidth - oldWidth;
 
         // TECHNICAL MODIFICATION: Only update subsequent images if there's a significant change
         if (qAbs(widthDiff) > 5) { // Only update for non-trivial changes
             qDebug() << "Updating offsets for subsequent images, width diff =" << widthDiff;
 
-            for (int i = index + 1; i < m_imagePaths.size(); ++i) {
-                if (m_imageOffsets.contains(i)) {
-                    m_imageOffsets[i] += widthDiff;
-                }
+            for (int i = shownIndex + 1; i < m_imageOffsets.size(); ++i) {
+                m_imageOffsets[i] += widthDiff;
             }
 
             // Update total content width
@@ -617,6 +1425,9 @@ void ImageViewerContent::onImageLoaded(int index, const QPixmap &pixmap)
 
             // Update physical layout
             updatePhysicalLayout();
+
+            // A jump aimed before this decode would now land off-center
+            followCenteredImage();
         }
     }
 
@@ -634,33 +1445,35 @@ void ImageViewerContent::paintEvent(QPaintEvent *event)
     // Fill background with solid color
     painter.fillRect(event->rect(), Qt::black);
 
-    // Enable smooth image scaling and antialiasing for rotation
-    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
-    painter.setRenderHint(QPainter::Antialiasing, true);
+    // Smooth scaling and antialiasing are only worth their cost once the
+    // view is at rest; while moving, nearest-neighbour keeps up with the display
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, !m_fastRendering);
+    painter.setRenderHint(QPainter::Antialiasing, !m_fastRendering);
 
     // Process only visible images with zoom applied
     for (int index : m_visibleIndexes) {
-        if (!m_images.contains(index) || index >= m_imagePaths.size())
+        const int image = collectionIndex(index);
+        if (image < 0 || !m_images.contains(image))
             continue;
 
-        const ImageInfo &info = m_images[index];
-        const QString &imagePath = m_imagePaths[index];
+        const ImageInfo &info = m_images[image];
+        const int imageId = m_imageIds[image];
 
         if (info.loaded && !info.pixmap.isNull()) {
             // Calculate zoomed rectangle
             QRect zoomedRect = calculateZoomedRect(info.rect);
 
             // Check for rotation
-            int rotation = m_imageRotations.value(index, 0);
+            int rotation = m_imageRotations.value(imageId, 0);
 
             // Verify intersection with paint area
             if (zoomedRect.intersects(event->rect())) {
                 if (rotation == 0) {
-                    // No rotation - draw directly
-                    painter.drawPixmap(zoomedRect, info.pixmap, info.pixmap.rect());
+                    // No rotation - draw only the exposed part of the image
+                    drawExposedPixmap(painter, zoomedRect, info.pixmap, event->rect());
 
                     // Draw favorite marker if applicable
-                    if (m_parent->isImageFavorite(imagePath)) {
+                    if (m_parent->isImageFavorite(imageId)) {
                         // Create star shape
                         QPolygonF star;
                         const int size = 24;
@@ -703,7 +1516,7 @@ void ImageViewerContent::paintEvent(QPaintEvent *event)
                     painter.drawPixmap(rotatedRect, info.pixmap, info.pixmap.rect());
 
                     // Draw favorite marker if applicable
-                    if (m_parent->isImageFavorite(imagePath)) {
+                    if (m_parent->isImageFavorite(imageId)) {
                         // Create rotated star shape
                         QPolygonF star;
                         const int size = 24;
@@ -738,7 +1551,11 @@ void ImageViewerContent::paintEvent(QPaintEvent *event)
             if (zoomedRect.intersects(event->rect())) {
                 painter.fillRect(zoomedRect, QColor(40, 40, 40));
 
-                if (info.loading) {
+                // Show a cached thumbnail until the full image arrives
+                QImage thumbnail = m_parent->getImageLoader()->thumbnailCache()->find(imagePath(image));
+                if (!thumbnail.isNull()) {
+                    painter.drawImage(fitThumbnailRect(thumbnail.size(), zoomedRect), thumbnail);
+                } else if (info.loading) {
                     // Draw loading indicator
                     painter.setPen(Qt::white);
                     painter.drawText(zoomedRect, Qt::AlignCenter, "Loading...");
@@ -754,7 +1571,7 @@ void ImageViewerContent::paintEvent(QPaintEvent *event)
             .arg(m_totalContentWidth)
             .arg(m_totalContentWidth > 0 ?
                      static_cast<int>(100.0 * m_currentScrollPosition / m_totalContentWidth) : 0)
-            .arg(m_imagePaths.size())
+            .arg(imageCount())
             .arg(m_visibleIndexes.size());
 
         // Create background for better readability
@@ -768,50 +1585,205 @@ void ImageViewerContent::paintEvent(QPaintEvent *event)
     }
 }
 
+void ImageViewerContent::drawExposedPixmap(QPainter &painter, const QRect &target,
+                                           const QPixmap &pixmap, const QRect &exposed) const
+{
+    QRect visibleTarget = target.intersected(exposed);
+    if (visibleTarget.isEmpty() || target.width() <= 0 || target.height() <= 0)
+        return;
+
+    // Map the exposed target area back into pixmap coordinates so a heavily
+    // zoomed image only scales the pixels that actually reach the screen
+    double scaleX = static_cast<double>(pixmap.width()) / target.width();
+    double scaleY = static_cast<double>(pixmap.height()) / target.height();
+
+    QRectF source((visibleTarget.left() - target.left()) * scaleX,
+                  (visibleTarget.top() - target.top()) * scaleY,
+                  visibleTarget.width() * scaleX,
+                  visibleTarget.height() * scaleY);
+
+    painter.drawPixmap(QRectF(visibleTarget), pixmap, source);
+}
+
 // Remainder of the implementation remains unchanged
 
-void ImageViewerContent::centerOnSpecificImage(int index)
+void ImageViewerContent::centerOnSpecificImage(int index, bool animate)
 {
-    if (this->m_imagePaths.isEmpty() || !m_imageOffsets.contains(index))
+    if (imageCount() == 0 || index < 0 || index >= m_imageOffsets.size())
         return;
 
     // Reset zoom and pan when navigating to a specific image
     m_zoomFactor = 1.0f;
     m_panOffset = QPoint(0, 0);
 
-    // Calculate scroll position to center the image
+    const qint64 scrollPosition = centeringPosition(index);
+
+    // Remember the target, so the view follows it while decodes around it
+    // replace placeholder widths
+    m_centeredImage = collectionIndex(index);
+    m_centeredPosition = scrollPosition;
+
+    if (animate) {
+        // Glide to the new position; prefetching starts as soon as the target is set
+        scrollToPosition(scrollPosition);
+    } else if (m_parent) {
+        // Jump, and lay out now rather than on the next frame, so the view
+        // can be captured at its destination
+        m_lastScrollValue = static_cast<int>(scrollPosition);
+        m_scrollAnimator->setPosition(scrollPosition);
+        m_parent->horizontalScrollBar()->setValue(static_cast<int>(scrollPosition));
+        m_currentScrollPosition = static_cast<int>(scrollPosition);
+        m_frameUpdatePending = true;
+        processFrameUpdate();
+    }
+
+    // Emit signal for current image change
+    emit m_parent->currentImageChanged(collectionIndex(index));
+}
+
+qint64 ImageViewerContent::centeringPosition(int index) const
+{
     qint64 imageOffset = m_imageOffsets[index];
     int imageWidth = m_imageWidths.value(index, 0);
     int viewportWidth = m_parent ? m_parent->viewport()->width() : width();
 
     // Calculate position to center the image
-    int scrollPosition = static_cast<int>(imageOffset + (imageWidth / 2) - (viewportWidth / 2));
-    scrollPosition = qBound(0, scrollPosition, static_cast<int>(m_totalContentWidth - viewportWidth));
+    qint64 scrollPosition = imageOffset + (imageWidth / 2) - (viewportWidth / 2);
+    return qBound(qint64(0), scrollPosition, qMax(qint64(0), m_totalContentWidth - viewportWidth));
+}
 
-    // Apply scroll position via scrollbar
-    if (m_parent) {
-        m_parent->horizontalScrollBar()->setValue(scrollPosition);
+void ImageViewerContent::followCenteredImage()
+{
+    if (m_centeredImage < 0 || !m_parent)
+        return;
+
+    // Any scrolling since the jump means the user has moved on
+    if (navigationPosition() != m_centeredPosition) {
+        m_centeredImage = -1;
+        return;
     }
 
-    // Emit signal for current image change
-    emit m_parent->currentImageChanged(index);
+    const int index = viewIndex(m_centeredImage);
+    if (index < 0) {
+        m_centeredImage = -1;
+        return;
+    }
+
+    const qint64 position = centeringPosition(index);
+    if (position == m_centeredPosition)
+        return;
+    m_centeredPosition = position;
+
+    if (m_scrollAnimator->isScrolling()) {
+        m_scrollAnimator->scrollTo(position);
+    } else {
+        // At rest the correction is applied at once, like an anchor restore
+        m_lastScrollValue = static_cast<int>(position);
+        m_scrollAnimator->setPosition(position);
+        m_parent->horizontalScrollBar()->setValue(static_cast<int>(position));
+    }
 }
 
 void ImageViewerContent::centerOnNextImage()
+{
+    int nextIndex = nextImageIndex();
+    if (nextIndex == -1)
+        return;
+
+    // Center on the next image
+    centerOnSpecificImage(nextIndex);
+}
+
+int ImageViewerContent::nextImageIndex()
 {
     int closestIndex = findClosestImageIndex();
     if (closestIndex == -1)
-        return;
+        return -1;
 
     // Find the next image index
     int nextIndex = closestIndex + 1;
 
     // If we've reached the end, wrap to first image
-    if (nextIndex >= m_imagePaths.size())
+    if (nextIndex >= imageCount())
         nextIndex = 0;
 
-    // Center on the next image
-    centerOnSpecificImage(nextIndex);
+    return nextIndex;
+}
+
+int ImageViewerContent::scheduleImages(int schedule, const QVector<int> &images, int priority)
+{
+    QVector<int> &scheduled = m_scheduledImages[schedule];
+    scheduled.clear();
+    if (!m_parent)
+        return 0;
+
+    int requested = 0;
+    for (int image : images) {
+        if (image < 0 || image >= m_imageIds.size())
+            continue;
+        scheduled.append(image);
+
+        ImageInfo &info = m_images[image];
+        if (!info.loaded && !info.loading) {
+            info.loading = true;
+            m_parent->getImageLoader()->loadImage(image, imageIdAt(image), imagePath(image), priority);
+            ++requested;
+        }
+        --priority;
+    }
+
+    return requested;
+}
+
+int ImageViewerContent::scheduleUpcomingImages(int schedule, int count, int priority, int fromImage)
+{
+    // A caller that just navigated knows where to; a hidden image falls back
+    // to the view
+    int closestIndex = fromImage >= 0 ? viewIndex(fromImage) : -1;
+    if (closestIndex < 0) {
+        closestIndex = findClosestImageIndex();
+    }
+    if (closestIndex == -1) {
+        clearScheduledImages(schedule);
+        return 0;
+    }
+
+    // Never more than the collection, or the schedule would wrap onto itself
+    count = qMin(count, imageCount() - 1);
+
+    QVector<int> images;
+    images.reserve(count);
+    for (int step = 1; step <= count; ++step) {
+        images.append(collectionIndex((closestIndex + step) % imageCount()));
+    }
+    return scheduleImages(schedule, images, priority);
+}
+
+void ImageViewerContent::clearScheduledImages(int schedule)
+{
+    // Released images are unloaded by the next pass if they are out of range
+    m_scheduledImages.remove(schedule);
+    requestFrameUpdate();
+}
+
+bool ImageViewerContent::isImageReady(int image) const
+{
+    const ImageInfo info = m_images.value(image);
+    return info.loaded || (info.failed && !info.loading);
+}
+
+bool ImageViewerContent::isImageDecoded(int image) const
+{
+    return m_images.value(image).loaded;
+}
+
+bool ImageViewerContent::isNextImageReady()
+{
+    const int nextIndex = nextImageIndex();
+    if (nextIndex == -1)
+        return false;
+
+    return isImageReady(collectionIndex(nextIndex));
 }
 
 void ImageViewerContent::centerOnPreviousImage()
@@ -825,7 +1797,7 @@ void ImageViewerContent::centerOnPreviousImage()
 
     // If we've reached the beginning, wrap to last image
     if (prevIndex < 0)
-        prevIndex = m_imagePaths.size() - 1;
+        prevIndex = imageCount() - 1;
 
     // Center on the previous image
     centerOnSpecificImage(prevIndex);
@@ -833,19 +1805,19 @@ void ImageViewerContent::centerOnPreviousImage()
 
 void ImageViewerContent::centerOnClosestLeftImage()
 {
-    if (m_imagePaths.isEmpty())
+    if (imageCount() == 0)
         return;
 
     // Find image to the left of current viewport center
     int viewportWidth = m_parent ? m_parent->viewport()->width() : width();
-    qint64 currentCenter = m_currentScrollPosition + (viewportWidth / 2);
+    qint64 currentCenter = navigationPosition() + (viewportWidth / 2);
 
     // Find closest image to the left
     int closestLeftIndex = -1;
     qint64 maxLeftDistance = INT_MAX;
 
-    for (int i = 0; i < m_imagePaths.size(); ++i) {
-        if (!m_imageOffsets.contains(i) || !m_imageWidths.contains(i)) continue;
+    for (int i = 0; i < imageCount(); ++i) {
+        if (i >= m_imageOffsets.size()) continue;
 
         qint64 imgCenter = m_imageOffsets[i] + (m_imageWidths[i] / 2);
 
@@ -866,8 +1838,8 @@ void ImageViewerContent::centerOnClosestLeftImage()
         int rightmostIndex = -1;
         qint64 rightmostPosition = -1;
 
-        for (int i = 0; i < m_imagePaths.size(); ++i) {
-            if (!m_imageOffsets.contains(i) || !m_imageWidths.contains(i)) continue;
+        for (int i = 0; i < imageCount(); ++i) {
+            if (i >= m_imageOffsets.size()) continue;
 
             qint64 imgRight = m_imageOffsets[i] + m_imageWidths[i];
 
@@ -888,19 +1860,19 @@ void ImageViewerContent::centerOnClosestLeftImage()
 
 void ImageViewerContent::centerOnClosestRightImage()
 {
-    if (m_imagePaths.isEmpty())
+    if (imageCount() == 0)
         return;
 
     // Find image to the right of current viewport center
     int viewportWidth = m_parent ? m_parent->viewport()->width() : width();
-    qint64 currentCenter = m_currentScrollPosition + (viewportWidth / 2);
+    qint64 currentCenter = navigationPosition() + (viewportWidth / 2);
 
     // Find closest image to the right
     int closestRightIndex = -1;
     qint64 minRightDistance = INT_MAX;
 
-    for (int i = 0; i < m_imagePaths.size(); ++i) {
-        if (!m_imageOffsets.contains(i) || !m_imageWidths.contains(i)) continue;
+    for (int i = 0; i < imageCount(); ++i) {
+        if (i >= m_imageOffsets.size()) continue;
 
         qint64 imgCenter = m_imageOffsets[i] + (m_imageWidths[i] / 2);
 
@@ -921,8 +1893,8 @@ void ImageViewerContent::centerOnClosestRightImage()
         int leftmostIndex = -1;
         qint64 leftmostPosition = INT_MAX;
 
-        for (int i = 0; i < m_imagePaths.size(); ++i) {
-            if (!m_imageOffsets.contains(i) || !m_imageWidths.contains(i)) continue;
+        for (int i = 0; i < imageCount(); ++i) {
+            if (i >= m_imageOffsets.size()) continue;
 
             qint64 imgLeft = m_imageOffsets[i];
 
@@ -943,19 +1915,20 @@ void ImageViewerContent::centerOnClosestRightImage()
 
 int ImageViewerContent::findClosestImageIndex()
 {
-    if (m_imagePaths.isEmpty())
+    if (imageCount() == 0)
         return -1;
 
-    // Find image closest to current viewport center
+    // Find image closest to the viewport center; during a glide that is
+    // where the view is heading, like the other navigation lookups
     int viewportWidth = m_parent ? m_parent->viewport()->width() : width();
-    qint64 currentCenter = m_currentScrollPosition + (viewportWidth / 2);
+    qint64 currentCenter = navigationPosition() + (viewportWidth / 2);
 
     // Variables to track closest image
     int closestImageIndex = -1;
     qint64 minDistance = INT_MAX;
 
-    for (int i = 0; i < m_imagePaths.size(); ++i) {
-        if (!m_imageOffsets.contains(i) || !m_imageWidths.contains(i)) continue;
+    for (int i = 0; i < imageCount(); ++i) {
+        if (i >= m_imageOffsets.size()) continue;
 
         qint64 imgCenter = m_imageOffsets[i] + (m_imageWidths[i] / 2);
         qint64 distance = qAbs(imgCenter - currentCenter);
@@ -977,6 +1950,8 @@ void ImageViewerContent::wheelEvent(QWheelEvent *event)
         // Handle zoom operation
         event->accept();
 
+        beginMotion();
+
         // Get scroll amount for zoom sensitivity
         int delta = event->angleDelta().y();
 
@@ -988,32 +1963,30 @@ void ImageViewerContent::wheelEvent(QWheelEvent *event)
     } else {
         // Handle normal horizontal scrolling
         event->accept();
-        QScrollBar *hScrollBar = m_parent->horizontalScrollBar();
+        beginMotion();
 
         // Determine scroll amount with velocity enhancement
         int scrollAmount = event->angleDelta().y();
         int enhancedScrollAmount = static_cast<int>(-scrollAmount / 1.5);
 
-        // Apply scroll position
-        hScrollBar->setValue(hScrollBar->value() + enhancedScrollAmount);
+        // Wheel ticks accumulate on the animation target for inertial scrolling
+        m_scrollAnimator->scrollBy(enhancedScrollAmount);
     }
 }
 
 void ImageViewerContent::rotateCurrentImage(int degrees)
 {
-    // Find current image index
-    int currentIndex = findClosestImageIndex();
+    // Rotations belong to the image, not to its place in the collection
+    int currentIndex = collectionIndex(findClosestImageIndex());
     if (currentIndex == -1)
         return;
+    const int id = m_imageIds[currentIndex];
 
     // Update rotation for this image
-    if (!m_imageRotations.contains(currentIndex)) {
-        m_imageRotations[currentIndex] = 0;
-    }
-
-    m_imageRotations[currentIndex] = (m_imageRotations[currentIndex] + degrees) % 360;
-    if (m_imageRotations[currentIndex] < 0) {
-        m_imageRotations[currentIndex] += 360;
+    int &rotation = m_imageRotations[id];
+    rotation = (rotation + degrees) % 360;
+    if (rotation < 0) {
+        rotation += 360;
     }
 
     // Force redraw
@@ -1088,6 +2061,9 @@ void ImageViewerContent::mousePressEvent(QMouseEvent *event)
         return;
     }
 
+    // Any click stops a running scroll animation where it is
+    m_scrollAnimator->stop();
+
     // Initiate panning on left button press
     if (event->button() == Qt::LeftButton && m_zoomFactor > 1.0f) {
         m_isPanning = true;
@@ -1115,6 +2091,9 @@ void ImageViewerContent::mouseMoveEvent(QMouseEvent *event)
         // Update last position
         m_lastPanPosition = event->position().toPoint();
 
+        // Paint at low quality until the pan settles
+        beginMotion();
+
         // Refresh display
         update();
         event->accept();
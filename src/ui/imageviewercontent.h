@@ -9,6 +9,7 @@
 #include <QHash>
 #include <QSet>
 #include <QPoint>
+#include <QElapsedTimer>
 
 // Forward declarations
 class ImageViewer;
@@ -18,6 +19,9 @@ class QMouseEvent;
 class QDragEnterEvent;
 class QDragMoveEvent;
 class QDropEvent;
+class QTimer;
+class QPainter;
+class ScrollAnimator;
 
 /**
  * @brief Structure to hold image information and state.
@@ -27,6 +31,7 @@ struct ImageInfo {
     QRect rect;          ///< Rectangle for rendering
     bool loaded = false; ///< Whether the image is loaded
     bool loading = false;///< Whether the image is currently loading
+    bool failed = false; ///< Whether the last decode produced no image
 };
 
 /**
@@ -53,10 +58,77 @@ public:
     ~ImageViewerContent();
 
     /**
-     * @brief Sets the paths of images to display.
-     * @param paths List of image file paths.
+     * @brief Sets the images to display.
+     * @param ids Image IDs in the viewer's path table, in display order.
+     * @param sizes Known display sizes of the images, index-aligned with ids;
+     *              lets the layout use real aspect ratios before anything is decoded.
      */
-    void setImagePaths(const QList<QString> &paths);
+    void setImages(const QVector<int> &ids, const QVector<QSize> &sizes = QVector<QSize>());
+
+    /**
+     * @brief Appends images to the end of the collection.
+     *
+     * Extends the virtual layout without touching loaded images or the
+     * current scroll position.
+     *
+     * @param ids IDs of the images to append.
+     */
+    void appendImages(const QVector<int> &ids);
+
+    /**
+     * @brief Inserts images into the collection.
+     *
+     * Loaded images and rotations move with their images, and the image in
+     * the middle of the view stays where it is.
+     *
+     * @param position The index the first new image will have.
+     * @param ids IDs of the images to insert.
+     */
+    void insertImages(int position, const QVector<int> &ids);
+
+    /**
+     * @brief Inserts images at scattered positions in one pass.
+     *
+     * Behaves like insertImages() for each image, but the collection and
+     * layout are rebuilt only once.
+     *
+     * @param ids IDs of the images to insert.
+     * @param positions For each new image, the index of the existing image
+     *                  it goes before; non-decreasing, the count appends.
+     */
+    void mergeImages(const QVector<int> &ids, const QVector<int> &positions);
+
+    /**
+     * @brief Removes images from the collection.
+     *
+     * Remaining loaded images and rotations are preserved, and the view
+     * stays on the current image (or its nearest remaining neighbour).
+     *
+     * @param ids IDs of the images to remove.
+     */
+    void removeImages(const QVector<int> &ids);
+
+    /**
+     * @brief Re-evaluates which images the view shows.
+     *
+     * While favorites mode or a metadata filter is active only the images
+     * they let through are laid out; the collection, decoded images and
+     * known sizes are untouched, so switching filters or unfavoriting an
+     * image only rebuilds the index map and the offsets.
+     * The image in the middle of the view (or its nearest remaining
+     * neighbour) stays in place.
+     */
+    void updateImageFilter();
+
+    /**
+     * @brief Discards decoded data of images whose files changed on disk.
+     *
+     * Visible images keep showing their old pixmap until the new decode
+     * arrives; others are simply unloaded and decode again when reached.
+     *
+     * @param ids IDs of the changed images.
+     */
+    void invalidateImages(const QVector<int> &ids);
 
     /**
      * @brief Updates which images are visible based on scrolling position.
@@ -66,8 +138,10 @@ public:
     /**
      * @brief Centers the view on a specific image.
      * @param index The index of the image to center on.
+     * @param animate Whether to glide there; otherwise the view jumps and is
+     *                laid out before this returns, ready to be captured.
      */
-    void centerOnSpecificImage(int index);
+    void centerOnSpecificImage(int index, bool animate = true);
 
     /**
      * @brief Rotates the current image.
@@ -85,6 +159,64 @@ public:
      */
     void centerOnPreviousImage();
 
+    /**
+     * @brief Requests images ahead of navigation, wherever they are.
+     *
+     * Unlike the preload window, the images are kept decoded until the
+     * schedule is replaced or cleared. Each navigation feature keeps its
+     * own schedule, so the slideshow and random navigation do not evict
+     * each other's images. The image needed first gets the highest
+     * priority, so the loader works through them in order.
+     *
+     * @param schedule The ImageViewer::ImageSchedule to replace.
+     * @param images Collection indexes, most urgent first.
+     * @param priority Loader priority of the first one; each later one gets one less.
+     * @return The number of requests issued (images already decoded or queued need none).
+     */
+    int scheduleImages(int schedule, const QVector<int> &images, int priority);
+
+    /**
+     * @brief Schedules the images that follow one in navigation order.
+     * @param schedule The ImageViewer::ImageSchedule to replace.
+     * @param count How many images after the current one, wrapping at the end.
+     * @param priority Loader priority of the first one; each later one gets one less.
+     * @param fromImage Collection index to count from; -1 for the current image.
+     * @return The number of requests issued.
+     */
+    int scheduleUpcomingImages(int schedule, int count, int priority, int fromImage = -1);
+
+    /**
+     * @brief Releases the images held by a schedule.
+     * @param schedule The ImageViewer::ImageSchedule to clear.
+     */
+    void clearScheduledImages(int schedule);
+
+    /**
+     * @brief Checks whether an image can be shown without a placeholder.
+     * @param image The collection index.
+     * @return True if it is decoded, or its decode failed and waiting will not help.
+     */
+    bool isImageReady(int image) const;
+
+    /**
+     * @brief Checks whether an image is decoded.
+     * @param image The collection index.
+     * @return True if its pixels are in memory; a failed decode does not count.
+     */
+    bool isImageDecoded(int image) const;
+
+    /**
+     * @brief Checks whether the next image can be shown without a placeholder.
+     * @return True if it is decoded, or its decode failed and waiting will not help.
+     */
+    bool isNextImageReady();
+
+    /**
+     * @brief Gets the image centerOnNextImage() would move to.
+     * @return The view index, or -1 if there are no images.
+     */
+    int nextImageIndex();
+
     /**
      * @brief Centers the view on the closest image to the left.
      */
@@ -102,15 +234,73 @@ public:
 
     /**
      * @brief Finds the index of the image closest to the current view center.
+     *
+     * While the view glides, the center at the end of the glide counts.
+     *
      * @return The index of the closest image, or -1 if no images.
      */
     int findClosestImageIndex();
 
     /**
-     * @brief Gets the current image paths.
-     * @return Vector of image paths.
+     * @brief Gets the images of the collection.
+     * @return Image IDs of the whole collection in display order, including filtered-out images.
+     */
+    const QVector<int>& getImageIds() const { return m_imageIds; }
+
+    /**
+     * @brief Gets the ID of an image.
+     * @param index The collection index of the image.
+     * @return The image ID, or -1 if out of range.
+     */
+    int imageIdAt(int index) const { return m_imageIds.value(index, -1); }
+
+    /**
+     * @brief Rebuilds the path of an image from the path table.
+     * @param index The collection index of the image.
+     * @return The path, or an empty string if out of range.
+     */
+    QString imagePath(int index) const;
+
+    /**
+     * @brief Gets the number of images the view shows.
+     * @return The number of images passing the filter.
+     */
+    int imageCount() const { return m_filtered ? m_viewIndexes.size() : m_imageIds.size(); }
+
+    /**
+     * @brief Maps a position in the view to the image's index in the collection.
+     * @param index The position in the view.
+     * @return The collection index, or -1 if out of range.
+     */
+    int collectionIndex(int index) const;
+
+    /**
+     * @brief Maps a collection index to the image's position in the view.
+     * @param index The index in the collection.
+     * @return The position in the view, or -1 if the image is filtered out.
+     */
+    int viewIndex(int index) const;
+
+    /**
+     * @brief Finds an image in the collection.
+     * @param id The image ID.
+     * @return The collection index, or -1 if the image is not in the collection.
+     */
+    int indexOfId(int id) const { return id >= 0 && id < m_indexById.size() ? m_indexById[id] : -1; }
+
+    /**
+     * @brief Finds the shown image closest to a collection index.
+     * @param index The index in the collection.
+     * @return The view position of that image, or of the next (else previous) shown one; -1 if none.
+     */
+    int nearestViewIndex(int index) const;
+
+    /**
+     * @brief Finds the image covering a logical x position in the virtual layout.
+     * @param logicalX The logical x coordinate.
+     * @return The view index of the image at that position, or -1 if none.
      */
-    const QVector<QString>& getImagePaths() const { return m_imagePaths; }
+    int indexAtLogicalPosition(qint64 logicalX) const;
 
 protected:
     /**
@@ -176,13 +366,50 @@ protected:
 private:
     // Member variables
     ImageViewer *m_parent;                    ///< Parent ImageViewer
-    QVector<QString> m_imagePaths;            ///< Paths to images
-    QHash<int, ImageInfo> m_images;           ///< Image data by index
-    QSet<int> m_visibleIndexes;               ///< Currently visible image indexes
+    QVector<int> m_imageIds;                  ///< Image IDs in the viewer's path table, in display order
+    QVector<int> m_indexById;                 ///< Collection index by image ID, -1 if not in the collection
+    QHash<int, ImageInfo> m_images;           ///< Image data by collection index
+    QSet<int> m_visibleIndexes;               ///< Currently visible view indexes
+    bool m_filtered = false;                  ///< Whether a filter hides images
+    QVector<int> m_viewIndexes;               ///< Collection index of each shown image, ascending (filtered only)
     int m_currentScrollPosition = 0;          ///< Current horizontal scroll position
 
-    // TECHNICAL MODIFICATION: Significantly increased visible margin for expanded loading window
-    const int m_visibleMargin = 10000;        ///< Margin for preloading (increased from 1000)
+    // Velocity-aware preload window
+    const int m_idleMargin = 3000;            ///< Preload margin on each side while idle
+    const int m_trailingMargin = 500;         ///< Preload margin behind the direction of travel
+    const int m_maxLookahead = 40000;         ///< Upper bound for the preload margin ahead
+    const int m_lookaheadTimeMs = 1500;       ///< How far ahead (in ms of travel) to preload
+    const int m_retainMargin = 30000;         ///< Margin beyond the window where decoded images are kept
+    const int m_velocityIdleMs = 200;         ///< Time without scrolling before velocity resets
+    double m_scrollVelocity = 0.0;            ///< Smoothed scroll velocity in logical px/ms (signed)
+    int m_lastScrollValue = 0;                ///< Scroll value seen at the previous velocity sample
+    QElapsedTimer m_velocityClock;            ///< Time since the previous velocity sample
+    QTimer *m_velocityIdleTimer = nullptr;    ///< Resets velocity once scrolling stops
+    int m_marginBefore = 3000;                ///< Current preload margin left of the viewport
+    int m_marginAfter = 3000;                 ///< Current preload margin right of the viewport
+    const int m_adviseCount = 24;             ///< Images beyond the window offered for readahead hints
+
+    // Motion-adaptive rendering
+    const int m_refineDelayMs = 150;          ///< Idle time before the high-quality repaint
+    bool m_fastRendering = false;             ///< Whether the view is moving and painted at low quality
+    QTimer *m_refineTimer = nullptr;          ///< Triggers the high-quality refinement repaint
+
+    // Frame-synchronized scrolling
+    ScrollAnimator *m_scrollAnimator = nullptr; ///< Smooth, inertial scroll animation
+    QTimer *m_frameTimer = nullptr;           ///< Coalesces layout/load passes to one per frame
+    bool m_frameUpdatePending = false;        ///< Whether a layout/load pass is scheduled
+
+    // Scrub mode: thumbnails only while the user sweeps across the collection
+    const double m_scrubVelocityThreshold = 30.0; ///< Speed (px/ms) above which scrolling counts as scrubbing
+    const int m_scrubSettleMs = 250;          ///< Time without movement before full decodes resume
+    bool m_scrubbing = false;                 ///< Whether full decodes are deferred
+
+    QHash<int, QVector<int>> m_scheduledImages; ///< Collection indexes kept decoded, per schedule
+
+    // Navigation target kept centered while the layout settles
+    int m_centeredImage = -1;                 ///< Collection index centerOnSpecificImage() aimed at, -1 if none
+    qint64 m_centeredPosition = -1;           ///< Scroll position it aimed at
+    QTimer *m_scrubSettleTimer = nullptr;     ///< Detects when the user has settled
 
     // Favorite icon properties
     QPixmap m_favoriteIcon;                   ///< Icon for favorites
@@ -196,14 +423,15 @@ private:
     QPoint m_lastPanPosition;                 ///< Last mouse position during panning
 
     // Rotation state tracking
-    QHash<int, int> m_imageRotations;         ///< Rotation angle by image index
+    QHash<int, int> m_imageRotations;         ///< Rotation angle by image ID
 
     // Virtual scrolling system
     qint64 m_totalContentWidth = 0;           ///< Total logical width of all images
     int m_viewportStartX = 0;                 ///< Start X position of current viewport in logical coordinates
     int m_viewportEndX = 0;                   ///< End X position of current viewport in logical coordinates
-    QHash<int, qint64> m_imageOffsets;        ///< Map of image index to logical position
-    QHash<int, int> m_imageWidths;            ///< Map of image index to width
+    QVector<qint64> m_imageOffsets;           ///< Logical position of each shown image, ascending
+    QVector<int> m_imageWidths;               ///< Width of each shown image
+    QVector<QSize> m_imageSizes;              ///< Known display size by collection index, invalid if unknown
     const int m_maxWidgetWidth = 30000;       ///< Maximum physical widget width (safely below Qt's limit)
     int m_physicalOffsetX = 0;                ///< Physical offset for mapping logical to physical coordinates
 
@@ -218,6 +446,14 @@ private:
      */
     void unloadInvisibleImages();
 
+    /**
+     * @brief Asks the loader to hint the files just beyond the preload window.
+     *
+     * While scrolling only the images ahead in the direction of travel are
+     * hinted; when idle both sides are, nearest first.
+     */
+    void adviseUpcomingImages();
+
     /**
      * @brief Updates the layout of all images.
      */
@@ -318,19 +554,183 @@ private:
      */
     QList<int> calculateVisibleImageIndexes(qint64 startX, qint64 endX) const;
 
+    /**
+     * @brief Recomputes logical offsets from an index onward using the stored widths.
+     * @param fromIndex The first index whose offset is recomputed.
+     */
+    void rebuildOffsets(int fromIndex);
+
+    /**
+     * @brief Rebuilds the view-to-collection index map from the viewer's filters.
+     */
+    void rebuildViewIndexes();
+
+    /**
+     * @brief Records the collection index of every image from one on.
+     * @param fromIndex The first collection index whose image moved or is new.
+     */
+    void rebuildIdIndex(int fromIndex);
+
+    /**
+     * @brief Computes the scroll position that centers an image.
+     * @param index The view index.
+     * @return The scroll position, within the scrollable range.
+     */
+    qint64 centeringPosition(int index) const;
+
+    /**
+     * @brief Moves the view along with a navigation target whose offset changed.
+     *
+     * Decodes replace placeholder widths, which shifts the target of a
+     * jump after the jump was aimed. As long as the view is still headed
+     * for (or resting at) the aimed position, it is re-aimed at the
+     * target's new center; any other scrolling ends this.
+     */
+    void followCenteredImage();
+
+    /**
+     * @brief Moves collection-index-keyed state (resident images) after the collection was edited.
+     * @param oldToNew New collection index for every old one, or -1 if the image was removed.
+     */
+    void remapIndexes(const QVector<int> &oldToNew);
+
+    /**
+     * @brief Records which image is in the middle of the view and where.
+     * @param anchorIndex Receives the view index of the image at the view center, or -1.
+     * @param anchorDelta Receives the scroll position relative to that image's offset.
+     */
+    void captureViewAnchor(int &anchorIndex, qint64 &anchorDelta) const;
+
+    /**
+     * @brief Scrolls so the anchor image is where it was before an edit.
+     * @param anchorIndex The anchor image's view index after the edit, or -1.
+     * @param anchorDelta The scroll position relative to the image's offset.
+     */
+    void restoreViewAnchor(int anchorIndex, qint64 anchorDelta);
+
+    /**
+     * @brief Samples scroll velocity from a new scroll position.
+     * @param value The new scrollbar value.
+     */
+    void updateScrollVelocity(int value);
+
+    /**
+     * @brief Recomputes the preload margins from the current scroll velocity.
+     *
+     * The window widens in the direction of travel as speed increases and
+     * shrinks back to a symmetric idle margin when scrolling stops.
+     */
+    void updatePrefetchMargins();
+
+    /**
+     * @brief Switches painting to the fast, low-quality path while the view moves.
+     *
+     * A high-quality refinement repaint follows automatically once no further
+     * motion has been reported for a short period.
+     */
+    void beginMotion();
+
+    /**
+     * @brief Schedules a layout/load pass for the next frame.
+     *
+     * Any number of scroll changes within one frame result in a single pass.
+     */
+    void requestFrameUpdate();
+
+    /**
+     * @brief Animates the view to a scroll position.
+     *
+     * Long jumps skip most of the distance instantly and only animate the
+     * final stretch.
+     *
+     * @param position The target scroll position.
+     */
+    void scrollToPosition(qint64 position);
+
+    /**
+     * @brief Gets the position navigation should be computed from.
+     * @return The animation target while scrolling, otherwise the current position.
+     */
+    qint64 navigationPosition() const;
+
+    /**
+     * @brief Gets the interval between display frames.
+     * @return The frame interval in milliseconds.
+     */
+    int frameIntervalMs() const;
+
+    /**
+     * @brief Enters scrub mode, deferring full decodes.
+     *
+     * Queued loads are dropped so the decoder is free as soon as the user
+     * settles; only cached thumbnails are shown until then.
+     */
+    void enterScrubMode();
+
+    /**
+     * @brief Computes where to draw a thumbnail inside an image placeholder.
+     * @param thumbnailSize The size of the thumbnail.
+     * @param placeholder The placeholder rectangle.
+     * @return The aspect-correct rectangle centered in the placeholder.
+     */
+    QRect fitThumbnailRect(const QSize &thumbnailSize, const QRect &placeholder) const;
+
+    /**
+     * @brief Draws a pixmap, limiting the source region to the part that is exposed.
+     * @param painter The painter to draw with.
+     * @param target The target rectangle of the whole pixmap.
+     * @param pixmap The pixmap to draw.
+     * @param exposed The exposed area in painter coordinates.
+     */
+    void drawExposedPixmap(QPainter &painter, const QRect &target,
+                           const QPixmap &pixmap, const QRect &exposed) const;
+
 private slots:
     /**
      * @brief Handles completion of image loading.
      * @param index The index of the loaded image.
+     * @param path The file path of the loaded image.
      * @param pixmap The loaded pixmap.
      */
-    void onImageLoaded(int index, const QPixmap &pixmap);
+    void onImageLoaded(int index, const QString &path, const QPixmap &pixmap);
 
     /**
      * @brief Slot to handle scrollbar value changes.
      * @param value The new scrollbar value.
      */
     void onScrollValueChanged(int value);
+
+    /**
+     * @brief Resets scroll velocity after scrolling has stopped.
+     */
+    void onScrollIdle();
+
+    /**
+     * @brief Repaints at full quality after motion has stopped.
+     */
+    void onRefineTimeout();
+
+    /**
+     * @brief Runs the pending layout/load pass.
+     */
+    void processFrameUpdate();
+
+    /**
+     * @brief Applies an animated scroll position for the current frame.
+     * @param position The animated scroll position.
+     */
+    void onAnimationFrame(qint64 position);
+
+    /**
+     * @brief Starts loading the images around a scroll target before the view gets there.
+     * @param target The logical scroll position being animated to.
+     */
+    void prefetchScrollTarget(qint64 target);
+
+    /**
+     * @brief Leaves scrub mode once scrolling has settled and resumes full decodes.
+     */
+    void onScrubSettled();
 };
 
 #endif // IMAGEVIEWERCONTENT_H
@@ -1,6 +1,17 @@
 // mainwindow.cpp
 #include "mainwindow.h"
 #include "imageviewer.h"
+#include "../core/directoryscanner.h"
+#include "../core/directorywatcher.h"
+#include "../core/collectionmanifest.h"
+#include "../core/manifestwritetask.h"
+#include "../core/formatsniffer.h"
+#include "../core/imageloader.h"
+#include "../core/ziparchive.h"
+#include "../core/httpimagesource.h"
+#include "../core/pathtable.h"
+#include "../core/metadatastore.h"
+#include "../core/imagedetailscache.h"
 
 #include <QDir>
 #include <QFileDialog>
@@ -12,20 +23,77 @@
 #include <QMimeData>
 #include <QInputDialog>
 #include <QTimer>
-#include <QImageReader>
 #include <QFileInfo>
 #include <QLabel>
 #include <QTableWidget>
 #include <QHeaderView>
+#include <QActionGroup>
 #include <QPushButton>
 #include <QHBoxLayout>
-#include <QRandomGenerator>
+#include <QDebug>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QFormLayout>
+#include <QSpinBox>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QDialogButtonBox>
+#include <algorithm>
+
+namespace {
+
+// Membership bits indexed by image ID; IDs are dense, so a bit array is far
+// smaller than a set for large collections
+bool testId(const QBitArray &bits, int id)
+{
+    return id >= 0 && id < bits.size() && bits.testBit(id);
+}
+
+void setId(QBitArray &bits, int id, bool value)
+{
+    if (id >= bits.size()) {
+        if (!value)
+            return;
+        bits.resize(qMax(id + 1, int(bits.size()) * 2));
+    }
+    bits.setBit(id, value);
+}
+
+} // namespace
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , m_imageViewer(new ImageViewer(this))
+    , m_scanner(new DirectoryScanner(this))
+    , m_dropIngestor(new DirectoryScanner(this))
+    , m_watcher(new DirectoryWatcher(this))
+    , m_pathTable(m_imageViewer->pathTable())
+    , m_imageDetails(new ImageDetailsCache(this))
 {
     setupUI();
+
+    // Directory contents stream in from the background scanner
+    connect(m_scanner, &DirectoryScanner::pathsDiscovered,
+            this, &MainWindow::onPathsDiscovered);
+    connect(m_scanner, &DirectoryScanner::scanFinished,
+            this, &MainWindow::onScanFinished);
+
+    // Dropped files and folders stream in the same way
+    connect(m_dropIngestor, &DirectoryScanner::pathsDiscovered,
+            this, &MainWindow::onPathsDiscovered);
+    connect(m_dropIngestor, &DirectoryScanner::scanFinished,
+            this, &MainWindow::onIngestFinished);
+
+    // Files written to or removed from the open directory are applied incrementally
+    connect(m_watcher, &DirectoryWatcher::filesChanged,
+            this, &MainWindow::onWatchedFilesChanged);
+    connect(m_watcher, &DirectoryWatcher::filesRemoved,
+            this, &MainWindow::onWatchedFilesRemoved);
+    connect(m_watcher, &DirectoryWatcher::rescanRequired,
+            this, &MainWindow::onWatchRescanRequired);
+    connect(m_watcher, &DirectoryWatcher::directoryRemoved,
+            this, &MainWindow::onWatchedDirectoryRemoved);
 }
 
 MainWindow::~MainWindow()
@@ -41,6 +109,18 @@ void MainWindow::setupUI()
     QAction *openAction = fileMenu->addAction("&Open Directory...");
     connect(openAction, &QAction::triggered, this, &MainWindow::openDirectory);
 
+    QAction *openArchiveAction = fileMenu->addAction("Open &Archive...");
+    connect(openArchiveAction, &QAction::triggered, this, &MainWindow::openArchive);
+
+    QAction *openUrlsAction = fileMenu->addAction("Open &URLs...");
+    connect(openUrlsAction, &QAction::triggered, this, &MainWindow::openUrls);
+
+    QAction *recursiveAction = fileMenu->addAction("Include &Subdirectories");
+    recursiveAction->setCheckable(true);
+    connect(recursiveAction, &QAction::toggled, [this](bool checked) {
+        m_recursiveScan = checked;
+    });
+
     // Add navigation menu
     QMenu *navMenu = menuBar()->addMenu("&Navigation");
     QAction *randomAction = navMenu->addAction("&Random Image");
@@ -56,6 +136,24 @@ void MainWindow::setupUI()
     QAction *slideshowTimingAction = navMenu->addAction("Slideshow &Timing...");
     connect(slideshowTimingAction, &QAction::triggered, this, &MainWindow::setSlideshowInterval);
 
+    QMenu *transitionMenu = navMenu->addMenu("Slideshow T&ransition");
+    QActionGroup *transitionGroup = new QActionGroup(this);
+    const QList<QPair<QString, ImageViewer::Transition>> transitions = {
+        { "&None", ImageViewer::NoTransition },
+        { "&Crossfade", ImageViewer::CrossfadeTransition },
+        { "&Slide", ImageViewer::SlideTransition }
+    };
+    for (const auto &transition : transitions) {
+        QAction *transitionAction = transitionMenu->addAction(transition.first);
+        transitionAction->setCheckable(true);
+        transitionAction->setChecked(transition.second == m_slideshowTransition);
+        transitionGroup->addAction(transitionAction);
+        const ImageViewer::Transition style = transition.second;
+        connect(transitionAction, &QAction::triggered, [this, style]() {
+            m_slideshowTransition = style;
+        });
+    }
+
     fileMenu->addSeparator();
     QAction *exitAction = fileMenu->addAction("E&xit");
     connect(exitAction, &QAction::triggered, this, &QWidget::close);
@@ -92,6 +190,57 @@ void MainWindow::setupUI()
     showFavoritesAction->setCheckable(true);
     connect(showFavoritesAction, &QAction::triggered, this, &MainWindow::toggleFavoritesMode);
 
+    QMenu *metadataMenu = menuBar()->addMenu("&Metadata");
+
+    for (int rating = 0; rating <= MetadataStore::MaxRating; ++rating) {
+        QAction *rateAction = metadataMenu->addAction(rating == 0 ? QString("Clear &Rating")
+                                                                  : QString("Rate &%1").arg(rating));
+        rateAction->setShortcut(Qt::Key_0 + rating);
+        connect(rateAction, &QAction::triggered, [this, rating]() {
+            m_imageViewer->setCurrentImageRating(rating);
+        });
+    }
+
+    metadataMenu->addSeparator();
+
+    QAction *pickAction = metadataMenu->addAction("&Pick");
+    pickAction->setShortcut(Qt::Key_P);
+    connect(pickAction, &QAction::triggered, [this]() {
+        m_imageViewer->setCurrentImageFlag(MetadataStore::Picked);
+    });
+
+    QAction *rejectAction = metadataMenu->addAction("Re&ject");
+    rejectAction->setShortcut(Qt::Key_X);
+    connect(rejectAction, &QAction::triggered, [this]() {
+        m_imageViewer->setCurrentImageFlag(MetadataStore::Rejected);
+    });
+
+    QAction *unflagAction = metadataMenu->addAction("&Unflag");
+    unflagAction->setShortcut(Qt::Key_U);
+    connect(unflagAction, &QAction::triggered, [this]() {
+        m_imageViewer->setCurrentImageFlag(MetadataStore::Unflagged);
+    });
+
+    metadataMenu->addSeparator();
+
+    QAction *tagAction = metadataMenu->addAction("Add &Tag...");
+    tagAction->setShortcut(Qt::Key_T);
+    connect(tagAction, &QAction::triggered, this, &MainWindow::tagCurrentImage);
+
+    QAction *tagShownAction = metadataMenu->addAction("Tag &Shown Images...");
+    connect(tagShownAction, &QAction::triggered, this, &MainWindow::tagShownImages);
+
+    metadataMenu->addSeparator();
+
+    QAction *filterAction = metadataMenu->addAction("&Filter...");
+    filterAction->setShortcut(Qt::CTRL | Qt::SHIFT | Qt::Key_F);
+    connect(filterAction, &QAction::triggered, this, &MainWindow::showMetadataFilter);
+
+    QAction *clearFilterAction = metadataMenu->addAction("&Clear Filter");
+    connect(clearFilterAction, &QAction::triggered, [this]() {
+        m_imageViewer->setMetadataFilter(MetadataStore::Filter());
+    });
+
     // Add help menu
     QMenu *helpMenu = menuBar()->addMenu("&Help");
 
@@ -120,8 +269,24 @@ void MainWindow::setupUI()
     statusBar()->showMessage("Ready");
 
     // Connect to ImageViewer for update notifications
+    connect(m_imageViewer, &ImageViewer::imageMetadataChanged,
+            this, &MainWindow::updateImageInfo);
     connect(m_imageViewer, &ImageViewer::currentImageChanged,
             this, &MainWindow::updateImageInfo);
+    connect(m_imageViewer, &ImageViewer::metadataFilterApplied, [this](int shownCount) {
+        if (shownCount > 0) {
+            statusBar()->showMessage(QString("Showing %1 of %2 images")
+                                         .arg(shownCount).arg(m_imageViewer->imageIds().size()));
+        } else {
+            statusBar()->clearMessage();
+        }
+    });
+    connect(m_imageDetails, &ImageDetailsCache::detailsLoaded,
+            this, &MainWindow::onImageDetailsLoaded);
+
+    // Queued, so the content has taken the decoded image before the slideshow looks
+    connect(m_imageViewer->getImageLoader(), &ImageLoader::imageLoaded,
+            this, &MainWindow::onSlideshowImageLoaded, Qt::QueuedConnection);
 }
 
 void MainWindow::openDirectory()
@@ -138,29 +303,336 @@ void MainWindow::openDirectory()
     }
 }
 
-void MainWindow::loadImagesFromDirectory(const QString &dirPath)
+void MainWindow::openArchive()
 {
-    m_imagePaths.clear();
+    QString archivePath = QFileDialog::getOpenFileName(
+        this,
+        "Select Image Archive",
+        QDir::homePath(),
+        "Archives (*.zip *.cbz)"
+        );
 
-    QDir dir(dirPath);
-    QStringList filters;
-    filters << "*.jpg" << "*.jpeg" << "*.png" << "*.bmp" << "*.gif" << "*.webp";
-    dir.setNameFilters(filters);
-    dir.setFilter(QDir::Files | QDir::NoDotAndDotDot);
+    if (!archivePath.isEmpty()) {
+        loadImagesFromArchive(archivePath);
+    }
+}
 
-    QStringList fileList = dir.entryList();
+void MainWindow::loadImagesFromArchive(const QString &path)
+{
+    const QString archivePath = QFileInfo(path).absoluteFilePath();
+
+    // An archive replaces the open directory and anything still arriving from a drop
+    m_dropIngestor->cancel();
+    m_watcher->stop();
+    m_openedManifest.reset();
+    if (m_manifestCancelled) {
+        m_manifestCancelled->store(true);
+    }
 
-    for (const QString &fileName : fileList) {
-        m_imagePaths.append(dir.filePath(fileName));
+    m_collectionIds.clear();
+    m_replacePending = true;
+    m_shuffle = ShuffleOrder();
+    m_scanSeenIds.clear();
+    m_imageViewer->getImageLoader()->clearImageFormats();
+    m_imageDetails->clear();
+    // Archives are neither watched nor given a manifest
+    m_currentDirectory.clear();
+
+    // Indexing only reads the central directory; holding the archive keeps
+    // that index and the mapping alive for every load that follows
+    m_openArchive = ZipArchive::open(archivePath);
+    if (!m_openArchive) {
+        m_scanner->cancel();
+        m_replacePending = false;
+        m_imageViewer->setImages(QVector<int>());
+        statusBar()->showMessage(QString("Cannot read archive %1").arg(archivePath));
+        return;
     }
 
-    if (m_imagePaths.isEmpty()) {
+    m_scanner->scanArchive(archivePath);
+    statusBar()->showMessage(QString("Reading %1...").arg(archivePath));
+}
+
+void MainWindow::loadImagesFromDirectory(const QString &path)
+{
+    // Scanner and watcher must produce identical strings for the same file
+    const QString dirPath = QDir(path).absolutePath();
+
+    // An opened directory replaces anything still arriving from a drop
+    m_dropIngestor->cancel();
+
+    m_collectionIds.clear();
+    m_replacePending = true;
+    m_shuffle = ShuffleOrder();
+    m_scanSeenIds.clear();
+    m_imageViewer->getImageLoader()->clearImageFormats();
+    m_imageDetails->clear();
+    m_currentDirectory = dirPath;
+    m_openArchive.reset();
+
+    if (m_manifestCancelled) {
+        m_manifestCancelled->store(true);
+    }
+
+    // A known collection is shown straight from its manifest; the scan
+    // below then only validates it against the filesystem
+    openFromManifest(dirPath);
+
+    // Watch before enumerating so nothing written during the scan is missed;
+    // files reported by both are only added once
+    m_watcher->watch(dirPath);
+
+    // Enumerate in the background; the first batch replaces the current
+    // collection and later batches are appended as they arrive
+    m_scanner->scan(dirPath, m_recursiveScan);
+    statusBar()->showMessage(QString("Scanning %1...").arg(dirPath));
+}
+
+bool MainWindow::openFromManifest(const QString &dirPath)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    m_openedManifest = CollectionManifest::open(
+        CollectionManifest::manifestPath(dirPath, m_recursiveScan), dirPath);
+    if (!m_openedManifest || m_openedManifest->count() == 0) {
+        m_openedManifest.reset();
+        return false;
+    }
+
+    const int count = m_openedManifest->count();
+    QStringList paths;
+    QVector<QSize> sizes;
+    QByteArray formats;
+    QVector<ImageDetails> details;
+    paths.reserve(count);
+    sizes.reserve(count);
+    formats.reserve(count);
+    details.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const CollectionManifest::Entry entry = m_openedManifest->entry(i);
+        paths.append(entry.path);
+        sizes.append(entry.displaySize());
+        formats.append(char(entry.format));
+
+        // The status bar can describe the image before its file is touched
+        ImageDetails known;
+        known.pixelSize = entry.pixelSize;
+        known.fileSize = entry.fileSize;
+        known.format = entry.format;
+        details.append(known);
+    }
+
+    const QVector<int> ids = m_pathTable->intern(paths);
+    m_imageViewer->getImageLoader()->setImageFormats(ids, formats);
+    for (int id : ids) {
+        setId(m_collectionIds, id, true);
+    }
+    m_imageDetails->prefill(ids, details);
+    m_imageViewer->setImages(ids, sizes);
+    m_replacePending = false;
+
+    qDebug() << "Opened" << count << "images from manifest in" << timer.elapsed() << "ms";
+    return true;
+}
+
+void MainWindow::startManifestWrite()
+{
+    if (m_currentDirectory.isEmpty())
+        return;
+
+    m_manifestCancelled = std::make_shared<std::atomic_bool>(false);
+
+    // The task works on plain strings; they only exist while it runs
+    ManifestWriteTask *task = new ManifestWriteTask(m_currentDirectory, m_recursiveScan,
+                                                    m_pathTable->paths(m_imageViewer->imageIds()),
+                                                    m_openedManifest, m_manifestCancelled);
+    connect(task, &ManifestWriteTask::manifestWritten,
+            this, &MainWindow::onManifestWritten,
+            Qt::QueuedConnection);
+
+    // The task holds the old mapping for as long as it needs it
+    m_openedManifest.reset();
+
+    QThreadPool::globalInstance()->start(task);
+}
+
+void MainWindow::onManifestWritten(const QStringList &modifiedPaths, int count)
+{
+    Q_UNUSED(count);
+
+    QVector<int> stillPresent;
+    for (const QString &path : modifiedPaths) {
+        const int id = m_pathTable->find(path);
+        if (testId(m_collectionIds, id)) {
+            stillPresent.append(id);
+        }
+    }
+    if (!stillPresent.isEmpty()) {
+        invalidateImages(stillPresent);
+    }
+}
+
+void MainWindow::onPathsDiscovered(const QStringList &discoveredPaths, const QByteArray &formats)
+{
+    const QVector<int> discoveredIds = m_pathTable->intern(discoveredPaths);
+
+    // Decoders are told the detected format instead of probing for it
+    m_imageViewer->getImageLoader()->setImageFormats(discoveredIds, formats);
+
+    QVector<int> ids;
+    ids.reserve(discoveredIds.size());
+    for (int id : discoveredIds) {
+        if (m_openedManifest) {
+            setId(m_scanSeenIds, id, true);
+        }
+        if (!testId(m_collectionIds, id)) {
+            setId(m_collectionIds, id, true);
+            ids.append(id);
+        }
+    }
+    if (ids.isEmpty())
+        return;
+
+    const QVector<int> &current = m_imageViewer->imageIds();
+    if (m_replacePending || current.isEmpty()) {
+        // The first batch of a new collection replaces the previous one
+        m_replacePending = false;
+        m_imageViewer->setImages(ids);
+    } else if (m_currentDirectory.isEmpty() || m_recursiveScan) {
+        // Archive entries and tree scans arrive in their final order (a tree
+        // lists each directory's files before its subdirectories, which is
+        // not full-path order), dropped items in the order given
+        m_imageViewer->appendImages(ids);
+    } else {
+        // Batches of a flat directory are only sorted within themselves;
+        // each one is merged into the name order of what is already there
+        QVector<int> positions;
+        positions.reserve(ids.size());
+        auto first = current.cbegin();
+        for (int id : ids) {
+            const QString path = m_pathTable->path(id);
+            first = std::lower_bound(first, current.cend(), path, [this](int existing, const QString &name) {
+                return QString::compare(m_pathTable->path(existing), name, Qt::CaseInsensitive) < 0;
+            });
+            positions.append(int(first - current.cbegin()));
+        }
+        m_imageViewer->mergeImages(ids, positions);
+    }
+
+    statusBar()->showMessage(QString("Scanning... %1 images found").arg(m_imageViewer->imageIds().size()));
+}
+
+void MainWindow::onScanFinished(int totalCount)
+{
+    Q_UNUSED(totalCount);
+
+    if (m_openedManifest) {
+        // Images in the manifest the scan did not find again are gone
+        QStringList removed;
+        for (int id : m_imageViewer->imageIds()) {
+            if (!testId(m_scanSeenIds, id)) {
+                const QString path = m_pathTable->path(id);
+                if (!QFileInfo::exists(path)) {
+                    removed.append(path);
+                }
+            }
+        }
+        m_scanSeenIds.clear();
+        onWatchedFilesRemoved(removed);
+    }
+
+    if (m_replacePending || m_imageViewer->imageIds().isEmpty()) {
+        // Nothing found: the previous collection must not stay on screen
+        m_replacePending = false;
+        m_imageViewer->setImages(QVector<int>());
         QMessageBox::information(this, "No Images", "No image files found in the selected directory.");
+        statusBar()->showMessage("Ready");
+        return;
+    }
+
+    // Record the collection (and refresh anything changed since the last manifest)
+    startManifestWrite();
+
+    statusBar()->showMessage(QString("Loaded %1 images").arg(m_imageViewer->imageIds().size()));
+}
+
+void MainWindow::onWatchedFilesChanged(const QStringList &paths, const QByteArray &formats)
+{
+    const QVector<int> changedIds = m_pathTable->intern(paths);
+
+    // A rewritten file may also have changed format
+    m_imageViewer->getImageLoader()->setImageFormats(changedIds, formats);
+
+    QVector<int> added;
+    QVector<int> modified;
+    for (int id : changedIds) {
+        if (testId(m_collectionIds, id)) {
+            modified.append(id);
+        } else {
+            setId(m_collectionIds, id, true);
+            added.append(id);
+        }
+    }
+
+    if (!modified.isEmpty()) {
+        invalidateImages(modified);
+    }
+
+    if (!added.isEmpty()) {
+        // New captures go to the end, where a rig writing sequential names expects them
+        if (m_replacePending || m_imageViewer->imageIds().isEmpty()) {
+            m_replacePending = false;
+            m_imageViewer->setImages(added);
+        } else {
+            m_imageViewer->appendImages(added);
+        }
+        statusBar()->showMessage(QString("%1 new images (%2 total)")
+                                     .arg(added.size()).arg(m_imageViewer->imageIds().size()));
+    }
+}
+
+void MainWindow::onWatchedFilesRemoved(const QStringList &paths)
+{
+    QVector<int> removed;
+    for (const QString &path : paths) {
+        const int id = m_pathTable->find(path);
+        if (testId(m_collectionIds, id)) {
+            setId(m_collectionIds, id, false);
+            removed.append(id);
+        }
+    }
+    if (removed.isEmpty())
+        return;
+
+    m_imageViewer->removeImages(removed);
+
+    statusBar()->showMessage(QString("%1 images removed (%2 total)")
+                                 .arg(removed.size()).arg(m_imageViewer->imageIds().size()));
+}
+
+void MainWindow::onWatchRescanRequired()
+{
+    const QString dirPath = m_watcher->directory();
+    if (dirPath.isEmpty())
         return;
+
+    qDebug() << "Change events for" << dirPath << "were lost - rescanning";
+    loadImagesFromDirectory(dirPath);
+}
+
+void MainWindow::onWatchedDirectoryRemoved(const QString &dirPath)
+{
+    // Rescanning would find nothing; the images already loaded stay
+    // viewable, but the collection no longer mirrors a directory
+    m_scanner->cancel();
+    m_currentDirectory.clear();
+    m_openedManifest.reset();
+    if (m_manifestCancelled) {
+        m_manifestCancelled->store(true);
     }
 
-    m_imageViewer->setImagePaths(m_imagePaths);
-    statusBar()->showMessage(QString("Loaded %1 images").arg(m_imagePaths.size()));
+    statusBar()->showMessage(QString("%1 was removed or moved; no longer watching it").arg(dirPath));
 }
 
 void MainWindow::dragEnterEvent(QDragEnterEvent *event)
@@ -174,58 +646,137 @@ void MainWindow::dragEnterEvent(QDragEnterEvent *event)
 
 void MainWindow::dropEvent(QDropEvent *event)
 {
-    // Extract URLs from the mime data
+    // Only collect the paths here; validation and folder expansion run in
+    // the background so large drops never block the UI
     const QList<QUrl> urls = event->mimeData()->urls();
+    QStringList items;
+    items.reserve(urls.size());
+    for (const QUrl &url : urls) {
+        if (url.isLocalFile()) {
+            items.append(url.toLocalFile());
+        } else if (HttpImageSource::isHttpPath(url.toString())) {
+            // Images dragged from a browser or the object-store gateway
+            items.append(url.toString());
+        }
+    }
 
-    // Container for valid image paths
-    QList<QString> imagePaths;  // Must use QList to match ImageViewer method
+    // Ctrl+drop adds to the collection; a plain drop replaces it
+    const bool append = event->modifiers() & Qt::ControlModifier;
+    if (items.size() == 1 && ZipArchive::isArchiveFile(items.first())
+        && QFileInfo(items.first()).isFile() && !append) {
+        // A single dropped archive opens like a directory
+        loadImagesFromArchive(items.first());
+    } else {
+        ingestItems(items, append);
+    }
 
-    // Validate file extensions for all dropped items
-    QStringList validExtensions = {"jpg", "jpeg", "png", "bmp", "gif", "webp"};
+    // Accept the drop event
+    event->acceptProposedAction();
+}
 
-    for (const QUrl &url : urls) {
-        // Convert URL to local file path
-        QString filePath = url.toLocalFile();
-        QFileInfo fileInfo(filePath);
+void MainWindow::openUrls()
+{
+    bool ok = false;
+    const QString text = QInputDialog::getMultiLineText(
+        this,
+        "Open URLs",
+        "Image URLs (http://), one per line:",
+        QString(),
+        &ok
+        );
 
-        // Check if the file exists and has valid image extension
-        if (fileInfo.exists() && fileInfo.isFile()) {
-            QString extension = fileInfo.suffix().toLower();
+    if (ok) {
+        ingestItems(text.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts), false);
+    }
+}
 
-            if (validExtensions.contains(extension)) {
-                imagePaths.append(filePath);
-            }
+void MainWindow::ingestItems(const QStringList &items, bool append)
+{
+    if (items.isEmpty())
+        return;
+
+    if (append) {
+        // The collection no longer mirrors one directory, so it gets no
+        // manifest; the directory's scan and watch stop with it, or their
+        // late results would be applied to the mixed collection
+        m_scanner->cancel();
+        m_watcher->stop();
+        m_currentDirectory.clear();
+        m_openedManifest.reset();
+        if (m_manifestCancelled) {
+            m_manifestCancelled->store(true);
         }
+    } else {
+        // New items replace whatever is still being scanned or watched
+        m_scanner->cancel();
+        m_watcher->stop();
+        m_currentDirectory.clear();
+        m_openedManifest.reset();
+        m_openArchive.reset();
+        if (m_manifestCancelled) {
+            m_manifestCancelled->store(true);
+        }
+
+        // The current images stay on screen until the first new batch replaces them
+        m_collectionIds.clear();
+        m_replacePending = true;
+        m_shuffle = ShuffleOrder();
+        m_scanSeenIds.clear();
+        m_imageViewer->getImageLoader()->clearImageFormats();
+        m_imageDetails->clear();
     }
 
-    // Process valid image paths
-    if (!imagePaths.isEmpty()) {
-        // Clear existing images
-        m_imagePaths.clear();
-        m_imagePaths = imagePaths;
+    m_dropIngestor->ingest(items);
+    statusBar()->showMessage(QString("Adding %1 items...").arg(items.size()));
+}
 
-        // Update image viewer with new paths
-        m_imageViewer->setImagePaths(imagePaths);  // Make sure this is QList<QString>
-        statusBar()->showMessage(QString("Loaded %1 images").arg(m_imagePaths.size()));
+void MainWindow::onIngestFinished(int totalCount)
+{
+    if (m_replacePending || (totalCount == 0 && m_imageViewer->imageIds().isEmpty())) {
+        m_replacePending = false;
+        m_imageViewer->setImages(QVector<int>());
+        statusBar()->showMessage("No images among the dropped items");
+        return;
     }
 
-    // Accept the drop event
-    event->acceptProposedAction();
+    statusBar()->showMessage(QString("Added %1 dropped images (%2 total)")
+                                 .arg(totalCount).arg(m_imageViewer->imageIds().size()));
 }
 
 void MainWindow::navigateToRandomImage()
 {
-    if (m_imagePaths.isEmpty())
+    const QVector<int> &ids = m_imageViewer->imageIds();
+    if (ids.isEmpty())
         return;
 
-    // Generate random index using secure random number generation
-    int randomIndex = QRandomGenerator::global()->bounded(m_imagePaths.size());
+    // Only images still in the collection and shown by the view are dealt
+    auto accept = [this](int id) {
+        return testId(m_collectionIds, id) && m_imageViewer->isImageShown(id);
+    };
+    const int id = m_shuffle.next(ids, accept);
+    const int randomIndex = m_imageViewer->imageIndex(id);
+    if (randomIndex < 0)
+        return;
 
     // Delegate to image viewer for centering operation
     m_imageViewer->centerOnImageIndex(randomIndex);
 
+    // The next picks are already known; decode them while this one is viewed
+    QVector<int> upcoming;
+    for (int upcomingId : m_shuffle.peek(ShufflePrefetch, accept)) {
+        upcoming.append(m_imageViewer->imageIndex(upcomingId));
+    }
+    m_imageViewer->scheduleImages(ImageViewer::ShuffleSchedule, upcoming, ShufflePriority);
+
+    // A running slideshow continues from here, even while the view is
+    // still gliding towards it
+    if (m_slideshowActive) {
+        scheduleSlideshowImages(randomIndex);
+    }
+
     // Update status bar
-    statusBar()->showMessage(QString("Image %1 of %2").arg(randomIndex + 1).arg(m_imagePaths.size()));
+    statusBar()->showMessage(QString("Image %1 of %2 (%3 left before repeating)")
+                                 .arg(randomIndex + 1).arg(ids.size()).arg(m_shuffle.remaining()));
 }
 
 void MainWindow::toggleSlideshow()
@@ -238,20 +789,81 @@ void MainWindow::toggleSlideshow()
     }
 
     m_slideshowActive = !m_slideshowActive;
+    m_slideshowWaiting = false;
 
     if (m_slideshowActive) {
+        m_slideshowMissedDeadlines = 0;
         m_slideshowTimer->start(m_slideshowInterval);
+        scheduleSlideshowImages();
         statusBar()->showMessage("Slideshow started");
     } else {
         m_slideshowTimer->stop();
-        statusBar()->showMessage("Slideshow stopped");
+        m_imageViewer->clearImageSchedule(ImageViewer::SlideshowSchedule);
+        statusBar()->showMessage(QString("Slideshow stopped (%1 missed deadlines)")
+                                     .arg(m_slideshowMissedDeadlines));
     }
 }
 
 void MainWindow::slideshowAdvance()
 {
-    // Advance to next image
-    m_imageViewer->centerOnNextImage();
+    if (m_slideshowWaiting)
+        return;
+
+    if (m_imageViewer->isNextImageReady()) {
+        showNextSlide();
+        return;
+    }
+
+    // Missed: keep the current slide up rather than show a placeholder, and
+    // move on as soon as the decode lands
+    ++m_slideshowMissedDeadlines;
+    m_slideshowWaiting = true;
+    m_slideshowLateClock.start();
+    m_slideshowTimer->stop();
+    qDebug() << "Slideshow deadline missed; next image not decoded after" << m_slideshowInterval << "ms";
+    statusBar()->showMessage(QString("Slideshow waiting for the next image (%1 missed deadlines)")
+                                 .arg(m_slideshowMissedDeadlines));
+
+    // Requests dropped since the last schedule (a cancelled window, a failed
+    // read) are issued again
+    scheduleSlideshowImages();
+}
+
+void MainWindow::onSlideshowImageLoaded()
+{
+    if (!m_slideshowActive || !m_slideshowWaiting || !m_imageViewer->isNextImageReady())
+        return;
+
+    qDebug() << "Slideshow resumed" << m_slideshowLateClock.elapsed() << "ms after the deadline";
+    m_slideshowWaiting = false;
+    showNextSlide();
+}
+
+void MainWindow::showNextSlide()
+{
+    const int slide = m_imageViewer->nextImageIndex();
+
+    // The transition plays within the interval, so keep it well short of it
+    m_imageViewer->transitionToNextImage(m_slideshowTransition,
+                                         qMin(int(SlideshowTransitionMs), m_slideshowInterval / 2));
+
+    // The next slide gets a full interval from now, however late this one
+    // was; deadlines count from the slide just shown, wherever the view is
+    // in its glide
+    m_slideshowTimer->start(m_slideshowInterval);
+    scheduleSlideshowImages(slide);
+}
+
+void MainWindow::scheduleSlideshowImages(int fromIndex)
+{
+    // Slide k is due k intervals from now; request everything due within
+    // the horizon, so slow storage gets as much lead time as a short
+    // interval allows
+    const int lookahead = qBound(int(SlideshowMinLookahead),
+                                 (int(SlideshowHorizonMs) + m_slideshowInterval - 1) / m_slideshowInterval,
+                                 int(SlideshowMaxLookahead));
+    m_imageViewer->scheduleUpcomingImages(ImageViewer::SlideshowSchedule, lookahead, SlideshowPriority,
+                                          fromIndex);
 }
 
 void MainWindow::setSlideshowInterval()
@@ -264,6 +876,7 @@ void MainWindow::setSlideshowInterval()
         m_slideshowInterval = interval * 1000;
         if (m_slideshowActive) {
             m_slideshowTimer->setInterval(m_slideshowInterval);
+            scheduleSlideshowImages();
         }
         statusBar()->showMessage(QString("Slideshow interval set to %1 seconds").arg(interval));
     }
@@ -271,21 +884,46 @@ void MainWindow::setSlideshowInterval()
 
 void MainWindow::updateImageInfo(int index)
 {
-    if (index < 0 || index >= m_imagePaths.size()) {
+    const QVector<int> &ids = m_imageViewer->imageIds();
+    if (index < 0 || index >= ids.size()) {
+        m_infoImageIndex = -1;
+        m_infoImageId = -1;
         m_imageInfoLabel->setText("");
         return;
     }
 
-    QString imagePath = m_imagePaths[index];
-    QFileInfo fileInfo(imagePath);
-    QImageReader reader(imagePath);
-    QSize dimensions = reader.size();
+    const int id = ids[index];
+    const QString imagePath = m_pathTable->path(id);
+    m_infoImageIndex = index;
+    m_infoImageId = id;
+
+    // Only what is already known is shown; the file is read on a worker and
+    // the label filled in when that finishes, so navigation never waits on it
+    ImageDetails details = m_imageDetails->details(id);
+    m_imageDetails->request(id, imagePath);
+    if (details.format == ImageFormat::Unknown) {
+        details.format = m_imageViewer->getImageLoader()->imageFormat(id);
+    }
+
+    // Name and suffix come from the path string alone
+    const QFileInfo fileInfo(imagePath);
+    const QString formatText = details.format != ImageFormat::Unknown
+                                   ? QString::fromLatin1(FormatSniffer::formatName(details.format)).toUpper()
+                                   : fileInfo.suffix().toUpper();
 
-    // Format file size
-    qint64 bytes = fileInfo.size();
+    const QString pending = details.complete ? QString("?") : QString(QChar(0x2026));
+    const QString dimensionsText = details.pixelSize.isValid()
+                                       ? QString("%1x%2").arg(details.pixelSize.width())
+                                                         .arg(details.pixelSize.height())
+                                       : pending;
+
+    // Format file size; archive entries report their uncompressed size
+    const qint64 bytes = details.fileSize;
     QString sizeText;
 
-    if (bytes > 1024*1024) {
+    if (bytes < 0) {
+        sizeText = pending;
+    } else if (bytes > 1024*1024) {
         sizeText = QString::number(bytes/(1024.0*1024.0), 'f', 2) + " MB";
     } else if (bytes > 1024) {
         sizeText = QString::number(bytes/1024.0, 'f', 2) + " KB";
@@ -294,16 +932,58 @@ void MainWindow::updateImageInfo(int index)
     }
 
     // Create info text
-    QString infoText = QString("%1 (%2) | %3x%4 | %5")
+    QString infoText = QString("%1 (%2) | %3 | %4")
                            .arg(fileInfo.fileName())
-                           .arg(fileInfo.suffix().toUpper())
-                           .arg(dimensions.width())
-                           .arg(dimensions.height())
+                           .arg(formatText)
+                           .arg(dimensionsText)
                            .arg(sizeText);
 
+    if (!details.dateTaken.isEmpty()) {
+        infoText += " | " + details.dateTaken;
+    }
+    if (!details.camera.isEmpty()) {
+        infoText += " | " + details.camera;
+    }
+
+    // Review metadata; one indexed lookup each
+    MetadataStore *store = m_imageViewer->metadataStore();
+    const int rating = store->rating(imagePath);
+    if (rating > 0) {
+        infoText += " | " + QString(rating, QChar(0x2605));
+    }
+    const int flag = store->flag(imagePath);
+    if (flag == MetadataStore::Picked) {
+        infoText += " | Picked";
+    } else if (flag == MetadataStore::Rejected) {
+        infoText += " | Rejected";
+    }
+    const QStringList tags = store->tags(imagePath);
+    if (!tags.isEmpty()) {
+        infoText += " | " + tags.join(", ");
+    }
+
     m_imageInfoLabel->setText(infoText);
 }
 
+void MainWindow::onImageDetailsLoaded(int id)
+{
+    // Details of images navigated past are only cached
+    if (id != m_infoImageId)
+        return;
+
+    updateImageInfo(m_infoImageIndex);
+}
+
+void MainWindow::invalidateImages(const QVector<int> &ids)
+{
+    m_imageViewer->invalidateImages(ids);
+    m_imageDetails->invalidate(ids);
+
+    if (ids.contains(m_infoImageId)) {
+        updateImageInfo(m_infoImageIndex);
+    }
+}
+
 void MainWindow::showKeyboardShortcuts()
 {
     // Create shortcuts dialog
@@ -339,6 +1019,14 @@ void MainWindow::showKeyboardShortcuts()
         {"F", "Toggle Current Image as Favorite"},
         {"Middle-Click", "Toggle Current Image as Favorite"},
         {"Ctrl + F", "Toggle Favorites Mode"},
+        {"1 - 5", "Rate Current Image"},
+        {"0", "Clear Rating"},
+        {"P / X / U", "Pick / Reject / Unflag Current Image"},
+        {"T", "Tag Current Image"},
+        {"Ctrl + Shift + F", "Filter by Rating, Flag or Tag"},
+        {"Drop Files/Folders", "Open Dropped Images"},
+        {"Ctrl + Drop", "Add Dropped Images to Collection"},
+        {"Drop Zip/CBZ Archive", "Open Images in the Archive"},
         {"F1", "Show Keyboard Shortcuts"}
     };
     table->setRowCount(shortcuts.size());
@@ -378,3 +1066,70 @@ void MainWindow::toggleCurrentImageFavorite()
 {
     m_imageViewer->toggleCurrentImageFavorite();
 }
+
+void MainWindow::tagCurrentImage()
+{
+    bool ok = false;
+    const QString tag = QInputDialog::getText(this, "Add Tag", "Tag:", QLineEdit::Normal,
+                                              QString(), &ok).trimmed();
+    if (ok && !tag.isEmpty()) {
+        m_imageViewer->addTagToCurrentImage(tag);
+    }
+}
+
+void MainWindow::tagShownImages()
+{
+    bool ok = false;
+    const QString tag = QInputDialog::getText(this, "Tag Shown Images", "Tag:", QLineEdit::Normal,
+                                              QString(), &ok).trimmed();
+    if (!ok || tag.isEmpty())
+        return;
+
+    const int count = m_imageViewer->tagShownImages(tag);
+    statusBar()->showMessage(QString("Tagged %1 images with \"%2\"").arg(count).arg(tag));
+}
+
+void MainWindow::showMetadataFilter()
+{
+    const MetadataStore::Filter &current = m_imageViewer->metadataFilter();
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Filter Images");
+
+    QFormLayout *layout = new QFormLayout(&dialog);
+
+    QSpinBox *ratingBox = new QSpinBox(&dialog);
+    ratingBox->setRange(0, MetadataStore::MaxRating);
+    ratingBox->setSpecialValueText("Any");
+    ratingBox->setValue(current.minRating);
+    layout->addRow("Minimum rating:", ratingBox);
+
+    QComboBox *flagBox = new QComboBox(&dialog);
+    flagBox->addItem("Any", -1);
+    flagBox->addItem("Unflagged", int(MetadataStore::Unflagged));
+    flagBox->addItem("Picked", int(MetadataStore::Picked));
+    flagBox->addItem("Rejected", int(MetadataStore::Rejected));
+    flagBox->setCurrentIndex(qMax(0, flagBox->findData(current.flag)));
+    layout->addRow("Flag:", flagBox);
+
+    QLineEdit *tagEdit = new QLineEdit(current.tag, &dialog);
+    tagEdit->setPlaceholderText("Any");
+    layout->addRow("Tag:", tagEdit);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    layout->addRow(buttons);
+
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    MetadataStore::Filter filter;
+    filter.minRating = ratingBox->value();
+    filter.flag = flagBox->currentData().toInt();
+    filter.tag = tagEdit->text().trimmed();
+
+    // The view changes once the query is done; see metadataFilterApplied
+    statusBar()->showMessage("Filtering...");
+    m_imageViewer->setMetadataFilter(filter);
+}
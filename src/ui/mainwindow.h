@@ -5,9 +5,21 @@
 #include <QMainWindow>
 #include <QString>
 #include <QVector>
+#include <QSet>
+#include <QBitArray>
+#include <QElapsedTimer>
+#include "imageviewer.h"
+#include "../core/shuffleorder.h"
+#include <atomic>
+#include <memory>
 
 // Forward declarations
-class ImageViewer;
+class DirectoryScanner;
+class DirectoryWatcher;
+class CollectionManifest;
+class ZipArchive;
+class PathTable;
+class ImageDetailsCache;
 class QLabel;
 class QTimer;
 class QDragEnterEvent;
@@ -41,6 +53,16 @@ private slots:
      */
     void openDirectory();
 
+    /**
+     * @brief Opens a zip or CBZ archive of images.
+     */
+    void openArchive();
+
+    /**
+     * @brief Opens a list of image URLs.
+     */
+    void openUrls();
+
     /**
      * @brief Navigates to a random image.
      */
@@ -53,9 +75,17 @@ private slots:
 
     /**
      * @brief Advances to the next image in slideshow mode.
+     *
+     * If the next image is not decoded by its deadline, the miss is
+     * reported and the current image stays up until it is.
      */
     void slideshowAdvance();
 
+    /**
+     * @brief Advances a slideshow waiting on a missed deadline once the image is ready.
+     */
+    void onSlideshowImageLoaded();
+
     /**
      * @brief Sets the interval for slideshow transitions.
      */
@@ -76,12 +106,83 @@ private slots:
      */
     void toggleCurrentImageFavorite();
 
+    /**
+     * @brief Asks for a tag and adds it to the current image.
+     */
+    void tagCurrentImage();
+
+    /**
+     * @brief Asks for a tag and adds it to every image the view shows.
+     */
+    void tagShownImages();
+
+    /**
+     * @brief Asks for rating, flag and tag conditions and filters the view by them.
+     */
+    void showMetadataFilter();
+
     /**
      * @brief Updates image information in status bar.
      * @param index The index of the current image.
      */
     void updateImageInfo(int index);
 
+    /**
+     * @brief Refreshes the image information once the details of the shown image arrive.
+     * @param id The image ID whose details were read.
+     */
+    void onImageDetailsLoaded(int id);
+
+    /**
+     * @brief Adds a batch of paths found by the directory scanner.
+     * @param paths The discovered image paths.
+     * @param formats One ImageFormat value per path.
+     */
+    void onPathsDiscovered(const QStringList &paths, const QByteArray &formats);
+
+    /**
+     * @brief Reports the result of a completed directory scan.
+     * @param totalCount Number of images found.
+     */
+    void onScanFinished(int totalCount);
+
+    /**
+     * @brief Reports the result of a drag-and-drop ingestion.
+     * @param totalCount Number of images found among the dropped items.
+     */
+    void onIngestFinished(int totalCount);
+
+    /**
+     * @brief Adds new files and refreshes rewritten ones in the open directory.
+     * @param paths The created or rewritten image paths.
+     * @param formats One ImageFormat value per path.
+     */
+    void onWatchedFilesChanged(const QStringList &paths, const QByteArray &formats);
+
+    /**
+     * @brief Drops files that disappeared from the open directory.
+     * @param paths The removed image paths.
+     */
+    void onWatchedFilesRemoved(const QStringList &paths);
+
+    /**
+     * @brief Re-reads the open directory after change events were lost.
+     */
+    void onWatchRescanRequired();
+
+    /**
+     * @brief Keeps the collection viewable after its directory was deleted or moved.
+     * @param dirPath The directory that went away.
+     */
+    void onWatchedDirectoryRemoved(const QString &dirPath);
+
+    /**
+     * @brief Refreshes images the manifest validation found changed.
+     * @param modifiedPaths Paths whose file changed since the previous manifest.
+     * @param count Number of entries written.
+     */
+    void onManifestWritten(const QStringList &modifiedPaths, int count);
+
 private:
     /**
      * @brief Sets up the user interface.
@@ -94,12 +195,87 @@ private:
      */
     void loadImagesFromDirectory(const QString &dirPath);
 
+    /**
+     * @brief Loads the images inside a zip or CBZ archive.
+     * @param archivePath The path to the archive.
+     */
+    void loadImagesFromArchive(const QString &archivePath);
+
+    /**
+     * @brief Adds files, directories and URLs to the collection in the background.
+     * @param items The items, in the order they should appear.
+     * @param append Whether to add to the collection instead of replacing it.
+     */
+    void ingestItems(const QStringList &items, bool append);
+
+    /**
+     * @brief Shows the collection stored in a directory's manifest, if there is one.
+     * @param dirPath The absolute directory path.
+     * @return True if the collection was opened from the manifest.
+     */
+    bool openFromManifest(const QString &dirPath);
+
+    /**
+     * @brief Validates the collection and rewrites its manifest in the background.
+     */
+    void startManifestWrite();
+
+    /**
+     * @brief Drops decoded images and cached details of files that changed on disk.
+     * @param ids IDs of the changed images.
+     */
+    void invalidateImages(const QVector<int> &ids);
+
+    /**
+     * @brief Hands the slideshow's schedule to the loader.
+     *
+     * Image k after the current one is due k intervals from now. All
+     * images due within the preload horizon are requested, earliest
+     * deadline at the highest priority.
+     *
+     * @param fromIndex Collection index of the slide just shown; -1 for the
+     *                  image the view is on.
+     */
+    void scheduleSlideshowImages(int fromIndex = -1);
+
+    /**
+     * @brief Moves the slideshow on and starts the next interval.
+     */
+    void showNextSlide();
+
+    static const int SlideshowHorizonMs = 10000; ///< How far ahead the slideshow preloads
+    static const int SlideshowMinLookahead = 2;  ///< Images preloaded regardless of the interval
+    static const int SlideshowMaxLookahead = 16; ///< Cap on images held for the slideshow
+    static const int SlideshowPriority = 32;     ///< Loader priority of the next slide
+    static const int SlideshowTransitionMs = 600; ///< Length of a slideshow transition
+    static const int ShufflePrefetch = 3;        ///< Random picks kept decoded ahead of time
+    static const int ShufflePriority = 32;       ///< Loader priority of the next random pick
+
     ImageViewer *m_imageViewer;                ///< The image viewer widget
-    QVector<QString> m_imagePaths;             ///< Paths to images
-    QTimer *m_slideshowTimer;                  ///< Timer for slideshow
+    DirectoryScanner *m_scanner;               ///< Background directory enumeration
+    DirectoryScanner *m_dropIngestor;          ///< Background validation of dropped items
+    DirectoryWatcher *m_watcher;               ///< Live updates for the open directory
+    PathTable *m_pathTable;                    ///< The viewer's path table, shared with it
+    ImageDetailsCache *m_imageDetails;         ///< Details shown in the status bar, read off the GUI thread
+    QBitArray m_collectionIds;                 ///< Bit per image ID in the collection, for change events
+    bool m_replacePending = false;             ///< The viewer still shows the previous collection
+    QString m_currentDirectory;                ///< Directory the collection was opened from
+    std::shared_ptr<CollectionManifest> m_openedManifest; ///< Manifest being validated by the running scan
+    QBitArray m_scanSeenIds;                   ///< Bit per image ID the validating scan has found so far
+    ShuffleOrder m_shuffle;                    ///< Order of random navigation, dealt without repeats
+    std::shared_ptr<std::atomic_bool> m_manifestCancelled; ///< Cancels the running manifest write
+    std::shared_ptr<ZipArchive> m_openArchive; ///< Archive being viewed; keeps its index open for the loaders
+    QTimer *m_slideshowTimer = nullptr;        ///< Timer for slideshow, created on first use
     int m_slideshowInterval = 3000;            ///< Slideshow interval in ms
     bool m_slideshowActive = false;            ///< Whether slideshow is active
+    bool m_slideshowWaiting = false;           ///< Whether the next slide missed its deadline and is awaited
+    QElapsedTimer m_slideshowLateClock;        ///< Time since the awaited slide was due
+    int m_slideshowMissedDeadlines = 0;        ///< Slides not ready when due since the slideshow started
+    ImageViewer::Transition m_slideshowTransition = ImageViewer::NoTransition; ///< Transition between slides
+    bool m_recursiveScan = false;              ///< Whether opening a directory includes subdirectories
     QLabel *m_imageInfoLabel;                  ///< Label for image information
+    int m_infoImageIndex = -1;                 ///< Collection index of the image described by the label
+    int m_infoImageId = -1;                    ///< ID of that image, -1 if none
 
 protected:
     /**
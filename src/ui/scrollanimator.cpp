@@ -0,0 +1,84 @@
+// scrollanimator.cpp
+#include "scrollanimator.h"
+
+#include <QtMath>
+
+ScrollAnimator::ScrollAnimator(QObject *parent)
+    : QAbstractAnimation(parent)
+{
+}
+
+void ScrollAnimator::scrollTo(qint64 target)
+{
+    target = qBound(m_minimum, target, qMax(m_minimum, m_maximum));
+
+    if (target == m_target && isScrolling())
+        return;
+
+    m_target = target;
+    emit targetChanged(m_target);
+
+    if (!isScrolling()) {
+        m_lastTime = 0;
+        start();
+    }
+}
+
+void ScrollAnimator::scrollBy(qint64 delta)
+{
+    // Accumulate on the pending target so momentum is not lost
+    qint64 base = isScrolling() ? m_target : position();
+    scrollTo(base + delta);
+}
+
+void ScrollAnimator::setPosition(qint64 position)
+{
+    if (isScrolling())
+        stop();
+
+    m_position = static_cast<double>(position);
+    m_velocity = 0.0;
+    m_target = position;
+}
+
+void ScrollAnimator::setBounds(qint64 minimum, qint64 maximum)
+{
+    m_minimum = minimum;
+    m_maximum = maximum;
+
+    // Keep a running animation from heading past the new range
+    if (isScrolling() && (m_target < m_minimum || m_target > m_maximum)) {
+        m_target = qBound(m_minimum, m_target, qMax(m_minimum, m_maximum));
+        emit targetChanged(m_target);
+    }
+}
+
+void ScrollAnimator::updateCurrentTime(int currentTime)
+{
+    // Clamp the step so a stalled event loop does not cause a visible jump
+    double dt = qBound(0.0, (currentTime - m_lastTime) / 1000.0, 0.05);
+    m_lastTime = currentTime;
+
+    if (dt <= 0.0)
+        return;
+
+    // Closed-form critically damped spring: exact for any step size, so the
+    // motion is identical regardless of the display refresh rate
+    double error = m_position - static_cast<double>(m_target);
+    double decay = qExp(-m_omega * dt);
+    double k = m_velocity + m_omega * error;
+
+    double newError = (error + k * dt) * decay;
+    m_velocity = (m_velocity - m_omega * k * dt) * decay;
+    m_position = static_cast<double>(m_target) + newError;
+
+    if (qAbs(newError) < 0.5 && qAbs(m_velocity) < 10.0) {
+        m_position = static_cast<double>(m_target);
+        m_velocity = 0.0;
+        emit positionChanged(m_target);
+        stop();
+        return;
+    }
+
+    emit positionChanged(position());
+}
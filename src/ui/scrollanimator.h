@@ -0,0 +1,109 @@
+// scrollanimator.h
+#ifndef SCROLLANIMATOR_H
+#define SCROLLANIMATOR_H
+
+#include <QAbstractAnimation>
+
+/**
+ * @brief The ScrollAnimator class animates a scroll position toward a target.
+ *
+ * Driven by Qt's animation clock, so it advances once per display frame. The
+ * motion follows a critically damped spring: repeated scroll requests move the
+ * target while the current velocity is carried over, which gives wheel and
+ * keyboard navigation a smooth, inertial feel without overshooting.
+ */
+class ScrollAnimator : public QAbstractAnimation
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs a scroll animator.
+     * @param parent The parent object.
+     */
+    explicit ScrollAnimator(QObject *parent = nullptr);
+
+    /**
+     * @brief The animation runs until the target is reached.
+     * @return Always -1 (undetermined duration).
+     */
+    int duration() const override { return -1; }
+
+    /**
+     * @brief Animates toward an absolute position.
+     * @param target The target scroll position.
+     */
+    void scrollTo(qint64 target);
+
+    /**
+     * @brief Moves the target by a relative amount.
+     *
+     * While an animation is running the delta accumulates on the pending
+     * target, so fast repeated input keeps its momentum.
+     *
+     * @param delta The distance to add to the target.
+     */
+    void scrollBy(qint64 delta);
+
+    /**
+     * @brief Jumps to a position without animating and stops any motion.
+     * @param position The new scroll position.
+     */
+    void setPosition(qint64 position);
+
+    /**
+     * @brief Sets the range the target is clamped to.
+     * @param minimum The smallest allowed position.
+     * @param maximum The largest allowed position.
+     */
+    void setBounds(qint64 minimum, qint64 maximum);
+
+    /**
+     * @brief Gets the current animated position.
+     * @return The current position.
+     */
+    qint64 position() const { return qRound64(m_position); }
+
+    /**
+     * @brief Gets the position the animation is heading to.
+     * @return The target position.
+     */
+    qint64 target() const { return m_target; }
+
+    /**
+     * @brief Checks whether an animation is in progress.
+     * @return True while animating.
+     */
+    bool isScrolling() const { return state() == QAbstractAnimation::Running; }
+
+signals:
+    /**
+     * @brief Signal emitted once per frame with the new position.
+     * @param position The animated scroll position.
+     */
+    void positionChanged(qint64 position);
+
+    /**
+     * @brief Signal emitted when a new target is set.
+     * @param target The new target position.
+     */
+    void targetChanged(qint64 target);
+
+protected:
+    /**
+     * @brief Advances the spring simulation to the given time.
+     * @param currentTime The animation time in milliseconds.
+     */
+    void updateCurrentTime(int currentTime) override;
+
+private:
+    double m_position = 0.0;        ///< Current position
+    double m_velocity = 0.0;        ///< Current velocity in px/s
+    qint64 m_target = 0;            ///< Target position
+    qint64 m_minimum = 0;           ///< Lower bound for the target
+    qint64 m_maximum = 0;           ///< Upper bound for the target
+    int m_lastTime = 0;             ///< Animation time of the previous frame
+    const double m_omega = 14.0;    ///< Spring angular frequency (higher settles faster)
+};
+
+#endif // SCROLLANIMATOR_H
@@ -0,0 +1,177 @@
+// transitionoverlay.cpp
+#include "transitionoverlay.h"
+#include "../core/blendkernel.h"
+
+#include <QPainter>
+#include <QTimer>
+#include <QScreen>
+#include <QDebug>
+#include <cstring>
+
+TransitionOverlay::TransitionOverlay(QWidget *parent)
+    : QWidget(parent)
+    , m_frameTimer(new QTimer(this))
+{
+    // Every frame covers the whole overlay; input goes to the view underneath
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    hide();
+
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_frameTimer, &QTimer::timeout, this, &TransitionOverlay::onFrameTick);
+
+    // One worker: frames are composited strictly one after the other
+    m_compositor.setMaxThreadCount(1);
+}
+
+TransitionOverlay::~TransitionOverlay()
+{
+    m_compositor.waitForDone();
+}
+
+void TransitionOverlay::start(const QImage &from, const QImage &to, Style style, int durationMs)
+{
+    finish();
+
+    // One 32-bit format for both ends, as the kernel expects
+    m_from = from.convertToFormat(QImage::Format_RGB32);
+    m_to = to.convertToFormat(QImage::Format_RGB32);
+    if (m_from.isNull() || m_from.size() != m_to.size()) {
+        m_from = QImage();
+        m_to = QImage();
+        emit finished();
+        return;
+    }
+
+    // The first frame presented is the old view itself
+    m_frames[0] = m_from.copy();
+    m_frames[1] = QImage(m_from.size(), QImage::Format_RGB32);
+    m_frames[1].setDevicePixelRatio(m_from.devicePixelRatio());
+    m_front = 0;
+    m_frontProgress = 0.0;
+    m_backReady = false;
+    m_presentedFrames = 0;
+    m_style = style;
+    m_durationMs = qMax(1, durationMs);
+
+    setGeometry(parentWidget() ? parentWidget()->rect() : rect());
+    raise();
+    show();
+
+    qreal refreshRate = screen() ? screen()->refreshRate() : 60.0;
+    if (refreshRate <= 0.0) {
+        refreshRate = 60.0;
+    }
+    const int interval = qMax(1, qRound(1000.0 / refreshRate));
+
+    m_clock.start();
+    m_frameTimer->start(interval);
+    renderFrame(qMin<qreal>(1.0, qreal(interval) / m_durationMs));
+}
+
+void TransitionOverlay::finish()
+{
+    if (!isVisible())
+        return;
+
+    m_frameTimer->stop();
+
+    // Drop the frame in flight; its completion no longer matches
+    ++m_generation;
+    m_compositor.waitForDone();
+    m_rendering = false;
+    m_backReady = false;
+
+    qDebug() << "Transition ended after" << m_clock.elapsed() << "ms," << m_presentedFrames
+             << "frames presented, blend kernel:" << blendKernelName();
+
+    hide();
+    m_from = QImage();
+    m_to = QImage();
+    m_frames[0] = QImage();
+    m_frames[1] = QImage();
+
+    emit finished();
+}
+
+void TransitionOverlay::onFrameTick()
+{
+    // Swap in the frame composited since the last tick, if any; a frame
+    // that is not ready yet just leaves the previous one up for a tick
+    if (m_backReady) {
+        m_front = 1 - m_front;
+        m_frontProgress = m_backProgress;
+        m_backReady = false;
+        ++m_presentedFrames;
+        update();
+    }
+
+    if (m_frontProgress >= 1.0) {
+        finish();
+        return;
+    }
+
+    // Aim at the next tick, which is when this frame will be presented
+    if (!m_rendering && !m_backReady) {
+        renderFrame(qMin<qreal>(1.0, qreal(m_clock.elapsed() + m_frameTimer->interval()) / m_durationMs));
+    }
+}
+
+void TransitionOverlay::renderFrame(qreal progress)
+{
+    m_rendering = true;
+
+    // The worker owns the back frame until it reports back; the GUI thread
+    // only ever touches the front one
+    QImage *target = &m_frames[1 - m_front];
+    const QImage from = m_from;
+    const QImage to = m_to;
+    const Style style = m_style;
+    const int generation = m_generation;
+    const qreal eased = progress * progress * (3.0 - 2.0 * progress);
+
+    m_compositor.start([this, target, from, to, style, eased, progress, generation]() {
+        composite(*target, from, to, style, eased);
+
+        QMetaObject::invokeMethod(this, [this, progress, generation]() {
+            if (generation != m_generation)
+                return;
+            m_rendering = false;
+            m_backReady = true;
+            m_backProgress = progress;
+        }, Qt::QueuedConnection);
+    });
+}
+
+void TransitionOverlay::composite(QImage &target, const QImage &from, const QImage &to, Style style, qreal progress)
+{
+    const int width = from.width();
+    const int height = from.height();
+
+    if (style == Crossfade) {
+        const int alpha = qRound(progress * 256);
+        for (int y = 0; y < height; ++y) {
+            blendPixels(reinterpret_cast<const quint32 *>(from.constScanLine(y)),
+                        reinterpret_cast<const quint32 *>(to.constScanLine(y)),
+                        reinterpret_cast<quint32 *>(target.scanLine(y)),
+                        width, alpha);
+        }
+        return;
+    }
+
+    // Slide: the old view moves out to the left and the new one follows it in
+    const int shift = qBound(0, qRound(progress * width), width);
+    for (int y = 0; y < height; ++y) {
+        const quint32 *fromRow = reinterpret_cast<const quint32 *>(from.constScanLine(y));
+        const quint32 *toRow = reinterpret_cast<const quint32 *>(to.constScanLine(y));
+        quint32 *row = reinterpret_cast<quint32 *>(target.scanLine(y));
+        std::memcpy(row, fromRow + shift, size_t(width - shift) * sizeof(quint32));
+        std::memcpy(row + (width - shift), toRow, size_t(shift) * sizeof(quint32));
+    }
+}
+
+void TransitionOverlay::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.drawImage(QPoint(0, 0), m_frames[m_front]);
+}
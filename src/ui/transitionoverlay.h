@@ -0,0 +1,119 @@
+// transitionoverlay.h
+#ifndef TRANSITIONOVERLAY_H
+#define TRANSITIONOVERLAY_H
+
+#include <QWidget>
+#include <QImage>
+#include <QThreadPool>
+#include <QElapsedTimer>
+
+class QTimer;
+
+/**
+ * @brief The TransitionOverlay class plays a transition between two snapshots of the view.
+ *
+ * Covers the viewport while the view underneath has already moved to the
+ * new image. Frames are composited on a worker thread into the back half
+ * of a double buffer (cross-fades with the SIMD kernel in blendkernel.h,
+ * slides as row copies) while the GUI thread presents the front half, so
+ * the GUI thread only swaps and draws a finished image once per display
+ * frame. No GPU is needed.
+ */
+class TransitionOverlay : public QWidget
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Transition styles.
+     */
+    enum Style {
+        Crossfade, ///< The new image fades in over the old one
+        Slide      ///< The new image pushes the old one out to the left
+    };
+
+    /**
+     * @brief Constructs a hidden overlay.
+     * @param parent The widget to cover, usually the viewport.
+     */
+    explicit TransitionOverlay(QWidget *parent = nullptr);
+
+    /**
+     * @brief Waits for the frame being composited.
+     */
+    ~TransitionOverlay();
+
+    /**
+     * @brief Starts a transition; the overlay covers its parent until it ends.
+     * @param from Snapshot of the view before the change.
+     * @param to Snapshot of the view after the change, same size as from.
+     * @param style The transition style.
+     * @param durationMs Length of the transition.
+     */
+    void start(const QImage &from, const QImage &to, Style style, int durationMs);
+
+    /**
+     * @brief Ends a running transition at once, uncovering the view.
+     */
+    void finish();
+
+    /**
+     * @brief Checks whether a transition is playing.
+     * @return True while the overlay is shown.
+     */
+    bool isRunning() const { return isVisible(); }
+
+signals:
+    /**
+     * @brief Signal emitted when a transition has ended.
+     */
+    void finished();
+
+protected:
+    /**
+     * @brief Draws the front frame.
+     * @param event The paint event.
+     */
+    void paintEvent(QPaintEvent *event) override;
+
+private slots:
+    /**
+     * @brief Presents the next frame if it is ready and queues the one after.
+     */
+    void onFrameTick();
+
+private:
+    /**
+     * @brief Queues compositing of the frame at a point of the transition.
+     * @param progress Position in the transition, 0 to 1.
+     */
+    void renderFrame(qreal progress);
+
+    /**
+     * @brief Composites one frame; runs on the worker.
+     * @param target Receives the frame.
+     * @param from The old view.
+     * @param to The new view.
+     * @param style The transition style.
+     * @param progress Eased position in the transition, 0 to 1.
+     */
+    static void composite(QImage &target, const QImage &from, const QImage &to, Style style, qreal progress);
+
+    QImage m_from;               ///< The old view
+    QImage m_to;                 ///< The new view
+    QImage m_frames[2];          ///< Double buffer: one presented, one being composited
+    int m_front = 0;             ///< Index of the presented frame
+    bool m_rendering = false;    ///< Whether the worker owns the back frame
+    bool m_backReady = false;    ///< Whether the back frame holds a finished frame
+    qreal m_backProgress = 0.0;  ///< Transition position of the back frame
+    qreal m_frontProgress = 0.0; ///< Transition position of the presented frame
+    Style m_style = Crossfade;   ///< Style of the running transition
+    int m_durationMs = 0;        ///< Length of the running transition
+    QElapsedTimer m_clock;       ///< Time since the transition started
+    QTimer *m_frameTimer;        ///< Ticks once per display frame
+    QThreadPool m_compositor;    ///< Single worker compositing frames
+    int m_presentedFrames = 0;   ///< Frames shown in the running transition, for diagnostics
+    int m_generation = 0;        ///< Bumped when a transition ends, so late frames are dropped
+};
+
+#endif // TRANSITIONOVERLAY_H
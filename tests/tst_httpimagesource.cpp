@@ -0,0 +1,268 @@
+// tst_httpimagesource.cpp
+#include "../src/core/httpimagesource.h"
+
+#include <QtTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+#include <QSemaphore>
+#include <QStandardPaths>
+#include <QUrl>
+#include <atomic>
+#include <memory>
+
+namespace {
+
+/**
+ * @brief A stand-in HTTP server with the behaviours the backend must cope with.
+ *
+ * Serves generated content for any path on its own thread, one connection
+ * at a time, with blocking socket calls; the client under test blocks too,
+ * so neither needs the other's event loop.
+ */
+class StandInServer
+{
+public:
+    enum Mode {
+        HonourRange,  ///< 206 with Content-Length for range requests, kept alive
+        IgnoreRange,  ///< 200 with the whole file, whatever was asked for
+        CloseEach,    ///< Like HonourRange, but "Connection: close" after every response
+        Chunked       ///< Like HonourRange, with a chunked body
+    };
+
+    static const int LargeSize = 200 * 1000;  ///< Size of every file except small.jpg
+    static const int SmallSize = 1000;        ///< Size of small.jpg, below the head span
+
+    explicit StandInServer(Mode mode)
+        : m_mode(mode)
+    {
+        m_thread.reset(QThread::create([this]() { run(); }));
+        m_thread->start();
+        m_ready.acquire();
+    }
+
+    ~StandInServer()
+    {
+        m_stop.store(true);
+        m_thread->wait();
+    }
+
+    /**
+     * @brief Gets the URL of a file on the server.
+     * @param name The file name.
+     * @return The URL.
+     */
+    QString url(const QString &name) const
+    {
+        return QString("http://127.0.0.1:%1/%2").arg(m_port).arg(name);
+    }
+
+    /**
+     * @brief Gets the number of connections accepted so far.
+     */
+    int connectionCount() const { return m_connections.load(); }
+
+    /**
+     * @brief Gets the content the server has for a path.
+     * @param path The request path, with its leading slash.
+     * @return The file content.
+     */
+    static QByteArray content(const QByteArray &path)
+    {
+        const int size = path.endsWith("small.jpg") ? SmallSize : LargeSize;
+        const uint seed = qHash(path);
+        QByteArray data(size, Qt::Uninitialized);
+        for (int i = 0; i < size; ++i)
+            data[i] = char((i * 7 + seed) & 0xff);
+        return data;
+    }
+
+private:
+    void run()
+    {
+        QTcpServer server;
+        server.listen(QHostAddress::LocalHost, 0);
+        m_port = server.serverPort();
+        m_ready.release();
+
+        while (!m_stop.load()) {
+            if (!server.waitForNewConnection(50))
+                continue;
+            std::unique_ptr<QTcpSocket> socket(server.nextPendingConnection());
+            ++m_connections;
+            serve(*socket);
+        }
+    }
+
+    void serve(QTcpSocket &socket)
+    {
+        QByteArray buffer;
+        while (!m_stop.load()) {
+            const int headerEnd = buffer.indexOf("\r\n\r\n");
+            if (headerEnd < 0) {
+                if (socket.waitForReadyRead(50))
+                    buffer += socket.readAll();
+                else if (socket.state() != QAbstractSocket::ConnectedState)
+                    return;
+                continue;
+            }
+
+            const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+            buffer.remove(0, headerEnd + 4);
+
+            const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+            const QByteArray path = requestLine.value(1);
+            qint64 rangeEnd = -1;
+            for (const QByteArray &line : lines) {
+                const QByteArray header = line.trimmed().toLower();
+                if (header.startsWith("range: bytes=0-"))
+                    rangeEnd = header.mid(15).toLongLong();
+            }
+
+            if (!respond(socket, path, rangeEnd))
+                return;
+            if (m_mode == CloseEach) {
+                socket.disconnectFromHost();
+                if (socket.state() != QAbstractSocket::UnconnectedState)
+                    socket.waitForDisconnected(1000);
+                return;
+            }
+        }
+    }
+
+    bool respond(QTcpSocket &socket, const QByteArray &path, qint64 rangeEnd)
+    {
+        const QByteArray file = content(path);
+        QByteArray body = file;
+        QByteArray response;
+        if (rangeEnd >= 0 && m_mode != IgnoreRange) {
+            const qint64 last = qMin<qint64>(rangeEnd, file.size() - 1);
+            body = file.left(last + 1);
+            response = "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes 0-"
+                       + QByteArray::number(last) + '/' + QByteArray::number(file.size()) + "\r\n";
+        } else {
+            response = "HTTP/1.1 200 OK\r\n";
+        }
+        if (m_mode == CloseEach)
+            response += "Connection: close\r\n";
+
+        if (m_mode == Chunked) {
+            response += "Transfer-Encoding: chunked\r\n\r\n";
+            for (int offset = 0; offset < body.size(); offset += ChunkBytes) {
+                const QByteArray chunk = body.mid(offset, ChunkBytes);
+                response += QByteArray::number(chunk.size(), 16) + "\r\n" + chunk + "\r\n";
+            }
+            response += "0\r\n\r\n";
+        } else {
+            response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n" + body;
+        }
+
+        // A client that took what it asked for of an ignored range hangs up
+        // mid-body; that ends the connection, not the server
+        socket.write(response);
+        while (socket.bytesToWrite() > 0) {
+            if (!socket.waitForBytesWritten(1000))
+                return false;
+        }
+        return true;
+    }
+
+    static const int ChunkBytes = 5000;
+
+    Mode m_mode;
+    std::unique_ptr<QThread> m_thread;
+    QSemaphore m_ready;
+    std::atomic_bool m_stop{false};
+    std::atomic_int m_connections{0};
+    quint16 m_port = 0;
+};
+
+} // namespace
+
+/**
+ * @brief Tests HttpImageSource against stand-in servers.
+ *
+ * Every case uses a server of its own on a fresh port, so the backend's
+ * session cache never answers for an earlier case.
+ */
+class TestHttpImageSource : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase()
+    {
+        // Keeps the disk cache away from the user's
+        QStandardPaths::setTestModeEnabled(true);
+    }
+
+    void readHeads_data()
+    {
+        QTest::addColumn<int>("mode");
+        QTest::addColumn<bool>("persistent");
+
+        QTest::newRow("honours range") << int(StandInServer::HonourRange) << true;
+        QTest::newRow("ignores range") << int(StandInServer::IgnoreRange) << false;
+        QTest::newRow("connection close") << int(StandInServer::CloseEach) << false;
+        QTest::newRow("chunked") << int(StandInServer::Chunked) << true;
+    }
+
+    void readHeads()
+    {
+        QFETCH(int, mode);
+        QFETCH(bool, persistent);
+
+        StandInServer server{StandInServer::Mode(mode)};
+
+        // More than one pipeline window, with a file shorter than the head span
+        QStringList urls;
+        for (int i = 0; i < 2 * HttpImageSource::PipelineDepth + 5; ++i)
+            urls.append(server.url(QString("img%1.jpg").arg(i)));
+        urls.append(server.url("small.jpg"));
+
+        const qint64 maxSize = 4096;
+        const QVector<QByteArray> heads = HttpImageSource::instance()->readHeads(urls, maxSize);
+
+        QCOMPARE(heads.size(), urls.size());
+        for (int i = 0; i < urls.size(); ++i) {
+            const QByteArray path = QUrl(urls[i]).path().toUtf8();
+            QCOMPARE(heads[i], StandInServer::content(path).left(maxSize));
+        }
+
+        // Pipelining keeps one connection; truncated or closed responses
+        // force the remaining requests onto new ones
+        if (persistent)
+            QCOMPARE(server.connectionCount(), 1);
+        else
+            QVERIFY(server.connectionCount() > 1);
+
+        // Sizes come from Content-Range or Content-Length, not the head
+        QCOMPARE(HttpImageSource::instance()->fileSize(urls.first()), qint64(StandInServer::LargeSize));
+        QCOMPARE(HttpImageSource::instance()->fileSize(urls.last()), qint64(StandInServer::SmallSize));
+
+        // Heads are served from the cache the second time
+        const int connections = server.connectionCount();
+        QCOMPARE(HttpImageSource::instance()->readHeads(urls, maxSize), heads);
+        QCOMPARE(server.connectionCount(), connections);
+    }
+
+    void open_data()
+    {
+        readHeads_data();
+    }
+
+    void open()
+    {
+        QFETCH(int, mode);
+
+        StandInServer server{StandInServer::Mode(mode)};
+        const QString url = server.url("full.jpg");
+
+        std::unique_ptr<QIODevice> device = HttpImageSource::instance()->open(url);
+        QVERIFY(device);
+        QCOMPARE(device->readAll(), StandInServer::content("/full.jpg"));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestHttpImageSource)
+#include "tst_httpimagesource.moc"